@@ -0,0 +1,684 @@
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <fun/boxed.h>
+#include <fun/collect.h>
+#include <fun/context.h>
+#include <fun/coroutine.h>
+#include <fun/error.h>
+#include <fun/kernels.h>
+#include <fun/option_vector.h>
+#include <fun/parallel.h>
+#include <fun/result.h>
+#include <fun/try.h>
+#include <fun/views.h>
+
+//------------------------------------------------------------------------------
+enum class ErrCode: std::uint8_t { Busy, Timeout };
+
+//------------------------------------------------------------------------------
+// Mimics the layout of Option<int> before its special members followed the
+// payload's: the user-provided copy constructor and destructor force
+// return-through-memory, just like the old OptionUnion's did.
+struct NonTrivialOptionInt {
+  std::uint8_t tag;
+  int val;
+
+  NonTrivialOptionInt(std::uint8_t t, int v) : tag(t), val(v) {}
+  NonTrivialOptionInt(const NonTrivialOptionInt& other) : tag(other.tag), val(other.val) {}
+  ~NonTrivialOptionInt() {}
+};
+
+//------------------------------------------------------------------------------
+[[gnu::noinline]] auto make_option(const int n) -> fun::Option<int> {
+  if (n % 7 != 0) { return fun::some(n); }
+  else            { return {}; }
+}
+
+[[gnu::noinline]] auto make_non_trivial_option(const int n) -> NonTrivialOptionInt {
+  return NonTrivialOptionInt(n % 7 != 0 ? 1 : 0, n);
+}
+
+[[gnu::noinline]] auto make_result(const int n) -> fun::Result<int, ErrCode> {
+  if (n % 7 != 0) { return fun::make_ok(n); }
+  else            { return fun::make_err(ErrCode::Busy); }
+}
+
+//------------------------------------------------------------------------------
+static void BM_return_option_int(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_option(++n);
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_return_option_int);
+
+static void BM_return_non_trivial_option_int(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_non_trivial_option(++n);
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_return_non_trivial_option_int);
+
+static void BM_return_result_int(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto res = make_result(++n);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(BM_return_result_int);
+
+//------------------------------------------------------------------------------
+static void BM_vector_growth_option_int(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<fun::Option<int>> xs;
+    for (auto i = 0; i < state.range(0); ++i) { xs.emplace_back(fun::ForwardArgs{}, i); }
+    benchmark::DoNotOptimize(xs.data());
+  }
+}
+BENCHMARK(BM_vector_growth_option_int)->Arg(1 << 16);
+
+static void BM_vector_growth_non_trivial_option_int(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<NonTrivialOptionInt> xs;
+    for (auto i = 0; i < state.range(0); ++i) { xs.emplace_back(1, i); }
+    benchmark::DoNotOptimize(xs.data());
+  }
+}
+BENCHMARK(BM_vector_growth_non_trivial_option_int)->Arg(1 << 16);
+
+// A string payload that counts its copies. With `NothrowMove` false it mimics
+// a Result whose move constructor is not noexcept, which std::vector copies
+// rather than moves when it reallocates.
+template <bool NothrowMove>
+struct CountedString {
+  static inline std::int64_t copies = 0;
+
+  std::string str;
+
+  explicit CountedString(std::string s) : str(std::move(s)) {}
+  CountedString(CountedString&& other) noexcept(NothrowMove) : str(std::move(other.str)) {}
+  CountedString(const CountedString& other) : str(other.str) { ++copies; }
+};
+
+template <bool NothrowMove>
+static void BM_vector_growth_result_string(benchmark::State& state) {
+  using Payload = CountedString<NothrowMove>;
+  Payload::copies = 0;
+  for (auto _ : state) {
+    std::vector<fun::Result<Payload, std::string>> xs;
+    for (auto i = 0; i < state.range(0); ++i) {
+      xs.emplace_back(fun::OkTag{}, fun::ForwardArgs{}, "a payload too long for the small string buffer");
+    }
+    benchmark::DoNotOptimize(xs.data());
+  }
+  state.counters["copies"] = benchmark::Counter(static_cast<double>(Payload::copies), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_vector_growth_result_string, true)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(BM_vector_growth_result_string, false)->Arg(1 << 12);
+
+//------------------------------------------------------------------------------
+// An eight step chain, as in a request handler validating one field
+const auto add_one = [](const int x) { return x + 1; };
+const auto twice = [](const int x) { return 2 * x; };
+const auto below_limit = [](const int x) -> fun::Option<int> {
+  if (x < (1 << 28)) { return fun::some(x); }
+  else               { return {}; }
+};
+const auto checked = [](const int x) -> fun::Result<int, ErrCode> {
+  if (x < (1 << 28)) { return fun::make_ok(x); }
+  else               { return fun::make_err(ErrCode::Timeout); }
+};
+
+static void BM_option_chain_eager(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_option(++n & 0xFFFF).map(add_one).map(twice).and_then(below_limit).map(add_one)
+                                       .map(twice).and_then(below_limit).map(add_one).map(twice);
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_option_chain_eager);
+
+static void BM_option_chain_lazy(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_option(++n & 0xFFFF).lazy().map(add_one).map(twice).and_then(below_limit).map(add_one)
+                                              .map(twice).and_then(below_limit).map(add_one).map(twice).eval();
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_option_chain_lazy);
+
+static void BM_result_chain_eager(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto res = make_result(++n & 0xFFFF).map(add_one).map(twice).and_then(checked).map(add_one)
+                                        .map(twice).and_then(checked).map(add_one).map(twice);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(BM_result_chain_eager);
+
+static void BM_result_chain_lazy(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto res = make_result(++n & 0xFFFF).lazy().map(add_one).map(twice).and_then(checked).map(add_one)
+                                               .map(twice).and_then(checked).map(add_one).map(twice).eval();
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(BM_result_chain_lazy);
+
+// The same shape over a non-trivial payload, where every eager stage pays
+// for moving the string in and out of an Option and destroying the husk
+const auto append_digit = [](std::string s) {
+  s.push_back('7');
+  return s;
+};
+const auto short_enough = [](std::string s) -> fun::Option<std::string> {
+  if (s.size() < 64) { return fun::some(std::move(s)); }
+  else               { return {}; }
+};
+
+[[gnu::noinline]] auto make_option_string(const int n) -> fun::Option<std::string> {
+  if (n % 7 != 0) { return fun::some(std::string("field")); }
+  else            { return {}; }
+}
+
+static void BM_option_string_chain_eager(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_option_string(++n).map(append_digit).map(append_digit).and_then(short_enough).map(append_digit)
+                                     .map(append_digit).and_then(short_enough).map(append_digit).map(append_digit);
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_option_string_chain_eager);
+
+static void BM_option_string_chain_lazy(benchmark::State& state) {
+  auto n = 0;
+  for (auto _ : state) {
+    auto op = make_option_string(++n).lazy().map(append_digit).map(append_digit).and_then(short_enough)
+                                     .map(append_digit).map(append_digit).and_then(short_enough)
+                                     .map(append_digit).map(append_digit).eval();
+    benchmark::DoNotOptimize(op);
+  }
+}
+BENCHMARK(BM_option_string_chain_lazy);
+
+//------------------------------------------------------------------------------
+// Masked reductions over a nullable column of 64Ki rows with 6 in 7 present,
+// the argument caps the instruction set (0: scalar, 1: AVX2, 2: AVX-512).
+auto make_options(const int n) -> std::vector<fun::Option<int>> {
+  auto ops = std::vector<fun::Option<int>>();
+  for (auto i = 0; i < n; ++i) { ops.push_back(make_option(i)); }
+  return ops;
+}
+
+static void BM_sum_some_naive_loop(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto& op : ops) {
+      if (op.is_some()) { total += *op.as_ptr(); }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_sum_some_naive_loop);
+
+static void BM_sum_some_options(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  fun::simd::limit_isa(static_cast<fun::simd::Isa>(state.range(0)));
+  for (auto _ : state) { benchmark::DoNotOptimize(fun::sum_some(ops)); }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+BENCHMARK(BM_sum_some_options)->DenseRange(0, 2);
+
+static void BM_sum_some_option_vector(benchmark::State& state) {
+  const auto column = fun::OptionVector<int>(make_options(1 << 16));
+  fun::simd::limit_isa(static_cast<fun::simd::Isa>(state.range(0)));
+  for (auto _ : state) { benchmark::DoNotOptimize(fun::sum_some(column)); }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+BENCHMARK(BM_sum_some_option_vector)->DenseRange(0, 2);
+
+static void BM_count_some_naive_loop(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto n = std::size_t{0};
+    for (const auto& op : ops) { n += op.is_some() ? 1 : 0; }
+    benchmark::DoNotOptimize(n);
+  }
+}
+BENCHMARK(BM_count_some_naive_loop);
+
+static void BM_count_some_options(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  fun::simd::limit_isa(static_cast<fun::simd::Isa>(state.range(0)));
+  for (auto _ : state) { benchmark::DoNotOptimize(fun::count_some(ops)); }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+BENCHMARK(BM_count_some_options)->DenseRange(0, 2);
+
+static void BM_compact_some_naive_loop(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto out = std::vector<int>();
+    for (const auto& op : ops) {
+      if (op.is_some()) { out.push_back(*op.as_ptr()); }
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+BENCHMARK(BM_compact_some_naive_loop);
+
+static void BM_compact_some_options(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  fun::simd::limit_isa(static_cast<fun::simd::Isa>(state.range(0)));
+  for (auto _ : state) { benchmark::DoNotOptimize(fun::compact_some(ops).data()); }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+BENCHMARK(BM_compact_some_options)->DenseRange(0, 2);
+
+static void BM_compact_some_option_vector(benchmark::State& state) {
+  const auto column = fun::OptionVector<int>(make_options(1 << 16));
+  fun::simd::limit_isa(static_cast<fun::simd::Isa>(state.range(0)));
+  for (auto _ : state) { benchmark::DoNotOptimize(fun::compact_some(column).data()); }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+BENCHMARK(BM_compact_some_option_vector)->DenseRange(0, 2);
+
+//------------------------------------------------------------------------------
+// Range adaptors against the loops they replace, over the same 64Ki rows
+auto make_results(const int n) -> std::vector<fun::Result<int, ErrCode>> {
+  auto results = std::vector<fun::Result<int, ErrCode>>();
+  for (auto i = 0; i < n; ++i) { results.push_back(make_result(i)); }
+  return results;
+}
+
+auto halve_even(const int x) -> fun::Option<int> {
+  if (x % 2 == 0) { return fun::some(x / 2); }
+  else            { return {}; }
+}
+
+auto check_small(const int x) -> fun::Result<int, ErrCode> {
+  if (x >= 0) { return fun::make_ok(x * 3); }
+  else        { return fun::make_err(ErrCode::Timeout); }
+}
+
+static void BM_flatten_naive_loop(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto& op : ops) {
+      if (op.is_some()) { total += *op.as_ptr(); }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_flatten_naive_loop);
+
+static void BM_flatten_view(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto x : ops | fun::views::flatten) { total += x; }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_flatten_view);
+
+static void BM_oks_naive_loop(benchmark::State& state) {
+  const auto results = make_results(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto& res : results) {
+      if (res.is_ok()) { total += *res.as_ptr(); }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_oks_naive_loop);
+
+static void BM_oks_view(benchmark::State& state) {
+  const auto results = make_results(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto x : results | fun::views::oks) { total += x; }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_oks_view);
+
+static void BM_filter_map_naive_loop(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    for (const auto& op : ops) {
+      if (op.is_some()) {
+        auto half = halve_even(*op.as_ptr());
+        if (half.is_some()) { total += *half.as_ptr(); }
+      }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_filter_map_naive_loop);
+
+static void BM_filter_map_view(benchmark::State& state) {
+  const auto ops = make_options(1 << 16);
+  for (auto _ : state) {
+    auto total = 0;
+    const auto halves = fun::views::filter_map([](const int x) { return halve_even(x); });
+    for (const auto x : ops | fun::views::flatten | halves) { total += x; }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_filter_map_view);
+
+static void BM_try_transform_naive_loop(benchmark::State& state) {
+  auto xs = std::vector<int>(1 << 16);
+  for (auto i = 0; i < static_cast<int>(xs.size()); ++i) { xs[i] = i; }
+  for (auto _ : state) {
+    auto total = 0;
+    auto error = fun::Option<ErrCode>();
+    for (const auto x : xs) {
+      auto res = check_small(x);
+      if (res.is_err()) {
+        error = std::move(res).err();
+        break;
+      }
+      total += *res.as_ptr();
+    }
+    benchmark::DoNotOptimize(total);
+    benchmark::DoNotOptimize(error);
+  }
+}
+BENCHMARK(BM_try_transform_naive_loop);
+
+static void BM_try_transform_view(benchmark::State& state) {
+  auto xs = std::vector<int>(1 << 16);
+  for (auto i = 0; i < static_cast<int>(xs.size()); ++i) { xs[i] = i; }
+  for (auto _ : state) {
+    auto total = 0;
+    auto checked = xs | fun::views::try_transform([](const int x) { return check_small(x); });
+    for (const auto x : checked) { total += x; }
+    benchmark::DoNotOptimize(total);
+    benchmark::DoNotOptimize(checked.error());
+  }
+}
+BENCHMARK(BM_try_transform_view);
+
+//------------------------------------------------------------------------------
+// Gathering a batch of validated records, all of them Ok
+auto make_valid_records(const int n) -> std::vector<fun::Result<std::string, ErrCode>> {
+  auto records = std::vector<fun::Result<std::string, ErrCode>>();
+  for (auto i = 0; i < n; ++i) { records.push_back(fun::make_ok(std::to_string(i) + " is a record of some length")); }
+  return records;
+}
+
+static void BM_collect_naive_loop(benchmark::State& state) {
+  const auto records = make_valid_records(1 << 14);
+  for (auto _ : state) {
+    auto out = fun::Result<std::vector<std::string>, ErrCode>(fun::OkTag{}, fun::ForwardArgs{});
+    for (const auto& record : records) {
+      if (record.is_err()) {
+        out = fun::Result<std::vector<std::string>, ErrCode>(fun::err(*record.as_err_ptr()));
+        break;
+      }
+      out.as_ptr()->push_back(*record.as_ptr());
+    }
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_collect_naive_loop);
+
+static void BM_collect(benchmark::State& state) {
+  const auto records = make_valid_records(1 << 14);
+  for (auto _ : state) {
+    auto out = fun::sequence(records);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_collect);
+
+//------------------------------------------------------------------------------
+// Parallel validation of 64Ki records on 1 to N threads, the argument being
+// the number of threads. Each record takes a few hundred nanoseconds.
+auto validate_record(const std::uint64_t record) -> fun::Result<std::uint64_t, ErrCode> {
+  auto h = record;
+  for (auto i = 0; i < 256; ++i) { h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9u; }
+  if (record != 0) { return fun::make_ok(h); }
+  else             { return fun::make_err(ErrCode::Busy); }
+}
+
+auto make_records(const std::size_t n, const std::size_t bad_at) -> std::vector<std::uint64_t> {
+  auto records = std::vector<std::uint64_t>(n);
+  for (auto i = std::size_t{0}; i < n; ++i) { records[i] = i + 1; }
+  if (bad_at < n) { records[bad_at] = 0; }
+  return records;
+}
+
+static void thread_counts(benchmark::internal::Benchmark* bench) {
+  const auto cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for (auto threads = 1; threads < cores; threads *= 2) { bench->Arg(threads); }
+  bench->Arg(cores);
+}
+
+static void BM_traverse_sequential(benchmark::State& state) {
+  const auto records = make_records(1 << 16, 1 << 16);
+  for (auto _ : state) {
+    auto out = fun::sequence(records | std::views::transform(validate_record));
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_traverse_sequential)->UseRealTime();
+
+static void BM_par_traverse(benchmark::State& state) {
+  const auto records = make_records(1 << 16, 1 << 16);
+  for (auto _ : state) {
+    auto out = fun::par_traverse(records, validate_record, state.range(0));
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_par_traverse)->Apply(thread_counts)->UseRealTime();
+
+// A failure 1% of the way in stops the whole team
+static void BM_par_traverse_early_failure(benchmark::State& state) {
+  const auto records = make_records(1 << 16, 1 << 9);
+  for (auto _ : state) {
+    auto out = fun::par_traverse(records, validate_record, state.range(0));
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_par_traverse_early_failure)->Apply(thread_counts)->UseRealTime();
+
+static void BM_par_filter_map(benchmark::State& state) {
+  const auto records = make_records(1 << 16, 1 << 16);
+  const auto odd_hashes = [](const std::uint64_t record) {
+    return validate_record(record).ok().filter([](const std::uint64_t h) { return h % 2 == 1; });
+  };
+  for (auto _ : state) {
+    auto out = fun::par_filter_map(records, odd_hashes, state.range(0));
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+BENCHMARK(BM_par_filter_map)->Apply(thread_counts)->UseRealTime();
+
+//------------------------------------------------------------------------------
+// Early return from a chain of three fallible steps, by macro and by co_await,
+// over 64Ki inputs of which one in seven fails at the first step
+[[gnu::noinline]] auto try_chain_macro(const int n) -> fun::Result<int, ErrCode> {
+  FUN_TRY_DECLARE(a, make_result(n));
+  FUN_TRY_DECLARE(b, check_small(a));
+  FUN_TRY_DECLARE(c, make_result(b + 1));
+  return fun::make_ok(a + b + c);
+}
+
+[[gnu::noinline]] auto try_chain_coroutine(const int n) -> fun::Result<int, ErrCode> {
+  const auto a = co_await make_result(n);
+  const auto b = co_await check_small(a);
+  co_return a + b + co_await make_result(b + 1);
+}
+
+template <auto chain>
+static void BM_try_chain(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = 0;
+    for (auto i = 0; i < (1 << 16); ++i) { total += chain(i).unwrap_or(0); }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK_TEMPLATE(BM_try_chain, try_chain_macro);
+BENCHMARK_TEMPLATE(BM_try_chain, try_chain_coroutine);
+
+//------------------------------------------------------------------------------
+// The same chain propagating its codes as a heavier error, whose conversion
+// (kept on the cold path) builds a message, over 64Ki inputs of which one in
+// 1024 fails
+struct DeviceError {
+  std::string message;
+  ErrCode code;
+};
+
+template <>
+struct fun::ErrorFrom<DeviceError, ErrCode> {
+  static auto convert(const ErrCode code) -> DeviceError {
+    return DeviceError{ "device error " + std::to_string(static_cast<int>(code)), code };
+  }
+};
+
+[[gnu::noinline]] auto rarely_failing(const int n) -> fun::Result<int, ErrCode> {
+  if (n % 1024 != 0) { return fun::make_ok(n); }
+  else               { return fun::make_err(ErrCode::Busy); }
+}
+
+[[gnu::noinline]] auto try_chain_converting(const int n) -> fun::Result<int, DeviceError> {
+  FUN_TRY_DECLARE(a, rarely_failing(n));
+  FUN_TRY_DECLARE(b, rarely_failing(a + 1));
+  FUN_TRY_DECLARE(c, rarely_failing(b + 1));
+  return fun::make_ok(a + b + c);
+}
+
+static void BM_try_chain_converting(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = 0;
+    for (auto i = 0; i < (1 << 16); ++i) {
+      const auto res = try_chain_converting(i);
+      total += res.is_ok() ? *res.as_ptr() : 1;
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_try_chain_converting);
+
+//------------------------------------------------------------------------------
+// Errors carrying a message, as a std::string and as a fun::Error, over 64Ki
+// inputs of which one in seven fails and gets context added
+[[gnu::noinline]] auto check_string_error(const int n) -> fun::Result<int, std::string> {
+  if (n % 7 != 0) { return fun::make_ok(n); }
+  else            { return fun::make_err("value is a multiple of seven"); }
+}
+
+[[gnu::noinline]] auto check_fun_error(const int n) -> fun::Result<int, fun::Error> {
+  static constexpr auto multiple_of_seven = fun::ErrorMessage{ "value is a multiple of seven" };
+  if (n % 7 != 0) { return fun::make_ok(n); }
+  else            { return fun::make_err(multiple_of_seven); }
+}
+
+static void BM_string_error(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = std::size_t{0};
+    for (auto i = 0; i < (1 << 16); ++i) {
+      auto res = check_string_error(i).map_err([](std::string e) { return "checking: " + std::move(e); });
+      total += res.is_ok() ? std::size_t(*res.as_ptr()) : res.as_err_ptr()->size();
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_string_error);
+
+static void BM_fun_error(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = std::size_t{0};
+    for (auto i = 0; i < (1 << 16); ++i) {
+      auto res = check_fun_error(i).map_err([](const fun::Error e) { return e.context("checking"); });
+      total += res.is_ok() ? std::size_t(*res.as_ptr()) : std::size_t(res.as_err_ptr()->code());
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_fun_error);
+
+//------------------------------------------------------------------------------
+// A bare error code against one carrying context on the side, over 64Ki
+// inputs of which one in seven fails and gets context added
+[[gnu::noinline]] auto make_traced_result(const int n) -> fun::Result<int, fun::Traced<ErrCode>> {
+  if (n % 7 != 0) { return fun::make_ok(n); }
+  else            { return fun::make_err(ErrCode::Busy); }
+}
+
+static void BM_bare_code(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = 0;
+    for (auto i = 0; i < (1 << 16); ++i) {
+      auto res = make_result(i).map_err([](const ErrCode e) { return e == ErrCode::Busy ? ErrCode::Timeout : e; });
+      total += res.is_ok() ? *res.as_ptr() : int(*res.as_err_ptr());
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_bare_code);
+
+static void BM_traced_code(benchmark::State& state) {
+  for (auto _ : state) {
+    auto total = 0;
+    for (auto i = 0; i < (1 << 16); ++i) {
+      auto res = make_traced_result(i).map_err(fun::with_context("polling the device"));
+      total += res.is_ok() ? *res.as_ptr() : int(res.as_err_ptr()->code());
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_traced_code);
+
+//------------------------------------------------------------------------------
+// A large error inline against a boxed one, in 64Ki Results kept in a vector
+// and then summed, of which one in 64 fails
+struct ParseReport {
+  int line;
+  char excerpt[252];
+};
+
+template <class E>
+[[gnu::noinline]] auto parse_line(const int n) -> fun::Result<int, E> {
+  if (n % 64 != 0) { return fun::make_ok(n); }
+  else             { return fun::make_err(ParseReport{ n, {} }); }
+}
+
+template <class E>
+static void BM_large_error(benchmark::State& state) {
+  auto results = std::vector<fun::Result<int, E>>();
+  results.reserve(1 << 16);
+  for (auto _ : state) {
+    results.clear();
+    for (auto i = 0; i < (1 << 16); ++i) { results.push_back(parse_line<E>(i)); }
+    auto total = 0;
+    for (const auto& res : results) { total += res.is_ok() ? *res.as_ptr() : 1; }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK_TEMPLATE(BM_large_error, ParseReport);
+BENCHMARK_TEMPLATE(BM_large_error, fun::Boxed<ParseReport>);
+
+BENCHMARK_MAIN();
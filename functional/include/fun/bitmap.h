@@ -0,0 +1,179 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus > 201703L
+#include <bit>
+#endif
+
+namespace fun {
+
+//------------------------------------------------------------------------------
+inline auto popcount(const std::uint64_t word) -> int {
+#if defined(__cpp_lib_bitops)
+  return std::popcount(word);
+#elif defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  auto n = 0;
+  for (auto w = word; w != 0; w &= w - 1) { ++n; }
+  return n;
+#endif
+}
+
+//! @note `word` must be nonzero
+inline auto countr_zero(const std::uint64_t word) -> int {
+#if defined(__cpp_lib_bitops)
+  return std::countr_zero(word);
+#elif defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  auto n = 0;
+  for (auto w = word; (w & 1) == 0; w >>= 1) { ++n; }
+  return n;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+ * A growable, packed sequence of bits stored in 64-bit words. Bits past `size()` in the last word are always clear, so
+ * whole-word operations (`count`, `find_next`) never need to mask the tail.
+ */
+class Bitmap {
+public:
+  using word_t = std::uint64_t;
+
+  static constexpr std::size_t word_bits = 64;
+
+private:
+  std::vector<word_t> _words;
+  std::size_t _size = 0;
+
+  static auto word_count(const std::size_t n) -> std::size_t { return (n + word_bits - 1) / word_bits; }
+
+  static auto mask(const std::size_t i) -> word_t { return word_t{1} << (i % word_bits); }
+
+public:
+  Bitmap() = default;
+
+  explicit Bitmap(const std::size_t n) : _words(word_count(n), 0), _size(n) {}
+
+  auto size() const -> std::size_t { return _size; }
+  auto empty() const -> bool { return _size == 0; }
+
+  auto words() const -> const std::vector<word_t>& { return _words; }
+
+  void reserve(const std::size_t n) { _words.reserve(word_count(n)); }
+
+  void clear() {
+    _words.clear();
+    _size = 0;
+  }
+
+  //! Grows with clear bits, or drops the bits past `n`
+  void resize(const std::size_t n) {
+    _words.resize(word_count(n), 0);
+    _size = n;
+    if (_size % word_bits != 0) { _words.back() &= mask(_size) - 1; }
+  }
+
+  void push_back(const bool bit) {
+    if (_size % word_bits == 0) { _words.push_back(0); }
+    if (bit) { _words.back() |= mask(_size); }
+    ++_size;
+  }
+
+  auto test(const std::size_t i) const -> bool { return (_words[i / word_bits] & mask(i)) != 0; }
+
+  void set(const std::size_t i, const bool bit) {
+    if (bit) { _words[i / word_bits] |= mask(i); }
+    else     { _words[i / word_bits] &= ~mask(i); }
+  }
+
+  //! Number of set bits
+  auto count() const -> std::size_t {
+    auto n = std::size_t{0};
+    for (const auto word : _words) { n += static_cast<std::size_t>(popcount(word)); }
+    return n;
+  }
+
+  //! Index of the first set bit at or after `i`, or `size()` if there is none
+  auto find_next(const std::size_t i) const -> std::size_t {
+    if (i >= _size) { return _size; }
+    auto w = i / word_bits;
+    auto word = _words[w] & (~word_t{0} << (i % word_bits));
+    while (word == 0) {
+      if (++w == _words.size()) { return _size; }
+      word = _words[w];
+    }
+    return w * word_bits + static_cast<std::size_t>(countr_zero(word));
+  }
+
+  auto operator==(const Bitmap& other) const -> bool { return _size == other._size && _words == other._words; }
+  auto operator!=(const Bitmap& other) const -> bool { return !(*this == other); }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * Forward iterator over the elements of a dense array whose bits are set in a `Bitmap`, e.g. the present rows of an
+ * `OptionVector`. Unset runs are skipped a word at a time.
+ */
+template <class V>
+class SetBitIter {
+  V* _values = nullptr;
+  const Bitmap* _bits = nullptr;
+  std::size_t _i = 0;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::remove_const_t<V>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = V*;
+  using reference = V&;
+
+  SetBitIter() = default;
+  SetBitIter(V* values, const Bitmap* bits, const std::size_t i) : _values(values), _bits(bits), _i(i) {}
+
+  //! Row index of the current element
+  auto index() const -> std::size_t { return _i; }
+
+  auto operator*() const -> V& { return _values[_i]; }
+  auto operator->() const -> V* { return _values + _i; }
+
+  auto operator++() -> SetBitIter& {
+    _i = _bits->find_next(_i + 1);
+    return *this;
+  }
+
+  auto operator++(int) -> SetBitIter {
+    auto prev = *this;
+    ++*this;
+    return prev;
+  }
+
+  bool operator==(const SetBitIter& other) const { return _i == other._i; }
+  bool operator!=(const SetBitIter& other) const { return !(*this == other); }
+};
+
+template <class V>
+class SetBitRange {
+  V* _values;
+  const Bitmap* _bits;
+
+public:
+  SetBitRange(V* values, const Bitmap* bits) : _values(values), _bits(bits) {}
+
+  auto begin() const -> SetBitIter<V> { return SetBitIter<V>(_values, _bits, _bits->find_next(0)); }
+  auto end() const -> SetBitIter<V> { return SetBitIter<V>(_values, _bits, _bits->size()); }
+};
+
+}
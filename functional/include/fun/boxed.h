@@ -0,0 +1,171 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <fun/niche.h>
+#include <fun/type_support.h>
+
+namespace fun {
+
+namespace boxed_detail {
+
+//------------------------------------------------------------------------------
+// Blocks of `Size` bytes aligned to `Align`, recycled through a per-thread
+// free list of up to `max_cached` blocks. A block may be given back on
+// another thread than the one it came from.
+template <std::size_t Size, std::size_t Align>
+class Pool {
+  static constexpr std::size_t max_cached = 64;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  FreeBlock* _head = nullptr;
+  std::size_t _cached = 0;
+
+  static void release(void* const block) noexcept { ::operator delete(block, Size, std::align_val_t(Align)); }
+
+public:
+  Pool() = default;
+  Pool(const Pool&) = delete;
+  auto operator=(const Pool&) -> Pool& = delete;
+
+  // Blocks given back after the pool is gone are released right away
+  ~Pool() {
+    while (_head != nullptr) {
+      auto* const next = _head->next;
+      release(_head);
+      _head = next;
+    }
+    _cached = max_cached;
+  }
+
+  static auto local() noexcept -> Pool& {
+    static thread_local Pool pool;
+    return pool;
+  }
+
+  auto allocate() -> void* {
+    if (_head == nullptr) { return ::operator new(Size, std::align_val_t(Align)); }
+    auto* const block = _head;
+    _head = block->next;
+    --_cached;
+    return block;
+  }
+
+  void deallocate(void* const block) noexcept {
+    if (_cached == max_cached) { return release(block); }
+    _head = ::new (block) FreeBlock{ _head };
+    ++_cached;
+  }
+};
+
+// Payloads share the pool of their size class, in steps of 16 bytes
+template <class T>
+using pool_t = Pool<(std::max(sizeof(T), sizeof(void*)) + 15) / 16 * 16, std::max(alignof(T), alignof(void*))>;
+
+} // end namespace boxed_detail
+
+//------------------------------------------------------------------------------
+//! A `T` stored out of line, in a block recycled through a per-thread pool rather than taken from the heap each time.
+//! Wrapping a large or rarely present alternative shrinks the Option or Result holding it to a pointer plus the other
+//! alternative, e.g. `Result<int, Boxed<ParseReport>>` or `Option<Boxed<Matrix4>>`, so that the common case does not
+//! carry (or copy) the footprint of the rare one.
+//!
+//! A `Boxed<T>` behaves as the `T` it holds: it is constructed from one, copies copy it and comparisons compare it. Only
+//! a moved-from `Boxed<T>` holds nothing, which makes it the None of an `Option<Boxed<T>>`.
+template <class T>
+class Boxed {
+  static_assert(std::is_object_v<T> && !std::is_array_v<T>, "Boxed holds complete object types");
+
+  friend struct NicheTraits<Boxed>;
+
+  T* _ptr;
+
+  constexpr explicit Boxed(std::nullptr_t) noexcept : _ptr(nullptr) {}
+
+  template <class ...Args>
+  static auto make(Args&& ...args) -> T* {
+    auto& pool = boxed_detail::pool_t<T>::local();
+    void* const block = pool.allocate();
+    try {
+      return ::new (block) T(std::forward<Args>(args)...);
+    } catch (...) {
+      pool.deallocate(block);
+      throw;
+    }
+  }
+
+  void reset() noexcept {
+    if (_ptr != nullptr) {
+      _ptr->~T();
+      boxed_detail::pool_t<T>::local().deallocate(_ptr);
+    }
+  }
+
+public:
+  using value_t = T;
+
+  //! Constructs the `T` in place from `args`
+  template <class ...Args>
+  explicit Boxed(ForwardArgs, Args&& ...args) : _ptr(make(std::forward<Args>(args)...)) {}
+
+  Boxed(const T& val) : _ptr(make(val)) {}
+  Boxed(T&& val) : _ptr(make(std::move(val))) {}
+
+  Boxed(const Boxed& other) : _ptr(other._ptr != nullptr ? make(*other._ptr) : nullptr) {}
+  Boxed(Boxed&& other) noexcept : _ptr(std::exchange(other._ptr, nullptr)) {}
+
+  auto operator=(const Boxed& other) -> Boxed& {
+    if (this != &other) { *this = Boxed(other); }
+    return *this;
+  }
+
+  auto operator=(Boxed&& other) noexcept -> Boxed& {
+    if (this != &other) {
+      reset();
+      _ptr = std::exchange(other._ptr, nullptr);
+    }
+    return *this;
+  }
+
+  ~Boxed() { reset(); }
+
+  // ** the following are undefined behavior on a moved-from `Boxed` **
+  auto operator*() & noexcept -> T& { return *_ptr; }
+  auto operator*() const& noexcept -> const T& { return *_ptr; }
+  auto operator*() && noexcept -> T&& { return std::move(*_ptr); }
+  auto operator->() noexcept -> T* { return _ptr; }
+  auto operator->() const noexcept -> const T* { return _ptr; }
+
+  //! The `T` held, or null if moved from
+  auto get() const noexcept -> const T* { return _ptr; }
+
+  friend bool operator==(const Boxed& a, const Boxed& b) { return *a == *b; }
+  friend bool operator!=(const Boxed& a, const Boxed& b) { return !(a == b); }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * A `Boxed` uses its null (moved-from) state as its only niche.
+ */
+template <class T>
+struct NicheTraits<Boxed<T>> {
+  static constexpr std::size_t count = 1;
+
+  static Boxed<T> make(std::size_t) { return Boxed<T>(nullptr); }
+
+  static bool is(const Boxed<T>& x, std::size_t) { return x.get() == nullptr; }
+};
+
+}
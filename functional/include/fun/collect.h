@@ -0,0 +1,267 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus > 201703L
+#include <ranges>
+#endif
+
+#include <fun/option.h>
+#include <fun/result.h>
+
+namespace fun {
+
+namespace range_detail {
+
+//------------------------------------------------------------------------------
+// What an Option or a Result holds, and the same kind of outcome for a `U`
+template <class X>
+struct Outcome {
+  static constexpr bool is_option = false;
+  static constexpr bool is_result = false;
+};
+
+template <class T>
+struct Outcome<Option<T>> {
+  static constexpr bool is_option = true;
+  static constexpr bool is_result = false;
+  using payload_t = T;
+
+  template <class U> using rebind = Option<U>;
+};
+
+template <class T, class E>
+struct Outcome<Result<T, E>> {
+  static constexpr bool is_option = false;
+  static constexpr bool is_result = true;
+  using payload_t = T;
+  using err_t = E;
+
+  template <class U> using rebind = Result<U, E>;
+};
+
+template <class X>
+constexpr bool is_outcome_v = Outcome<X>::is_option || Outcome<X>::is_result;
+
+//------------------------------------------------------------------------------
+template <class X>
+constexpr bool succeeded(const X& x) noexcept {
+  if constexpr (Outcome<X>::is_option) { return x.is_some(); }
+  else                                 { return x.is_ok(); }
+}
+
+// The payload of `x`, an Option or Result that is an `X`. Only payloads of
+// rvalues are moved from, and reference payloads never are.
+// ** only call on `Some`/`Ok` variants, otherwise undefined behavior **
+template <class X, class V>
+constexpr auto forward_payload(V& x) noexcept -> decltype(auto) {
+  auto& payload = *x.as_ptr();
+  using Payload = typename Outcome<std::remove_cv_t<V>>::payload_t;
+  if constexpr (std::is_lvalue_reference_v<X> || std::is_reference_v<Payload>) { return (payload); }
+  else                                                                        { return std::move(payload); }
+}
+
+// A successful `Out` holding a payload constructed from `args`
+template <class Out, class ...Args>
+constexpr auto succeed(Args&& ...args) -> Out {
+  if constexpr (Outcome<Out>::is_option) { return Out(ForwardArgs{}, std::forward<Args>(args)...); }
+  else                                   { return Out(OkTag{}, ForwardArgs{}, std::forward<Args>(args)...); }
+}
+
+// A failed `Out` carrying on the failure of `x`, an `X`
+template <class Out, class X, class V>
+constexpr auto fail(V& x) -> Out {
+  if constexpr (Outcome<Out>::is_option) { return Out(); }
+  else                                   { return Out(ErrTag{}, ForwardArgs{}, result_detail::forward_err<X>(x)); }
+}
+
+//------------------------------------------------------------------------------
+#if defined(__cpp_lib_ranges)
+template <class R>
+constexpr bool is_view_v = std::ranges::view<std::remove_cv_t<std::remove_reference_t<R>>>;
+#else
+template <class R>
+constexpr bool is_view_v = false;
+#endif
+
+template <class R>
+using range_reference_t = decltype(*std::begin(std::declval<R&>()));
+
+template <class R>
+using range_value_t = std::remove_cv_t<std::remove_reference_t<range_reference_t<R>>>;
+
+// How the elements of a range `R` are handed on: as rvalues when they are
+// rvalues already, or when `R` is a container that was passed as an rvalue
+template <class R, class Ref = range_reference_t<R>>
+using element_t = std::conditional_t<
+  std::is_lvalue_reference_v<Ref> && (std::is_lvalue_reference_v<R> || is_view_v<R>),
+  Ref,
+  std::remove_reference_t<Ref>&&
+>;
+
+// Containers hold references as `std::reference_wrapper`s
+template <class T>
+using stored_t = std::conditional_t<std::is_reference_v<T>, std::reference_wrapper<std::remove_reference_t<T>>, T>;
+
+//------------------------------------------------------------------------------
+template <class R, class = void>
+struct has_size : std::false_type {};
+
+template <class R>
+struct has_size<R, std::void_t<decltype(std::size(std::declval<R&>()))>> : std::true_type {};
+
+template <class R, class = void>
+struct has_distance : std::false_type {};
+
+template <class R>
+struct has_distance<R, std::void_t<decltype(std::end(std::declval<R&>()) - std::begin(std::declval<R&>()))>>
+  : std::true_type {};
+
+template <class C, class = void>
+struct has_reserve : std::false_type {};
+
+template <class C>
+struct has_reserve<C, std::void_t<decltype(std::declval<C&>().reserve(std::size_t()))>> : std::true_type {};
+
+template <class C, class V, class = void>
+struct has_emplace_back : std::false_type {};
+
+template <class C, class V>
+struct has_emplace_back<C, V, std::void_t<decltype(std::declval<C&>().emplace_back(std::declval<V>()))>>
+  : std::true_type {};
+
+// Reserves room for every element of `range` where its size is known up front
+template <class C, class R>
+constexpr void reserve_for(C& out, R& range) {
+  if constexpr (has_reserve<C>::value) {
+    if constexpr (has_size<R>::value) {
+      out.reserve(static_cast<std::size_t>(std::size(range)));
+    } else if constexpr (has_distance<R>::value) {
+      out.reserve(static_cast<std::size_t>(std::end(range) - std::begin(range)));
+    }
+  }
+}
+
+template <class C, class V>
+constexpr void append(C& out, V&& val) {
+  if constexpr (has_emplace_back<C, V&&>::value) { out.emplace_back(std::forward<V>(val)); }
+  else                                           { out.insert(out.end(), std::forward<V>(val)); }
+}
+
+template <class C, class R>
+using Collected_t = typename Outcome<range_value_t<R>>::template rebind<C>;
+
+template <class R, class Acc, class F>
+using Folded_t = std::invoke_result_t<F&, Acc&&, element_t<R>>;
+
+template <class R, class F>
+using Done_t = typename Outcome<std::invoke_result_t<F&, element_t<R>>>::template rebind<Unit>;
+
+} // end namespace range_detail
+
+//------------------------------------------------------------------------------
+/**
+ * Gathers the payloads of a range of Options (or Results) into a `C`, stopping at the first None (or Err), i.e. turns
+ * e.g. a `std::vector<Result<T, E>>` into a `Result<std::vector<T>, E>`.
+ *
+ * The container reserves room for every element when the size of `range` is known up front, and each payload is
+ * constructed directly in the container: moved when `range` is an rvalue container or yields rvalues, and copied
+ * otherwise.
+ */
+template <class C, class R>
+constexpr auto collect(R&& range) -> range_detail::Collected_t<C, R> {
+  using Out = range_detail::Collected_t<C, R>;
+  using X = range_detail::element_t<R>;
+
+  auto out = C();
+  range_detail::reserve_for(out, range);
+  for (auto&& x : range) {
+    if (!range_detail::succeeded(x)) { return range_detail::fail<Out, X>(x); }
+    range_detail::append(out, range_detail::forward_payload<X>(x));
+  }
+  return range_detail::succeed<Out>(std::move(out));
+}
+
+//------------------------------------------------------------------------------
+/**
+ * `collect` into a `std::vector`, reference payloads are collected as `std::reference_wrapper`s
+ */
+template <class R>
+constexpr auto sequence(R&& range) {
+  using Payload = typename range_detail::Outcome<range_detail::range_value_t<R>>::payload_t;
+  return fun::collect<std::vector<range_detail::stored_t<Payload>>>(std::forward<R>(range));
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Folds `func` ((Acc, element) -> Option<Acc> or Result<Acc, E>) over `range`, starting from `init`, and stops at the
+ * first None or Err, which is returned as is.
+ */
+template <class R, class Acc, class F>
+constexpr auto try_fold(R&& range, Acc init, F&& func) -> range_detail::Folded_t<R, Acc, F> {
+  using Out = range_detail::Folded_t<R, Acc, F>;
+  static_assert(range_detail::is_outcome_v<Out>, "try_fold needs a function returning an Option or a Result");
+
+  for (auto&& x : range) {
+    auto next = fun::invoke(func, std::move(init), static_cast<range_detail::element_t<R>>(x));
+    if (!range_detail::succeeded(next)) { return next; }
+    init = range_detail::forward_payload<Out&&>(next);
+  }
+  return range_detail::succeed<Out>(std::move(init));
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Calls `func` (element -> Option<U> or Result<U, E>) on each element of `range` until the first None or Err, which is
+ * passed on as an `Option<Unit>` or a `Result<Unit, E>`.
+ */
+template <class R, class F>
+constexpr auto try_for_each(R&& range, F&& func) -> range_detail::Done_t<R, F> {
+  using Step = std::invoke_result_t<F&, range_detail::element_t<R>>;
+  using Out = range_detail::Done_t<R, F>;
+
+  for (auto&& x : range) {
+    auto step = fun::invoke(func, static_cast<range_detail::element_t<R>>(x));
+    if (!range_detail::succeeded(step)) { return range_detail::fail<Out, Step&&>(step); }
+  }
+  return range_detail::succeed<Out>();
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Swaps the nesting of an Option and a Result: None becomes `Ok(None)`, `Some(Ok(x))` becomes `Ok(Some(x))` and
+ * `Some(Err(e))` becomes `Err(e)`, and the other way around. The payload is moved straight into its new place.
+ */
+template <class T, class E>
+constexpr auto transpose(Option<Result<T, E>> op) -> Result<Option<T>, E> {
+  using Out = Result<Option<T>, E>;
+  if (op.is_none()) { return Out(OkTag{}, ForwardArgs{}); }
+
+  auto& res = *op.as_ptr();
+  if (res.is_err()) { return range_detail::fail<Out, Result<T, E>&&>(res); }
+  return Out(OkTag{}, ForwardArgs{}, ForwardArgs{}, range_detail::forward_payload<Result<T, E>&&>(res));
+}
+
+template <class T, class E>
+constexpr auto transpose(Result<Option<T>, E> res) -> Option<Result<T, E>> {
+  using Out = Option<Result<T, E>>;
+  if (res.is_err()) {
+    return Out(ForwardArgs{}, ErrTag{}, ForwardArgs{}, result_detail::forward_err<Result<Option<T>, E>&&>(res));
+  }
+
+  auto& op = *res.as_ptr();
+  if (op.is_none()) { return Out(); }
+  return Out(ForwardArgs{}, OkTag{}, ForwardArgs{}, range_detail::forward_payload<Option<T>&&>(op));
+}
+
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fun/try.h>
+
+namespace fun {
+
+namespace context_detail {
+
+//------------------------------------------------------------------------------
+// A context message, added to the frame numbered `prev` (0 meaning none)
+struct Frame {
+  std::uint32_t prev;
+  char text[56];
+};
+
+//------------------------------------------------------------------------------
+// The frame numbers a thread adds frames under next. They are taken from the
+// store in blocks, so that threads do not contend for every number.
+struct Numbering {
+  std::uint32_t next = 0;
+  std::uint32_t end = 0;
+};
+
+inline thread_local Numbering numbering;
+
+//------------------------------------------------------------------------------
+// Process-wide storage for the last `capacity` context frames, from any
+// thread. Frames are numbered (from 1) and reclaimed by being overwritten, a
+// frame that has since been overwritten being recognized by its number. Each
+// slot is a seqlock, which writers take in turn, so that a reader on any
+// thread copies a frame out whole or finds it gone.
+class ContextStore {
+public:
+  static constexpr std::uint32_t capacity = 4096;
+
+  // Numbers fit in 30 bits, next to the root of an `Error`
+  static constexpr std::uint32_t max_number = (std::uint32_t(1) << 30) - 1;
+
+private:
+  static constexpr std::uint32_t block_size = 64;
+  static constexpr std::uint32_t writing = UINT32_MAX;
+  static constexpr std::size_t text_words = sizeof(Frame::text) / sizeof(std::uint64_t);
+
+  struct alignas(64) Slot {
+    std::atomic<std::uint32_t> number;
+    std::atomic<std::uint32_t> prev;
+    std::atomic<std::uint64_t> text[text_words];
+  };
+
+  // Left to zero-initialization, so that there is no dynamic initialization
+  std::atomic<std::uint32_t> _next_block;
+  Slot _slots[capacity];
+
+public:
+  // Adds `text`, truncated to 55 characters, as a frame added to the frame numbered `prev`, and returns its number
+  auto push(const std::string_view text, const std::uint32_t prev) noexcept -> std::uint32_t {
+    auto& own = numbering;
+    if (own.next == own.end) {
+      const auto start = _next_block.fetch_add(block_size, std::memory_order_relaxed) & max_number;
+      own.next = start == 0 ? 1 : start;
+      own.end = start + block_size;
+    }
+    const auto number = own.next++;
+
+    char buffer[sizeof(Frame::text)] = {};
+    std::memcpy(buffer, text.data(), std::min(text.size(), sizeof(buffer) - 1));
+
+    auto& slot = _slots[number % capacity];
+    auto seen = slot.number.load(std::memory_order_relaxed);
+    do {
+      while (seen == writing) { seen = slot.number.load(std::memory_order_relaxed); }
+    } while (!slot.number.compare_exchange_weak(seen, writing, std::memory_order_acquire, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.prev.store(prev, std::memory_order_relaxed);
+    for (auto i = std::size_t{0}; i < text_words; ++i) {
+      auto word = std::uint64_t{0};
+      std::memcpy(&word, buffer + i * sizeof(word), sizeof(word));
+      slot.text[i].store(word, std::memory_order_relaxed);
+    }
+    slot.number.store(number, std::memory_order_release);
+    return number;
+  }
+
+  // A copy of the frame numbered `number`, unless it has been overwritten
+  auto find(const std::uint32_t number) const noexcept -> Option<Frame> {
+    if (number == 0) { return {}; }
+
+    const auto& slot = _slots[number % capacity];
+    if (slot.number.load(std::memory_order_acquire) != number) { return {}; }
+    auto frame = Frame{ slot.prev.load(std::memory_order_relaxed), {} };
+    for (auto i = std::size_t{0}; i < text_words; ++i) {
+      const auto word = slot.text[i].load(std::memory_order_relaxed);
+      std::memcpy(frame.text + i * sizeof(word), &word, sizeof(word));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.number.load(std::memory_order_relaxed) != number) { return {}; }
+    return Option<Frame>(ForwardArgs{}, frame);
+  }
+};
+
+inline ContextStore context_store;
+
+//------------------------------------------------------------------------------
+// Calls `func(std::string_view)` on the message of the frame numbered
+// `number`, then on those of the frames it was added to, while they are still
+// stored. At most a store's worth are visited, in case frame numbers that
+// wrapped around link frames into a loop.
+template <class F>
+void for_each_message(std::uint32_t number, F&& func) {
+  for (auto i = std::uint32_t{0}; i < ContextStore::capacity; ++i) {
+    const auto frame = context_store.find(number);
+    if (frame.is_none()) { return; }
+    fun::invoke(func, std::string_view(frame.as_ptr()->text));
+    number = frame.as_ptr()->prev;
+  }
+}
+
+// The messages of `for_each_message`, joined by ": "
+inline auto join_messages(const std::uint32_t number) -> std::string {
+  auto out = std::string();
+  for_each_message(number, [&out](const std::string_view text) {
+    if (!out.empty()) { out += ": "; }
+    out += text;
+  });
+  return out;
+}
+
+} // end namespace context_detail
+
+//------------------------------------------------------------------------------
+//! An error code `E` (e.g. a small enumeration) together with a handle to context messages kept aside, in the
+//! process-wide store of the most recent ones. The error stays as small as the code and a 32-bit handle, so that a
+//! `Result<T, Traced<E>>` is still returned in registers, and nothing is recorded unless an error actually occurs.
+//!
+//! Context is added where an error passes through, typically with `map_err`:
+//!
+//!   FUN_TRY_DECLARE(config, load(path).map_err(fun::with_context("loading the config")));
+//!
+//! `FUN_TRY` passes the context on, also when it converts the code (see `ErrorFrom`). It is read back with
+//! `for_each_context` or `context_string`, on any thread, until 4096 newer messages have been added in the process
+//! and have overwritten it. `fun::Error` keeps its context in the same store. Messages are truncated to 55 characters.
+//!
+//! Errors compare by their codes only.
+template <class E>
+class Traced {
+  template <class> friend class Traced;
+
+  E _code;
+  std::uint32_t _context = 0;
+
+  constexpr Traced(const E code, const std::uint32_t context) noexcept : _code(code), _context(context) {}
+
+public:
+  using code_t = E;
+
+  constexpr Traced(const E code) noexcept : _code(code) {}
+
+  //! Carries the context of `other` over to a code converted from its own
+  template <class F>
+  constexpr Traced(const E code, const Traced<F>& other) noexcept : _code(code), _context(other._context) {}
+
+  constexpr auto code() const noexcept -> E { return _code; }
+
+  //! This error, with `text` as its newest context message
+  auto context(const std::string_view text) const noexcept -> Traced {
+    return Traced(_code, context_detail::context_store.push(text, _context));
+  }
+
+  //! Whether any context message is still available
+  auto has_context() const noexcept -> bool { return context_detail::context_store.find(_context).is_some(); }
+
+  //! Calls `func(std::string_view)` on each context message still available, from the newest to the oldest
+  template <class F>
+  void for_each_context(F&& func) const { context_detail::for_each_message(_context, std::forward<F>(func)); }
+
+  //! The context messages, from the newest to the oldest, joined by ": "
+  auto context_string() const -> std::string { return context_detail::join_messages(_context); }
+
+  constexpr bool operator==(const Traced& other) const noexcept { return _code == other._code; }
+  constexpr bool operator!=(const Traced& other) const noexcept { return _code != other._code; }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * A function for `map_err` that adds `text` as a context message to a `Traced` error. `text` is only copied into the
+ * context store if there is an error.
+ */
+inline auto with_context(const std::string_view text) noexcept {
+  return [text](const auto& err) noexcept { return err.context(text); };
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Codes are converted as `ErrorFrom` converts them on their own, and the context is passed on
+ */
+template <class To, class From>
+struct ErrorFrom<Traced<To>, Traced<From>, std::enable_if_t<!std::is_same_v<To, From>>> {
+  static_assert(try_detail::is_convertible_err<To, From>::value, "The codes are not convertible, see fun::ErrorFrom");
+
+  static constexpr auto convert(Traced<From>&& e) -> Traced<To> {
+    return Traced<To>(To(ErrorFrom<To, From>::convert(e.code())), e);
+  }
+};
+
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus > 201703L
+#include <coroutine>
+#endif
+
+#include <fun/collect.h>
+#include <fun/option.h>
+#include <fun/result.h>
+#include <fun/try.h>
+
+//------------------------------------------------------------------------------
+/**
+ * Early return by `co_await`: a function returning an `Option` or a `Result` that is a coroutine, i.e. uses `co_await`
+ * or `co_return`, may `co_await` an Option (or Result) to get its value, or else to return None (or the error) at once.
+ * Unlike the `FUN_TRY` macros, this works within expressions:
+ *
+ *   auto parse_port(std::string_view s) -> fun::Result<std::uint16_t, ParseError> {
+ *     co_return to_port(co_await parse_int(s));
+ *   }
+ *
+ * `co_await` hands over the value of an rvalue by value and that of an lvalue by reference. An awaited Result's error
+ * is converted to the coroutine's error type, and an awaited Option's None to an error, by `fun::ErrorFrom`.
+ *
+ * These coroutines never suspend past their own return, so their frames are created and destroyed in stack order. When
+ * the compiler does not elide a frame's allocation, it is carved out of a per-thread arena instead of the heap.
+ *
+ * The return object must be converted to the Option or Result only once the body has run (CWG 2563), so only GCC 13
+ * and later and Clang 17 and later (Apple Clang 16 and later) are supported, others are rejected with an `#error`.
+ * GCC 12 miscompiles the early return from a `co_await` directly within the condition of an `if` or `switch`, so it is
+ * rejected as well, unless `FUN_ACCEPT_GCC12_COROUTINES` is defined to acknowledge that such awaits must bind their
+ * value first (e.g. in an init-statement).
+ */
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+
+#if defined(__clang__)
+#if defined(__apple_build_version__) ? __clang_major__ < 16 : __clang_major__ < 17
+#error "fun/coroutine.h requires Clang 17 or later (Apple Clang 16 or later), which converts the return object late"
+#endif
+#elif defined(__GNUC__)
+#if __GNUC__ < 12
+#error "fun/coroutine.h requires GCC 13 or later"
+#elif __GNUC__ == 12 && !defined(FUN_ACCEPT_GCC12_COROUTINES)
+#error "GCC 12 miscompiles co_await within if/switch conditions, define FUN_ACCEPT_GCC12_COROUTINES to use it anyway"
+#endif
+#else
+#error "fun/coroutine.h requires GCC or Clang, other compilers convert the return object before the body has run"
+#endif
+
+namespace fun {
+
+namespace coro_detail {
+
+//------------------------------------------------------------------------------
+// A per-thread stack of coroutine frames. Frames that do not fit are
+// allocated from the heap.
+class FrameArena {
+  static constexpr std::size_t capacity = 8 * 1024;
+  static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+  alignas(alignment) std::byte _buffer[capacity] = {};
+  std::size_t _top = 0;
+
+public:
+  auto allocate(std::size_t size) -> void* {
+    size = (size + alignment - 1) / alignment * alignment;
+    if (capacity - _top < size) { return ::operator new(size); }
+
+    auto* frame = _buffer + _top;
+    _top += size;
+    return frame;
+  }
+
+  // Frames are destroyed in the opposite order of their creation, so an
+  // arena frame being destroyed is always the top one
+  void deallocate(void* frame) noexcept {
+    auto* bytes = static_cast<std::byte*>(frame);
+    if (bytes >= _buffer && bytes < _buffer + capacity) { _top = static_cast<std::size_t>(bytes - _buffer); }
+    else                                                { ::operator delete(frame); }
+  }
+};
+
+// Constant-initialized, so that it is reached without a TLS init check
+inline constinit thread_local FrameArena frame_arena;
+
+//------------------------------------------------------------------------------
+template <class Out> class Promise;
+
+// Awaits `X`, an Option or Result of the same kind as `Out`
+template <class Out, class X>
+class Awaiter {
+  using Outcome = range_detail::Outcome<Out>;
+  using Operand = std::remove_reference_t<X>;
+  using Payload = typename range_detail::Outcome<std::remove_cv_t<Operand>>::payload_t;
+  using Resume = std::conditional_t<std::is_lvalue_reference_v<X>, decltype(*std::declval<Operand&>().as_ptr()),
+                                                                    Payload>;
+
+  Operand& _operand;
+
+public:
+  constexpr explicit Awaiter(Operand& operand) noexcept : _operand(operand) {}
+
+  constexpr bool await_ready() const noexcept { return range_detail::succeeded(_operand); }
+
+  // Returns the failure, the frame and this awaiter with it are gone afterwards
+  void await_suspend(const std::coroutine_handle<Promise<Out>> coroutine) {
+    auto& out = *coroutine.promise()._out;
+    if constexpr (Outcome::is_option) {
+      out.emplace();
+    } else {
+      out.emplace(ErrTag{}, ForwardArgs{}, try_detail::propagated_err<typename Outcome::err_t, X>(_operand));
+    }
+    coroutine.destroy();
+  }
+
+  constexpr auto await_resume() -> Resume {
+    return range_detail::forward_payload<X>(_operand);
+  }
+};
+
+//------------------------------------------------------------------------------
+template <class Out>
+class Promise {
+  template <class, class> friend class Awaiter;
+  using Outcome = range_detail::Outcome<Out>;
+
+public:
+  //! Stays in the caller while the coroutine runs, and turns into its Option or Result afterwards
+  class ReturnObject {
+    friend class Promise;
+
+    union { Out _result; };
+    bool _returned = false;
+    std::exception_ptr _exception;
+
+  public:
+    explicit ReturnObject(Promise& promise) noexcept { promise._out = this; }
+
+    ReturnObject(const ReturnObject&) = delete;
+    auto operator=(const ReturnObject&) -> ReturnObject& = delete;
+
+    ~ReturnObject() {
+      if (_returned) { _result.~Out(); }
+    }
+
+    template <class ...Args>
+    void emplace(Args&& ...args) {
+      fun::construct_at(std::addressof(_result), std::forward<Args>(args)...);
+      _returned = true;
+    }
+
+    // The frame is gone by now, any exception that escaped the body is rethrown here
+    operator Out() {
+      if (_exception) { std::rethrow_exception(_exception); }
+      return std::move(_result);
+    }
+  };
+
+private:
+  ReturnObject* _out = nullptr;
+
+public:
+  static auto operator new(const std::size_t size) -> void* { return frame_arena.allocate(size); }
+  static void operator delete(void* const frame) noexcept { frame_arena.deallocate(frame); }
+
+  auto get_return_object() noexcept -> ReturnObject { return ReturnObject(*this); }
+
+  constexpr auto initial_suspend() const noexcept -> std::suspend_never { return {}; }
+  constexpr auto final_suspend() const noexcept -> std::suspend_never { return {}; }
+
+  //! `co_return x` succeeds with `x`, or else returns `x` as the Option or Result (e.g. `fun::nothing()`) it makes
+  template <class U>
+  void return_value(U&& x) {
+    if constexpr (!std::is_constructible_v<typename Outcome::payload_t, U&&>) {
+      _out->emplace(std::forward<U>(x));
+    } else if constexpr (Outcome::is_option) {
+      _out->emplace(ForwardArgs{}, std::forward<U>(x));
+    } else {
+      _out->emplace(OkTag{}, ForwardArgs{}, std::forward<U>(x));
+    }
+  }
+
+  void unhandled_exception() noexcept { _out->_exception = std::current_exception(); }
+
+  template <class U>
+  auto await_transform(Option<U>& op) noexcept -> Awaiter<Out, Option<U>&> {
+    return Awaiter<Out, Option<U>&>(op);
+  }
+
+  template <class U>
+  auto await_transform(Option<U>&& op) noexcept -> Awaiter<Out, Option<U>&&> {
+    return Awaiter<Out, Option<U>&&>(op);
+  }
+
+  template <class U, class X>
+  auto await_transform(Result<U, X>& res) noexcept -> Awaiter<Out, Result<U, X>&> {
+    static_assert(Outcome::is_result, "A Result cannot be awaited in a coroutine returning an Option, use ok()");
+    return Awaiter<Out, Result<U, X>&>(res);
+  }
+
+  template <class U, class X>
+  auto await_transform(Result<U, X>&& res) noexcept -> Awaiter<Out, Result<U, X>&&> {
+    static_assert(Outcome::is_result, "A Result cannot be awaited in a coroutine returning an Option, use ok()");
+    return Awaiter<Out, Result<U, X>&&>(res);
+  }
+
+  // Anything else could suspend the coroutine past its return
+  template <class A>
+  void await_transform(A&&) = delete;
+};
+
+} // end namespace coro_detail
+
+}
+
+template <class T, class ...Args>
+struct std::coroutine_traits<fun::Option<T>, Args...> {
+  using promise_type = fun::coro_detail::Promise<fun::Option<T>>;
+};
+
+template <class T, class E, class ...Args>
+struct std::coroutine_traits<fun::Result<T, E>, Args...> {
+  using promise_type = fun::coro_detail::Promise<fun::Result<T, E>>;
+};
+
+#endif
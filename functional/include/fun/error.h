@@ -0,0 +1,233 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fun/context.h>
+#include <fun/niche.h>
+#include <fun/option.h>
+#include <fun/try.h>
+
+namespace fun {
+
+//------------------------------------------------------------------------------
+/**
+ * A message with static storage duration that an `Error` refers to, together with an optional code, e.g.
+ *
+ *   inline constexpr fun::ErrorMessage port_out_of_range{ "port out of range", EDOM };
+ */
+struct ErrorMessage {
+  const char* text;
+  int code = 0;
+};
+
+namespace error_detail {
+
+//------------------------------------------------------------------------------
+// The messages of the errors that context has been added to, so that an
+// `Error` refers to one by its 32-bit index in the table, next to the number
+// of its context frame. Messages have static storage duration, so they are
+// never removed, and a message finding the table full gets no context.
+class MessageTable {
+  static constexpr std::uint32_t capacity = 4096;
+
+  // Left to zero-initialization, so that there is no dynamic initialization
+  std::atomic<const ErrorMessage*> _entries[capacity];
+
+public:
+  auto index_of(const ErrorMessage& message) noexcept -> Option<std::uint32_t> {
+    const auto hash = std::uint64_t(reinterpret_cast<std::uintptr_t>(&message)) * 0x9E3779B97F4A7C15u;
+    const auto start = static_cast<std::uint32_t>(hash >> 32);
+    for (auto i = std::uint32_t{0}; i < capacity; ++i) {
+      const auto index = (start + i) % capacity;
+      auto* entry = _entries[index].load(std::memory_order_relaxed);
+      if (entry == nullptr && _entries[index].compare_exchange_strong(entry, &message, std::memory_order_relaxed)) {
+        return Option<std::uint32_t>(ForwardArgs{}, index);
+      }
+      if (entry == &message) { return Option<std::uint32_t>(ForwardArgs{}, index); }
+    }
+    return {};
+  }
+
+  auto at(const std::uint32_t index) const noexcept -> const ErrorMessage& {
+    return *_entries[index].load(std::memory_order_relaxed);
+  }
+};
+
+inline MessageTable message_table;
+
+} // end namespace error_detail
+
+//------------------------------------------------------------------------------
+//! A pointer-sized (on 64-bit platforms), trivially copyable error for `Result<T, Error>`, which is then no larger than
+//! a `T` and a pointer.
+//!
+//! An error is rooted in either
+//!   - a code (an `int` or an enumeration), or
+//!   - an `ErrorMessage` with static storage duration,
+//! which it always keeps, and may carry context messages added by `context`. These are kept aside, in the
+//! process-wide store of the most recent ones that `fun::Traced` uses as well (see fun/context.h): they are read from
+//! any thread until 4096 newer messages have overwritten them, after which only the root is left.
+//!
+//! Errors compare equal when they have the same root and the same context.
+//!
+//! Errors propagated by `FUN_TRY` from a `Result<T, int>` (or from an enumeration of codes) become `Error`s on their
+//! own, see `ErrorFrom<Error, ...>` below. Context is added with `map_err`:
+//!
+//!   read_file(path).map_err([](fun::Error e) { return e.context("reading the config"); })
+//!
+class Error {
+  // The two low bits tell the kinds of root apart. The next 32 bits hold a
+  // code or the index of a message in the message table, and the 30 bits
+  // above the number of the newest context frame. Without context, a message
+  // is pointed to instead, the messages being aligned to at least 4 bytes.
+  static constexpr std::uint64_t pointer_tag = 0;
+  static constexpr std::uint64_t code_tag = 1;
+  static constexpr std::uint64_t index_tag = 2;
+  static constexpr std::uint64_t tag_mask = 3;
+
+  static constexpr int frame_shift = 34;
+  static constexpr std::uint64_t root_mask = (std::uint64_t(1) << frame_shift) - 1;
+
+  static_assert(alignof(ErrorMessage) > tag_mask, "Errors need the two low bits of message pointers");
+  static_assert(context_detail::ContextStore::max_number <= UINT64_MAX >> frame_shift, "Frame numbers must fit");
+
+  friend struct NicheTraits<Error>;
+
+  std::uint64_t _bits;
+
+  constexpr explicit Error(const std::uint64_t bits, NicheTag) noexcept : _bits(bits) {}
+
+  constexpr auto tag() const noexcept -> std::uint64_t { return _bits & tag_mask; }
+
+  constexpr auto frame() const noexcept -> std::uint32_t {
+    return tag() == pointer_tag ? 0 : static_cast<std::uint32_t>(_bits >> frame_shift);
+  }
+
+  auto root_message() const noexcept -> const ErrorMessage* {
+    switch (tag()) {
+      case pointer_tag: return reinterpret_cast<const ErrorMessage*>(static_cast<std::uintptr_t>(_bits));
+      case index_tag:   return &error_detail::message_table.at(static_cast<std::uint32_t>((_bits & root_mask) >> 2));
+      default:          return nullptr;
+    }
+  }
+
+  // This error's root, with the context frame numbered `frame` (0 for none)
+  auto with_frame(const std::uint32_t frame) const noexcept -> Error {
+    const auto frame_bits = std::uint64_t(frame) << frame_shift;
+    if (tag() == code_tag) { return Error(frame_bits | (_bits & root_mask), NicheTag{}); }
+
+    const auto& message = *root_message();
+    if (frame != 0) {
+      if (const auto index = error_detail::message_table.index_of(message); index.is_some()) {
+        return Error(frame_bits | (std::uint64_t(*index.as_ptr()) << 2) | index_tag, NicheTag{});
+      }
+    }
+    return Error(message);
+  }
+
+public:
+  constexpr explicit Error(const int code) noexcept
+    : _bits((std::uint64_t(static_cast<std::uint32_t>(code)) << 2) | code_tag)
+  {}
+
+  template <class Enum, std::enable_if_t<std::is_enum_v<Enum>, int> = 0>
+  constexpr explicit Error(const Enum code) noexcept : Error(static_cast<int>(code)) {}
+
+  explicit Error(const ErrorMessage& message) noexcept : _bits(reinterpret_cast<std::uintptr_t>(&message)) {}
+  explicit Error(ErrorMessage&&) = delete;
+
+  //! This error, with `text` (truncated to 55 characters) as its newest context message
+  auto context(const std::string_view text) const noexcept -> Error {
+    return with_frame(context_detail::context_store.push(text, frame()));
+  }
+
+  //! The code of the root error
+  auto code() const noexcept -> int {
+    if (tag() == code_tag) { return static_cast<int>(static_cast<std::uint32_t>(_bits >> 2)); }
+    return root_message()->code;
+  }
+
+  //! The message of the root error, or null for a code
+  auto message() const noexcept -> const char* {
+    const auto* const message = root_message();
+    return message != nullptr ? message->text : nullptr;
+  }
+
+  //! Whether any context message is still available
+  auto has_context() const noexcept -> bool { return context_detail::context_store.find(frame()).is_some(); }
+
+  //! Calls `func(std::string_view)` on each context message still available, from the newest to the oldest
+  template <class F>
+  void for_each_context(F&& func) const { context_detail::for_each_message(frame(), std::forward<F>(func)); }
+
+  //! The context messages, from the newest to the oldest, joined by ": "
+  auto context_string() const -> std::string { return context_detail::join_messages(frame()); }
+
+  //! The error that the newest context message was added to (only its root, once that message is no longer
+  //! available), or None without context
+  auto cause() const noexcept -> Option<Error>;
+
+  //! All the messages from the outermost context on, e.g. "reading the config: bad digit (code 22)"
+  auto to_string() const -> std::string;
+
+  constexpr bool operator==(const Error& other) const noexcept { return _bits == other._bits; }
+  constexpr bool operator!=(const Error& other) const noexcept { return _bits != other._bits; }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * The all-zero `Error` is never formed otherwise, and serves as None of an `Option<Error>`.
+ */
+template <>
+struct NicheTraits<Error> {
+  static constexpr std::size_t count = 1;
+  static constexpr bool reserved = true;
+
+  static constexpr Error make(std::size_t) { return Error(0, NicheTag{}); }
+
+  static constexpr bool is(const Error& x, std::size_t) { return x._bits == 0; }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * Codes (an `int` or an enumeration) are propagated into a `Result<T, Error>` as the `Error` of that code, which is
+ * otherwise only constructed explicitly.
+ */
+template <class Code>
+struct ErrorFrom<Error, Code, std::enable_if_t<std::is_same_v<Code, int> || std::is_enum_v<Code>>> {
+  static constexpr auto convert(const Code code) noexcept -> Error { return Error(code); }
+};
+
+//------------------------------------------------------------------------------
+inline auto Error::cause() const noexcept -> Option<Error> {
+  if (frame() == 0) { return {}; }
+  const auto newest = context_detail::context_store.find(frame());
+  return Option<Error>(ForwardArgs{}, with_frame(newest.is_some() ? newest.as_ptr()->prev : 0));
+}
+
+inline auto Error::to_string() const -> std::string {
+  auto out = context_string();
+  if (!out.empty()) { out += ": "; }
+
+  const auto c = code();
+  if (const auto* const text = message()) {
+    out += text;
+    if (c != 0) { out += " (code " + std::to_string(c) + ")"; }
+  } else {
+    out += "error code " + std::to_string(c);
+  }
+  return out;
+}
+
+}
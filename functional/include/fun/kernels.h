@@ -0,0 +1,923 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <fun/bitmap.h>
+#include <fun/option.h>
+#include <fun/option_vector.h>
+
+//------------------------------------------------------------------------------
+/**
+ * Vectorized kernels over nullable columns, for both the packed layout of `OptionVector<T>` and plain arrays of
+ * `Option<T>`. On x86 with GCC or Clang the kernels are compiled for AVX2 and AVX-512 alongside the scalar fallback
+ * and the widest instruction set supported by the running CPU is picked at runtime. Define `FUN_DISABLE_SIMD` to
+ * compile only the scalar kernels.
+ *
+ * The SIMD paths cover `std::int32_t`, `std::int64_t`, `float` and `double` values, any other type uses the scalar
+ * kernels.
+ */
+#if !defined(FUN_DISABLE_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FUN_SIMD_X86 1
+#include <immintrin.h>
+#define FUN_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define FUN_TARGET_AVX512 __attribute__((target("avx512f,avx2,popcnt")))
+#else
+#define FUN_SIMD_X86 0
+#endif
+
+namespace fun {
+
+namespace simd {
+
+//------------------------------------------------------------------------------
+enum class Isa { Scalar, Avx2, Avx512 };
+
+inline auto detected_isa() -> Isa {
+#if FUN_SIMD_X86
+  static const auto isa = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")) { return Isa::Avx512; }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) { return Isa::Avx2; }
+    return Isa::Scalar;
+  }();
+  return isa;
+#else
+  return Isa::Scalar;
+#endif
+}
+
+inline auto isa_limit() -> std::atomic<Isa>& {
+  static auto limit = std::atomic<Isa>(Isa::Avx512);
+  return limit;
+}
+
+//! Caps the instruction set that kernels dispatch to, e.g. to compare implementations
+inline void limit_isa(const Isa isa) { isa_limit().store(isa, std::memory_order_relaxed); }
+
+inline auto active_isa() -> Isa {
+  const auto limit = isa_limit().load(std::memory_order_relaxed);
+  const auto detected = detected_isa();
+  return static_cast<int>(limit) < static_cast<int>(detected) ? limit : detected;
+}
+
+} // end namespace simd
+
+namespace kernels_detail {
+
+//------------------------------------------------------------------------------
+template <class T>
+constexpr bool is_lane_v =
+  std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::int64_t> ||
+  std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// How an array of `Option<T>` is laid out in memory: either the tag byte at
+// offset 0 followed by the value in the next lane-sized slot (the generic
+// OptionStorage), or the bare value with a NaN niche for None.
+enum class AosLayout { Unsupported, Tagged, Niche };
+
+template <class T>
+constexpr AosLayout aos_layout_v =
+  (!is_lane_v<T> || !std::is_standard_layout_v<Option<T>>)
+    ? AosLayout::Unsupported
+  : std::is_floating_point_v<T>
+    ? (sizeof(Option<T>) == sizeof(T) ? AosLayout::Niche : AosLayout::Unsupported)
+  : (sizeof(Option<T>) == 2 * sizeof(T) && alignof(T) == sizeof(T))
+    ? AosLayout::Tagged
+  : AosLayout::Unsupported;
+
+template <class T>
+using lane_bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+template <class T>
+auto none_bits() -> lane_bits_t<T> {
+  const T none = NicheTraits<T>::make(0);
+  auto bits = lane_bits_t<T>();
+  std::memcpy(&bits, &none, sizeof(T));
+  return bits;
+}
+
+template <class T, bool IsMax>
+constexpr auto min_max_identity() -> T {
+  if constexpr (std::is_floating_point_v<T>) {
+    return IsMax ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+  } else {
+    return IsMax ? std::numeric_limits<T>::lowest() : std::numeric_limits<T>::max();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Scalar views of the two layouts, the SIMD sources below extend them with
+// block-wise masks and loads and fall back on them for the tail.
+template <class T>
+struct BitmapColumn {
+  static constexpr bool is_bitmap = true;
+
+  const T* values;
+  const Bitmap* bits;
+
+  auto size() const -> std::size_t { return bits->size(); }
+  auto is_some(const std::size_t i) const -> bool { return bits->test(i); }
+  auto value(const std::size_t i) const -> const T& { return values[i]; }
+
+  auto count() const -> std::size_t { return bits->count(); }
+  auto find_first(const std::size_t i) const -> std::size_t { return bits->find_next(i); }
+
+  template <class F>
+  void for_each_some(const std::size_t first, F&& func) const {
+    if (first >= size()) { return; }
+    const auto& words = bits->words();
+    auto w = first / Bitmap::word_bits;
+    auto word = words[w] & (~Bitmap::word_t{0} << (first % Bitmap::word_bits));
+    while (true) {
+      for (; word != 0; word &= word - 1) {
+        func(values[w * Bitmap::word_bits + static_cast<std::size_t>(countr_zero(word))]);
+      }
+      if (++w == words.size()) { return; }
+      word = words[w];
+    }
+  }
+};
+
+template <class T>
+struct OptionArray {
+  static constexpr bool is_bitmap = false;
+
+  const Option<T>* ops;
+  std::size_t n;
+
+  auto size() const -> std::size_t { return n; }
+  auto is_some(const std::size_t i) const -> bool { return ops[i].is_some(); }
+  auto value(const std::size_t i) const -> const T& { return *ops[i].as_ptr(); }
+
+  auto count() const -> std::size_t {
+    auto k = std::size_t{0};
+    for (auto i = std::size_t{0}; i < n; ++i) { k += is_some(i) ? 1 : 0; }
+    return k;
+  }
+
+  auto find_first(const std::size_t first) const -> std::size_t {
+    for (auto i = first; i < n; ++i) {
+      if (is_some(i)) { return i; }
+    }
+    return n;
+  }
+
+  template <class F>
+  void for_each_some(const std::size_t first, F&& func) const {
+    for (auto i = first; i < n; ++i) {
+      if (is_some(i)) { func(value(i)); }
+    }
+  }
+};
+
+#if FUN_SIMD_X86
+//------------------------------------------------------------------------------
+// AVX2: masks are vectors with all bits of the present lanes set
+template <class T> struct Avx2Lanes;
+
+template <>
+struct Avx2Lanes<std::int32_t> {
+  using vec = __m256i;
+  FUN_TARGET_AVX2 static auto from_bits(const __m256i x) -> vec { return x; }
+  FUN_TARGET_AVX2 static auto set1(const std::int32_t x) -> vec { return _mm256_set1_epi32(x); }
+  FUN_TARGET_AVX2 static auto add(const vec a, const vec b) -> vec { return _mm256_add_epi32(a, b); }
+  FUN_TARGET_AVX2 static auto min(const vec a, const vec b) -> vec { return _mm256_min_epi32(a, b); }
+  FUN_TARGET_AVX2 static auto max(const vec a, const vec b) -> vec { return _mm256_max_epi32(a, b); }
+  FUN_TARGET_AVX2 static auto select(const vec a, const vec b, const __m256i m) -> vec { return _mm256_blendv_epi8(a, b, m); }
+  FUN_TARGET_AVX2 static auto movemask(const __m256i m) -> unsigned { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+  FUN_TARGET_AVX2 static void store(std::int32_t* out, const vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v); }
+};
+
+template <>
+struct Avx2Lanes<std::int64_t> {
+  using vec = __m256i;
+  FUN_TARGET_AVX2 static auto from_bits(const __m256i x) -> vec { return x; }
+  FUN_TARGET_AVX2 static auto set1(const std::int64_t x) -> vec { return _mm256_set1_epi64x(x); }
+  FUN_TARGET_AVX2 static auto add(const vec a, const vec b) -> vec { return _mm256_add_epi64(a, b); }
+  FUN_TARGET_AVX2 static auto min(const vec a, const vec b) -> vec { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+  FUN_TARGET_AVX2 static auto max(const vec a, const vec b) -> vec { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a)); }
+  FUN_TARGET_AVX2 static auto select(const vec a, const vec b, const __m256i m) -> vec { return _mm256_blendv_epi8(a, b, m); }
+  FUN_TARGET_AVX2 static auto movemask(const __m256i m) -> unsigned { return _mm256_movemask_pd(_mm256_castsi256_pd(m)); }
+  FUN_TARGET_AVX2 static void store(std::int64_t* out, const vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v); }
+};
+
+template <>
+struct Avx2Lanes<float> {
+  using vec = __m256;
+  FUN_TARGET_AVX2 static auto from_bits(const __m256i x) -> vec { return _mm256_castsi256_ps(x); }
+  FUN_TARGET_AVX2 static auto set1(const float x) -> vec { return _mm256_set1_ps(x); }
+  FUN_TARGET_AVX2 static auto add(const vec a, const vec b) -> vec { return _mm256_add_ps(a, b); }
+  FUN_TARGET_AVX2 static auto min(const vec a, const vec b) -> vec { return _mm256_min_ps(a, b); }
+  FUN_TARGET_AVX2 static auto max(const vec a, const vec b) -> vec { return _mm256_max_ps(a, b); }
+  FUN_TARGET_AVX2 static auto select(const vec a, const vec b, const __m256i m) -> vec {
+    return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(m));
+  }
+  FUN_TARGET_AVX2 static auto movemask(const __m256i m) -> unsigned { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+  FUN_TARGET_AVX2 static void store(float* out, const vec v) { _mm256_storeu_ps(out, v); }
+};
+
+template <>
+struct Avx2Lanes<double> {
+  using vec = __m256d;
+  FUN_TARGET_AVX2 static auto from_bits(const __m256i x) -> vec { return _mm256_castsi256_pd(x); }
+  FUN_TARGET_AVX2 static auto set1(const double x) -> vec { return _mm256_set1_pd(x); }
+  FUN_TARGET_AVX2 static auto add(const vec a, const vec b) -> vec { return _mm256_add_pd(a, b); }
+  FUN_TARGET_AVX2 static auto min(const vec a, const vec b) -> vec { return _mm256_min_pd(a, b); }
+  FUN_TARGET_AVX2 static auto max(const vec a, const vec b) -> vec { return _mm256_max_pd(a, b); }
+  FUN_TARGET_AVX2 static auto select(const vec a, const vec b, const __m256i m) -> vec {
+    return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(m));
+  }
+  FUN_TARGET_AVX2 static auto movemask(const __m256i m) -> unsigned { return _mm256_movemask_pd(_mm256_castsi256_pd(m)); }
+  FUN_TARGET_AVX2 static void store(double* out, const vec v) { _mm256_storeu_pd(out, v); }
+};
+
+// `_mm256_permutevar8x32_epi32` indices that move the lanes selected by a
+// movemask to the front, for 32-bit (256 masks) and 64-bit (16 masks) lanes
+template <std::size_t LaneBytes>
+constexpr auto make_avx2_compress_lut() {
+  constexpr auto lanes = 32 / LaneBytes;
+  constexpr auto words = LaneBytes / 4;
+  auto lut = std::array<std::array<std::uint32_t, 8>, (1u << lanes)>();
+  for (auto m = 0u; m < (1u << lanes); ++m) {
+    auto k = 0u;
+    for (auto lane = 0u; lane < lanes; ++lane) {
+      if ((m >> lane) & 1u) {
+        for (auto w = 0u; w < words; ++w) { lut[m][k++] = lane * words + w; }
+      }
+    }
+  }
+  return lut;
+}
+
+template <std::size_t LaneBytes>
+inline constexpr auto avx2_compress_lut = make_avx2_compress_lut<LaneBytes>();
+
+template <class T>
+struct Avx2BitmapSource : BitmapColumn<T> {
+  static constexpr std::size_t width = 32 / sizeof(T);
+
+  explicit Avx2BitmapSource(const BitmapColumn<T>& col) : BitmapColumn<T>(col) {}
+
+  FUN_TARGET_AVX2 auto mask(const std::size_t i) const -> __m256i {
+    const auto word = this->bits->words()[i / Bitmap::word_bits] >> (i % Bitmap::word_bits);
+    if constexpr (sizeof(T) == 4) {
+      const auto lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+      const auto spread = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(word & 0xFF)), lane_bits);
+      return _mm256_cmpeq_epi32(spread, lane_bits);
+    } else {
+      const auto lane_bits = _mm256_setr_epi64x(1, 2, 4, 8);
+      const auto spread = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(word & 0xF)), lane_bits);
+      return _mm256_cmpeq_epi64(spread, lane_bits);
+    }
+  }
+
+  FUN_TARGET_AVX2 auto load(const std::size_t i) const -> __m256i {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(this->values + i));
+  }
+};
+
+template <class T>
+struct Avx2TaggedSource : OptionArray<T> {
+  static constexpr std::size_t width = 32 / sizeof(T);
+
+  explicit Avx2TaggedSource(const OptionArray<T>& col) : OptionArray<T>(col) {}
+
+  // A block of `width` Options spans two 256-bit registers
+  FUN_TARGET_AVX2 auto raw(const std::size_t i, const std::size_t half) const -> __m256i {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(this->ops + i) + half);
+  }
+
+  FUN_TARGET_AVX2 auto mask(const std::size_t i) const -> __m256i {
+    const auto low_byte = _mm256_set1_epi64x(0xFF);
+    const auto some = _mm256_set1_epi64x(OptionUnion<T>::some_tag);
+    if constexpr (sizeof(T) == 4) {
+      // each Option is one 64-bit lane {tag, value}, gather the 32-bit halves
+      const auto a = _mm256_cmpeq_epi64(_mm256_and_si256(raw(i, 0), low_byte), some);
+      const auto b = _mm256_cmpeq_epi64(_mm256_and_si256(raw(i, 1), low_byte), some);
+      const auto even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+      return _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(a, even), _mm256_permutevar8x32_epi32(b, even), 0x20);
+    } else {
+      // each Option is two 64-bit lanes {tag, value}
+      const auto tags = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(raw(i, 0), raw(i, 1)), 0xD8);
+      return _mm256_cmpeq_epi64(_mm256_and_si256(tags, low_byte), some);
+    }
+  }
+
+  FUN_TARGET_AVX2 auto load(const std::size_t i) const -> __m256i {
+    if constexpr (sizeof(T) == 4) {
+      const auto odd = _mm256_setr_epi32(1, 3, 5, 7, 0, 2, 4, 6);
+      return _mm256_permute2x128_si256(
+        _mm256_permutevar8x32_epi32(raw(i, 0), odd), _mm256_permutevar8x32_epi32(raw(i, 1), odd), 0x20
+      );
+    } else {
+      return _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(raw(i, 0), raw(i, 1)), 0xD8);
+    }
+  }
+};
+
+template <class T>
+struct Avx2NicheSource : OptionArray<T> {
+  static constexpr std::size_t width = 32 / sizeof(T);
+
+  lane_bits_t<T> none;
+
+  Avx2NicheSource(const OptionArray<T>& col, const lane_bits_t<T> none_bits) : OptionArray<T>(col), none(none_bits) {}
+
+  FUN_TARGET_AVX2 auto load(const std::size_t i) const -> __m256i {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(this->ops + i));
+  }
+
+  FUN_TARGET_AVX2 auto mask(const std::size_t i) const -> __m256i {
+    const auto all = _mm256_set1_epi32(-1);
+    if constexpr (sizeof(T) == 4) {
+      return _mm256_xor_si256(_mm256_cmpeq_epi32(load(i), _mm256_set1_epi32(static_cast<int>(none))), all);
+    } else {
+      return _mm256_xor_si256(_mm256_cmpeq_epi64(load(i), _mm256_set1_epi64x(static_cast<long long>(none))), all);
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+// AVX-512: masks are the bits of the present lanes
+template <class T> struct Avx512Lanes;
+
+// Folds the lanes of `v` pairwise, halving their number at each step like the
+// `_mm512_reduce_*` intrinsics. Those expand to intrinsics with undefined
+// operands, which GCC 12 reports as maybe uninitialized, so the lanes are
+// folded in memory instead, once per kernel call.
+template <class T, class V, class F>
+FUN_TARGET_AVX512 auto fold_lanes(const V v, const F op) -> T {
+  constexpr auto n = sizeof(V) / sizeof(T);
+  T lanes[n];
+  std::memcpy(lanes, &v, sizeof(V));
+  for (auto w = n / 2; w > 0; w /= 2) {
+    for (auto j = std::size_t{0}; j < w; ++j) { lanes[j] = op(lanes[j], lanes[j + w]); }
+  }
+  return lanes[0];
+}
+
+struct AddLanes {
+  template <class T> constexpr auto operator()(const T a, const T b) const -> T { return a + b; }
+};
+
+struct MinLanes {
+  template <class T> constexpr auto operator()(const T a, const T b) const -> T { return b < a ? b : a; }
+};
+
+struct MaxLanes {
+  template <class T> constexpr auto operator()(const T a, const T b) const -> T { return a < b ? b : a; }
+};
+
+template <>
+struct Avx512Lanes<std::int32_t> {
+  using vec = __m512i;
+  FUN_TARGET_AVX512 static auto from_bits(const __m512i x) -> vec { return x; }
+  FUN_TARGET_AVX512 static auto set1(const std::int32_t x) -> vec { return _mm512_set1_epi32(x); }
+  FUN_TARGET_AVX512 static auto add(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_add_epi32(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto min(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_min_epi32(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto max(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_max_epi32(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static void compress(std::int32_t* out, const std::uint32_t m, const vec v) { _mm512_mask_compressstoreu_epi32(out, m, v); }
+  FUN_TARGET_AVX512 static auto reduce_add(const vec v) -> std::int32_t { return fold_lanes<std::int32_t>(v, AddLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_min(const vec v) -> std::int32_t { return fold_lanes<std::int32_t>(v, MinLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_max(const vec v) -> std::int32_t { return fold_lanes<std::int32_t>(v, MaxLanes()); }
+};
+
+template <>
+struct Avx512Lanes<std::int64_t> {
+  using vec = __m512i;
+  FUN_TARGET_AVX512 static auto from_bits(const __m512i x) -> vec { return x; }
+  FUN_TARGET_AVX512 static auto set1(const std::int64_t x) -> vec { return _mm512_set1_epi64(x); }
+  FUN_TARGET_AVX512 static auto add(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_add_epi64(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto min(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_min_epi64(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto max(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_max_epi64(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static void compress(std::int64_t* out, const std::uint32_t m, const vec v) { _mm512_mask_compressstoreu_epi64(out, m, v); }
+  FUN_TARGET_AVX512 static auto reduce_add(const vec v) -> std::int64_t { return fold_lanes<std::int64_t>(v, AddLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_min(const vec v) -> std::int64_t { return fold_lanes<std::int64_t>(v, MinLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_max(const vec v) -> std::int64_t { return fold_lanes<std::int64_t>(v, MaxLanes()); }
+};
+
+template <>
+struct Avx512Lanes<float> {
+  using vec = __m512;
+  FUN_TARGET_AVX512 static auto from_bits(const __m512i x) -> vec { return _mm512_castsi512_ps(x); }
+  FUN_TARGET_AVX512 static auto set1(const float x) -> vec { return _mm512_set1_ps(x); }
+  FUN_TARGET_AVX512 static auto add(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_add_ps(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto min(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_min_ps(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto max(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_max_ps(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static void compress(float* out, const std::uint32_t m, const vec v) { _mm512_mask_compressstoreu_ps(out, m, v); }
+  FUN_TARGET_AVX512 static auto reduce_add(const vec v) -> float { return fold_lanes<float>(v, AddLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_min(const vec v) -> float { return fold_lanes<float>(v, MinLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_max(const vec v) -> float { return fold_lanes<float>(v, MaxLanes()); }
+};
+
+template <>
+struct Avx512Lanes<double> {
+  using vec = __m512d;
+  FUN_TARGET_AVX512 static auto from_bits(const __m512i x) -> vec { return _mm512_castsi512_pd(x); }
+  FUN_TARGET_AVX512 static auto set1(const double x) -> vec { return _mm512_set1_pd(x); }
+  FUN_TARGET_AVX512 static auto add(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_add_pd(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto min(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_min_pd(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static auto max(const vec acc, const std::uint32_t m, const vec v) -> vec { return _mm512_mask_max_pd(acc, m, acc, v); }
+  FUN_TARGET_AVX512 static void compress(double* out, const std::uint32_t m, const vec v) { _mm512_mask_compressstoreu_pd(out, m, v); }
+  FUN_TARGET_AVX512 static auto reduce_add(const vec v) -> double { return fold_lanes<double>(v, AddLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_min(const vec v) -> double { return fold_lanes<double>(v, MinLanes()); }
+  FUN_TARGET_AVX512 static auto reduce_max(const vec v) -> double { return fold_lanes<double>(v, MaxLanes()); }
+};
+
+template <class T>
+struct Avx512BitmapSource : BitmapColumn<T> {
+  static constexpr std::size_t width = 64 / sizeof(T);
+
+  explicit Avx512BitmapSource(const BitmapColumn<T>& col) : BitmapColumn<T>(col) {}
+
+  FUN_TARGET_AVX512 auto mask(const std::size_t i) const -> std::uint32_t {
+    const auto word = this->bits->words()[i / Bitmap::word_bits] >> (i % Bitmap::word_bits);
+    return static_cast<std::uint32_t>(word & ((std::uint64_t{1} << width) - 1));
+  }
+
+  FUN_TARGET_AVX512 auto load(const std::size_t i, const std::uint32_t m) const -> __m512i {
+    if constexpr (sizeof(T) == 4) { return _mm512_maskz_loadu_epi32(static_cast<__mmask16>(m), this->values + i); }
+    else                          { return _mm512_maskz_loadu_epi64(static_cast<__mmask8>(m), this->values + i); }
+  }
+};
+
+template <class T>
+struct Avx512TaggedSource : OptionArray<T> {
+  static constexpr std::size_t width = 64 / sizeof(T);
+
+  explicit Avx512TaggedSource(const OptionArray<T>& col) : OptionArray<T>(col) {}
+
+  // A block of `width` Options spans two 512-bit registers
+  FUN_TARGET_AVX512 auto raw(const std::size_t i, const std::size_t half) const -> __m512i {
+    return _mm512_loadu_si512(reinterpret_cast<const __m512i*>(this->ops + i) + half);
+  }
+
+  FUN_TARGET_AVX512 auto mask(const std::size_t i) const -> std::uint32_t {
+    const auto low_byte = _mm512_set1_epi64(0xFF);
+    const auto some = _mm512_set1_epi64(OptionUnion<T>::some_tag);
+    if constexpr (sizeof(T) == 4) {
+      const auto a = _mm512_cmpeq_epi64_mask(_mm512_and_si512(raw(i, 0), low_byte), some);
+      const auto b = _mm512_cmpeq_epi64_mask(_mm512_and_si512(raw(i, 1), low_byte), some);
+      return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8);
+    } else {
+      const auto even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+      const auto tags = _mm512_permutex2var_epi64(raw(i, 0), even, raw(i, 1));
+      return _mm512_cmpeq_epi64_mask(_mm512_and_si512(tags, low_byte), some);
+    }
+  }
+
+  FUN_TARGET_AVX512 auto load(const std::size_t i, std::uint32_t) const -> __m512i {
+    if constexpr (sizeof(T) == 4) {
+      // Zero-masked forms, the plain ones have undefined operands that GCC 12
+      // reports as maybe uninitialized
+      const auto a = _mm512_maskz_cvtepi64_epi32(0xFF, _mm512_maskz_srli_epi64(0xFF, raw(i, 0), 32));
+      const auto b = _mm512_maskz_cvtepi64_epi32(0xFF, _mm512_maskz_srli_epi64(0xFF, raw(i, 1), 32));
+      return _mm512_maskz_inserti64x4(0xFF, _mm512_castsi256_si512(a), b, 1);
+    } else {
+      const auto odd = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+      return _mm512_permutex2var_epi64(raw(i, 0), odd, raw(i, 1));
+    }
+  }
+};
+
+template <class T>
+struct Avx512NicheSource : OptionArray<T> {
+  static constexpr std::size_t width = 64 / sizeof(T);
+
+  lane_bits_t<T> none;
+
+  Avx512NicheSource(const OptionArray<T>& col, const lane_bits_t<T> none_bits) : OptionArray<T>(col), none(none_bits) {}
+
+  FUN_TARGET_AVX512 auto load(const std::size_t i, std::uint32_t = 0) const -> __m512i {
+    return _mm512_loadu_si512(reinterpret_cast<const __m512i*>(this->ops + i));
+  }
+
+  FUN_TARGET_AVX512 auto mask(const std::size_t i) const -> std::uint32_t {
+    if constexpr (sizeof(T) == 4) { return _mm512_cmpneq_epi32_mask(load(i), _mm512_set1_epi32(static_cast<int>(none))); }
+    else                          { return _mm512_cmpneq_epi64_mask(load(i), _mm512_set1_epi64(static_cast<long long>(none))); }
+  }
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Kernels: `scalar` takes one of the scalar views, `avx2`/`avx512` take the
+// matching SIMD source, all of them handle the tail past the last full block
+// with the scalar view.
+struct CountSome {
+  template <class Col>
+  static auto scalar(const Col& col) -> std::size_t { return col.count(); }
+
+#if FUN_SIMD_X86
+  template <class Src>
+  FUN_TARGET_AVX2 static auto avx2(const Src& src) -> std::size_t {
+    if constexpr (Src::is_bitmap) {
+      return src.count();
+    } else {
+      using L = Avx2Lanes<std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>>;
+      auto k = std::size_t{0};
+      auto i = std::size_t{0};
+      for (; i + Src::width <= src.size(); i += Src::width) { k += static_cast<std::size_t>(popcount(L::movemask(src.mask(i)))); }
+      for (; i < src.size(); ++i) { k += src.is_some(i) ? 1 : 0; }
+      return k;
+    }
+  }
+
+  template <class Src>
+  FUN_TARGET_AVX512 static auto avx512(const Src& src) -> std::size_t {
+    if constexpr (Src::is_bitmap) {
+      return src.count();
+    } else {
+      auto k = std::size_t{0};
+      auto i = std::size_t{0};
+      for (; i + Src::width <= src.size(); i += Src::width) { k += static_cast<std::size_t>(popcount(src.mask(i))); }
+      for (; i < src.size(); ++i) { k += src.is_some(i) ? 1 : 0; }
+      return k;
+    }
+  }
+#endif
+};
+
+struct SumSome {
+  template <class Col>
+  static auto scalar(const Col& col) {
+    auto total = std::remove_cv_t<std::remove_reference_t<decltype(col.value(0))>>();
+    col.for_each_some(0, [&](const auto& x) { total += x; });
+    return total;
+  }
+
+#if FUN_SIMD_X86
+  template <class Src>
+  FUN_TARGET_AVX2 static auto avx2(const Src& src) {
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>;
+    using L = Avx2Lanes<T>;
+    auto acc = L::set1(T());
+    const auto zero = L::set1(T());
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      acc = L::add(acc, L::select(zero, L::from_bits(src.load(i)), src.mask(i)));
+    }
+    T lanes[Src::width];
+    L::store(lanes, acc);
+    auto total = T();
+    for (const auto x : lanes) { total += x; }
+    src.for_each_some(i, [&](const T& x) { total += x; });
+    return total;
+  }
+
+  template <class Src>
+  FUN_TARGET_AVX512 static auto avx512(const Src& src) {
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>;
+    using L = Avx512Lanes<T>;
+    auto acc = L::set1(T());
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      const auto m = src.mask(i);
+      acc = L::add(acc, m, L::from_bits(src.load(i, m)));
+    }
+    auto total = L::reduce_add(acc);
+    src.for_each_some(i, [&](const T& x) { total += x; });
+    return total;
+  }
+#endif
+};
+
+template <bool IsMax>
+struct MinMaxSome {
+  template <class T>
+  static auto pick(const T& a, const T& b) -> const T& {
+    if constexpr (IsMax) { return (a < b) ? b : a; }
+    else                 { return (b < a) ? b : a; }
+  }
+
+  template <class Col>
+  static auto scalar(const Col& col) {
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(col.value(0))>>;
+    auto best = Option<T>();
+    col.for_each_some(0, [&](const T& x) {
+      if (best.is_some()) { *best.as_ptr() = pick(*best.as_ptr(), x); }
+      else                { best.emplace(x); }
+    });
+    return best;
+  }
+
+#if FUN_SIMD_X86
+  template <class Src>
+  FUN_TARGET_AVX2 static auto avx2(const Src& src) {
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>;
+    using L = Avx2Lanes<T>;
+    const auto identity = L::set1(min_max_identity<T, IsMax>());
+    auto acc = identity;
+    auto any = 0u;
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      const auto m = src.mask(i);
+      any |= L::movemask(m);
+      const auto v = L::select(identity, L::from_bits(src.load(i)), m);
+      if constexpr (IsMax) { acc = L::max(acc, v); }
+      else                 { acc = L::min(acc, v); }
+    }
+    auto best = Option<T>();
+    if (any != 0) {
+      T lanes[Src::width];
+      L::store(lanes, acc);
+      best.emplace(lanes[0]);
+      for (const auto x : lanes) { *best.as_ptr() = pick(*best.as_ptr(), x); }
+    }
+    return merge(std::move(best), src, i);
+  }
+
+  template <class Src>
+  FUN_TARGET_AVX512 static auto avx512(const Src& src) {
+    using T = std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>;
+    using L = Avx512Lanes<T>;
+    auto acc = L::set1(min_max_identity<T, IsMax>());
+    auto any = 0u;
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      const auto m = src.mask(i);
+      any |= m;
+      if constexpr (IsMax) { acc = L::max(acc, m, L::from_bits(src.load(i, m))); }
+      else                 { acc = L::min(acc, m, L::from_bits(src.load(i, m))); }
+    }
+    auto best = Option<T>();
+    if (any != 0) {
+      if constexpr (IsMax) { best.emplace(L::reduce_max(acc)); }
+      else                 { best.emplace(L::reduce_min(acc)); }
+    }
+    return merge(std::move(best), src, i);
+  }
+#endif
+
+  template <class T, class Col>
+  static auto merge(Option<T> best, const Col& col, const std::size_t first) -> Option<T> {
+    col.for_each_some(first, [&](const T& x) {
+      if (best.is_some()) { *best.as_ptr() = pick(*best.as_ptr(), x); }
+      else                { best.emplace(x); }
+    });
+    return best;
+  }
+};
+
+struct CompactSome {
+  template <class Col, class T>
+  static auto scalar(const Col& col, T* out, std::size_t) -> std::size_t {
+    auto k = std::size_t{0};
+    col.for_each_some(0, [&](const T& x) { out[k++] = x; });
+    return k;
+  }
+
+#if FUN_SIMD_X86
+  template <class Src, class T>
+  FUN_TARGET_AVX2 static auto avx2(const Src& src, T* out, const std::size_t capacity) -> std::size_t {
+    using L = Avx2Lanes<T>;
+    const auto& lut = avx2_compress_lut<sizeof(T)>;
+    auto k = std::size_t{0};
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      const auto bits = L::movemask(src.mask(i));
+      if (bits == 0) { continue; }
+      const auto perm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lut[bits].data()));
+      const auto packed = L::from_bits(_mm256_permutevar8x32_epi32(src.load(i), perm));
+      const auto n = static_cast<std::size_t>(popcount(bits));
+      if (k + Src::width <= capacity) {
+        L::store(out + k, packed);
+      } else {
+        T lanes[Src::width];
+        L::store(lanes, packed);
+        std::memcpy(out + k, lanes, n * sizeof(T));
+      }
+      k += n;
+    }
+    src.for_each_some(i, [&](const T& x) { out[k++] = x; });
+    return k;
+  }
+
+  template <class Src, class T>
+  FUN_TARGET_AVX512 static auto avx512(const Src& src, T* out, std::size_t) -> std::size_t {
+    using L = Avx512Lanes<T>;
+    auto k = std::size_t{0};
+    auto i = std::size_t{0};
+    for (; i + Src::width <= src.size(); i += Src::width) {
+      const auto m = src.mask(i);
+      if (m == 0) { continue; }
+      L::compress(out + k, m, L::from_bits(src.load(i, m)));
+      k += static_cast<std::size_t>(popcount(m));
+    }
+    src.for_each_some(i, [&](const T& x) { out[k++] = x; });
+    return k;
+  }
+#endif
+};
+
+struct FindFirstSome {
+  template <class Col>
+  static auto scalar(const Col& col) -> std::size_t { return col.find_first(0); }
+
+#if FUN_SIMD_X86
+  template <class Src>
+  FUN_TARGET_AVX2 static auto avx2(const Src& src) -> std::size_t {
+    if constexpr (Src::is_bitmap) {
+      // skip four empty words at a time
+      const auto& words = src.bits->words();
+      auto w = std::size_t{0};
+      for (; w + 4 <= words.size(); w += 4) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + w));
+        if (!_mm256_testz_si256(v, v)) { break; }
+      }
+      return src.find_first(w * Bitmap::word_bits);
+    } else {
+      using L = Avx2Lanes<std::remove_cv_t<std::remove_reference_t<decltype(src.value(0))>>>;
+      auto i = std::size_t{0};
+      for (; i + Src::width <= src.size(); i += Src::width) {
+        const auto bits = L::movemask(src.mask(i));
+        if (bits != 0) { return i + static_cast<std::size_t>(countr_zero(bits)); }
+      }
+      return src.find_first(i);
+    }
+  }
+
+  template <class Src>
+  FUN_TARGET_AVX512 static auto avx512(const Src& src) -> std::size_t {
+    if constexpr (Src::is_bitmap) {
+      // skip eight empty words at a time
+      const auto& words = src.bits->words();
+      auto w = std::size_t{0};
+      for (; w + 8 <= words.size(); w += 8) {
+        const auto v = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(words.data() + w));
+        if (_mm512_test_epi64_mask(v, v) != 0) { break; }
+      }
+      return src.find_first(w * Bitmap::word_bits);
+    } else {
+      auto i = std::size_t{0};
+      for (; i + Src::width <= src.size(); i += Src::width) {
+        const auto m = src.mask(i);
+        if (m != 0) { return i + static_cast<std::size_t>(countr_zero(m)); }
+      }
+      return src.find_first(i);
+    }
+  }
+#endif
+};
+
+//------------------------------------------------------------------------------
+template <class Kernel, class T, class ...Args>
+auto run(const OptionVector<T>& column, Args... args) {
+  const auto col = BitmapColumn<T>{ column.values().data(), &column.presence() };
+#if FUN_SIMD_X86
+  if constexpr (is_lane_v<T>) {
+    switch (simd::active_isa()) {
+      case simd::Isa::Avx512: return Kernel::avx512(Avx512BitmapSource<T>(col), args...);
+      case simd::Isa::Avx2:   return Kernel::avx2(Avx2BitmapSource<T>(col), args...);
+      case simd::Isa::Scalar: break;
+    }
+  }
+#endif
+  return Kernel::scalar(col, args...);
+}
+
+template <class Kernel, class T, class ...Args>
+auto run(const Option<T>* ops, const std::size_t n, Args... args) {
+  const auto col = OptionArray<T>{ ops, n };
+#if FUN_SIMD_X86
+  if constexpr (aos_layout_v<T> == AosLayout::Tagged) {
+    switch (simd::active_isa()) {
+      case simd::Isa::Avx512: return Kernel::avx512(Avx512TaggedSource<T>(col), args...);
+      case simd::Isa::Avx2:   return Kernel::avx2(Avx2TaggedSource<T>(col), args...);
+      case simd::Isa::Scalar: break;
+    }
+  } else if constexpr (aos_layout_v<T> == AosLayout::Niche) {
+    switch (simd::active_isa()) {
+      case simd::Isa::Avx512: return Kernel::avx512(Avx512NicheSource<T>(col, none_bits<T>()), args...);
+      case simd::Isa::Avx2:   return Kernel::avx2(Avx2NicheSource<T>(col, none_bits<T>()), args...);
+      case simd::Isa::Scalar: break;
+    }
+  }
+#endif
+  return Kernel::scalar(col, args...);
+}
+
+} // end namespace kernels_detail
+
+//==============================================================================
+// Masked reductions and compaction over nullable columns
+//------------------------------------------------------------------------------
+template <class T>
+auto count_some(const OptionVector<T>& column) -> std::size_t {
+  return kernels_detail::run<kernels_detail::CountSome>(column);
+}
+
+template <class T>
+auto count_some(const Option<T>* ops, const std::size_t n) -> std::size_t {
+  return kernels_detail::run<kernels_detail::CountSome>(ops, n);
+}
+
+template <class T>
+auto count_some(const std::vector<Option<T>>& ops) -> std::size_t { return count_some(ops.data(), ops.size()); }
+
+//------------------------------------------------------------------------------
+//!
+//! Sum of the present values, or `T()` if there are none.
+//!
+//! @note The SIMD kernels accumulate in several lanes, so floating point sums
+//!       may differ from a sequential sum by rounding.
+//!
+template <class T>
+auto sum_some(const OptionVector<T>& column) -> T { return kernels_detail::run<kernels_detail::SumSome>(column); }
+
+template <class T>
+auto sum_some(const Option<T>* ops, const std::size_t n) -> T {
+  return kernels_detail::run<kernels_detail::SumSome>(ops, n);
+}
+
+template <class T>
+auto sum_some(const std::vector<Option<T>>& ops) -> T { return sum_some(ops.data(), ops.size()); }
+
+//------------------------------------------------------------------------------
+//!
+//! Smallest/largest present value, or None if there are none.
+//!
+//! @note The result is unspecified if a present floating point value is NaN.
+//!
+template <class T>
+auto min_some(const OptionVector<T>& column) -> Option<T> {
+  return kernels_detail::run<kernels_detail::MinMaxSome<false>>(column);
+}
+
+template <class T>
+auto min_some(const Option<T>* ops, const std::size_t n) -> Option<T> {
+  return kernels_detail::run<kernels_detail::MinMaxSome<false>>(ops, n);
+}
+
+template <class T>
+auto min_some(const std::vector<Option<T>>& ops) -> Option<T> { return min_some(ops.data(), ops.size()); }
+
+template <class T>
+auto max_some(const OptionVector<T>& column) -> Option<T> {
+  return kernels_detail::run<kernels_detail::MinMaxSome<true>>(column);
+}
+
+template <class T>
+auto max_some(const Option<T>* ops, const std::size_t n) -> Option<T> {
+  return kernels_detail::run<kernels_detail::MinMaxSome<true>>(ops, n);
+}
+
+template <class T>
+auto max_some(const std::vector<Option<T>>& ops) -> Option<T> { return max_some(ops.data(), ops.size()); }
+
+//------------------------------------------------------------------------------
+//!
+//! Stream compaction: the present values, in order.
+//!
+template <class T>
+auto compact_some(const OptionVector<T>& column) -> std::vector<T> {
+  auto out = std::vector<T>(count_some(column));
+  kernels_detail::run<kernels_detail::CompactSome>(column, out.data(), out.size());
+  return out;
+}
+
+template <class T>
+auto compact_some(const Option<T>* ops, const std::size_t n) -> std::vector<T> {
+  auto out = std::vector<T>(count_some(ops, n));
+  kernels_detail::run<kernels_detail::CompactSome>(ops, n, out.data(), out.size());
+  return out;
+}
+
+template <class T>
+auto compact_some(const std::vector<Option<T>>& ops) -> std::vector<T> { return compact_some(ops.data(), ops.size()); }
+
+//------------------------------------------------------------------------------
+//!
+//! Index of the first present value, or None if there is none.
+//!
+template <class T>
+auto find_first_some(const OptionVector<T>& column) -> Option<std::size_t> {
+  const auto i = kernels_detail::run<kernels_detail::FindFirstSome>(column);
+  if (i < column.size()) { return some(i); }
+  else                   { return {}; }
+}
+
+template <class T>
+auto find_first_some(const Option<T>* ops, const std::size_t n) -> Option<std::size_t> {
+  const auto i = kernels_detail::run<kernels_detail::FindFirstSome>(ops, n);
+  if (i < n) { return some(i); }
+  else       { return {}; }
+}
+
+template <class T>
+auto find_first_some(const std::vector<Option<T>>& ops) -> Option<std::size_t> {
+  return find_first_some(ops.data(), ops.size());
+}
+
+}
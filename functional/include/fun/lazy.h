@@ -0,0 +1,277 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <fun/result/result.impl.h>
+
+namespace fun {
+
+namespace lazy_detail {
+
+//------------------------------------------------------------------------------
+// Recorded stages of a lazy chain
+template <class F> struct MapStage { F func; };
+template <class F> struct MapErrStage { F func; };
+template <class F> struct AndThenStage { F func; };
+template <class F> struct FilterStage { F func; };
+
+template <class Stage> struct is_map : std::false_type {};
+template <class F> struct is_map<MapStage<F>> : std::true_type {};
+
+template <class Stage> struct is_map_err : std::false_type {};
+template <class F> struct is_map_err<MapErrStage<F>> : std::true_type {};
+
+template <class Stage> struct is_and_then : std::false_type {};
+template <class F> struct is_and_then<AndThenStage<F>> : std::true_type {};
+
+template <class R> struct ResultParts;
+template <class T, class E> struct ResultParts<Result<T, E>> {
+  using ok_t = T;
+  using err_t = E;
+};
+
+//------------------------------------------------------------------------------
+// The value type that comes out of a chain of Option stages applied to `V`
+template <class V, class ...Stages>
+struct OptionChain { using type = V; };
+
+template <class V, class F, class ...Stages>
+struct OptionChain<V, MapStage<F>, Stages...> : OptionChain<InvokeResult_t<F&, V>, Stages...> {};
+
+template <class V, class F, class ...Stages>
+struct OptionChain<V, AndThenStage<F>, Stages...>
+  : OptionChain<typename std::invoke_result_t<F&, V>::Inner, Stages...> {};
+
+template <class V, class F, class ...Stages>
+struct OptionChain<V, FilterStage<F>, Stages...> : OptionChain<V, Stages...> {};
+
+//------------------------------------------------------------------------------
+// The Ok and Err types that come out of a chain of Result stages
+template <class V, class E, class ...Stages>
+struct ResultChain {
+  using ok_t = V;
+  using err_t = E;
+};
+
+template <class V, class E, class F, class ...Stages>
+struct ResultChain<V, E, MapStage<F>, Stages...> : ResultChain<InvokeResult_t<F&, V>, E, Stages...> {};
+
+template <class V, class E, class F, class ...Stages>
+struct ResultChain<V, E, MapErrStage<F>, Stages...> : ResultChain<V, InvokeResult_t<F&, E>, Stages...> {};
+
+template <class V, class E, class F, class ...Stages>
+struct ResultChain<V, E, AndThenStage<F>, Stages...>
+  : ResultChain<typename ResultParts<std::invoke_result_t<F&, V>>::ok_t, E, Stages...> {};
+
+} // end namespace lazy_detail
+
+//==============================================================================
+//!
+//! LazyOption type
+//!
+//! A chain of `map`, `and_then` and `filter` calls on an Option that is only
+//! run by `eval()`. The whole chain is fused at compile time: the source is
+//! tested once, each stage's result is handed straight to the next stage, and
+//! only the final value is moved into the resulting Option. `and_then` and
+//! `filter` stages still branch on their own outcome.
+//!
+//! Obtained from `Option::lazy()`, e.g.
+//!
+//!   auto port = std::move(field).lazy().map(trim).and_then(parse_int).filter(in_range).eval();
+//!
+//! @note Like the other calls that consume an Option, `lazy()` is only
+//!       callable on an rvalue. The chain refers to that Option rather than
+//!       moving it along from stage to stage, so `eval()` must be called
+//!       within the same full expression, before a temporary source goes away.
+//!
+template <class T, class ...Stages>
+class LazyOption {
+public:
+  using self_t = LazyOption<T, Stages...>;
+  using output_t = typename lazy_detail::OptionChain<T, Stages...>::type;
+
+private:
+  Option<T>* _source;
+  std::tuple<Stages...> _stages;
+
+  template <class Stage>
+  constexpr auto then(Stage&& stage) && -> LazyOption<T, Stages..., std::decay_t<Stage>> {
+    return LazyOption<T, Stages..., std::decay_t<Stage>>(
+      *_source, std::tuple_cat(std::move(_stages), std::make_tuple(std::forward<Stage>(stage)))
+    );
+  }
+
+  template <std::size_t I, class V>
+  constexpr auto run(V&& val) -> Option<output_t> {
+    if constexpr (I == sizeof...(Stages)) {
+      return Option<output_t>(ForwardArgs{}, std::forward<V>(val));
+    } else {
+      using Stage = std::tuple_element_t<I, std::tuple<Stages...>>;
+      auto& stage = std::get<I>(_stages);
+      if constexpr (lazy_detail::is_map<Stage>::value) {
+        return run<I + 1>(unvoid_call(stage.func, std::forward<V>(val)));
+      } else if constexpr (lazy_detail::is_and_then<Stage>::value) {
+        auto next = fun::invoke(stage.func, std::forward<V>(val));
+        using Inner = typename decltype(next)::Inner;
+        if (next.is_some()) { return run<I + 1>(static_cast<Inner&&>(*next.as_ptr())); }
+        else                { return {}; }
+      } else {
+        if (fun::invoke(stage.func, std::as_const(val))) { return run<I + 1>(std::forward<V>(val)); }
+        else                                             { return {}; }
+      }
+    }
+  }
+
+public:
+  constexpr LazyOption(Option<T>& source, std::tuple<Stages...> stages)
+    : _source(std::addressof(source))
+    , _stages(std::move(stages))
+  {}
+
+  //! Records `func` (T -> U) to be mapped over the value
+  template <class F>
+  constexpr auto map(F&& func) && {
+    return std::move(*this).then(lazy_detail::MapStage<std::decay_t<F>>{ std::forward<F>(func) });
+  }
+
+  //! Records `func` (T -> Option<U>) to be chained onto the value
+  template <class F>
+  constexpr auto and_then(F&& func) && {
+    return std::move(*this).then(lazy_detail::AndThenStage<std::decay_t<F>>{ std::forward<F>(func) });
+  }
+
+  //! Records `predicate` (const T& -> bool) to discard the value with
+  template <class F>
+  constexpr auto filter(F&& predicate) && {
+    return std::move(*this).then(lazy_detail::FilterStage<std::decay_t<F>>{ std::forward<F>(predicate) });
+  }
+
+  //! Runs the recorded chain
+  constexpr auto eval() && -> Option<output_t> {
+    if (_source->is_some()) { return run<0>(static_cast<T&&>(*_source->as_ptr())); }
+    else                   { return {}; }
+  }
+};
+
+//------------------------------------------------------------------------------
+template <class T>
+constexpr auto Option<T>::lazy() && noexcept -> LazyOption<T> {
+  return LazyOption<T>(*this, std::tuple<>());
+}
+
+//==============================================================================
+//!
+//! LazyResult type
+//!
+//! A chain of `map`, `map_err` and `and_then` calls on a Result that is only
+//! run by `eval()`, fused at compile time like `LazyOption`: the source is
+//! tested once, Ok values flow through the `map` and `and_then` stages and
+//! errors through the `map_err` stages, and only the final value or error is
+//! moved into the resulting Result.
+//!
+//! Obtained from `Result::lazy()`.
+//!
+//! @note As with `LazyOption`, `lazy()` is only callable on an rvalue and the
+//!       chain refers to that Result, so `eval()` must be called within the
+//!       same full expression.
+//!
+template <class T, class E, class ...Stages>
+class LazyResult {
+public:
+  using self_t = LazyResult<T, E, Stages...>;
+  using ok_t = typename lazy_detail::ResultChain<T, E, Stages...>::ok_t;
+  using err_t = typename lazy_detail::ResultChain<T, E, Stages...>::err_t;
+
+private:
+  Result<T, E>* _source;
+  std::tuple<Stages...> _stages;
+
+  template <class Stage>
+  constexpr auto then(Stage&& stage) && -> LazyResult<T, E, Stages..., std::decay_t<Stage>> {
+    return LazyResult<T, E, Stages..., std::decay_t<Stage>>(
+      *_source, std::tuple_cat(std::move(_stages), std::make_tuple(std::forward<Stage>(stage)))
+    );
+  }
+
+  // Runs the stages from `I` on an Ok value, `Err` is the error type at stage `I`
+  template <std::size_t I, class Err, class V>
+  constexpr auto run_ok(V&& val) -> Result<ok_t, err_t> {
+    if constexpr (I == sizeof...(Stages)) {
+      return { OkTag{}, ForwardArgs{}, std::forward<V>(val) };
+    } else {
+      using Stage = std::tuple_element_t<I, std::tuple<Stages...>>;
+      auto& stage = std::get<I>(_stages);
+      if constexpr (lazy_detail::is_map<Stage>::value) {
+        return run_ok<I + 1, Err>(unvoid_call(stage.func, std::forward<V>(val)));
+      } else if constexpr (lazy_detail::is_map_err<Stage>::value) {
+        return run_ok<I + 1, InvokeResult_t<decltype(stage.func)&, Err>>(std::forward<V>(val));
+      } else {
+        auto next = fun::invoke(stage.func, std::forward<V>(val));
+        if (next.is_ok()) { return run_ok<I + 1, Err>(std::move(next).unwrap()); }
+        else              { return run_err<I + 1>(static_cast<Err>(std::move(next).unwrap_err())); }
+      }
+    }
+  }
+
+  // Runs the stages from `I` on an error, only `map_err` stages apply
+  template <std::size_t I, class X>
+  constexpr auto run_err(X&& err) -> Result<ok_t, err_t> {
+    if constexpr (I == sizeof...(Stages)) {
+      return { ErrTag{}, ForwardArgs{}, std::forward<X>(err) };
+    } else {
+      using Stage = std::tuple_element_t<I, std::tuple<Stages...>>;
+      if constexpr (lazy_detail::is_map_err<Stage>::value) {
+        return run_err<I + 1>(unvoid_call(std::get<I>(_stages).func, std::forward<X>(err)));
+      } else {
+        return run_err<I + 1>(std::forward<X>(err));
+      }
+    }
+  }
+
+public:
+  constexpr LazyResult(Result<T, E>& source, std::tuple<Stages...> stages)
+    : _source(std::addressof(source))
+    , _stages(std::move(stages))
+  {}
+
+  //! Records `func` (T -> U) to be mapped over the Ok value
+  template <class F>
+  constexpr auto map(F&& func) && {
+    return std::move(*this).then(lazy_detail::MapStage<std::decay_t<F>>{ std::forward<F>(func) });
+  }
+
+  //! Records `func` (E -> X) to be mapped over the error
+  template <class F>
+  constexpr auto map_err(F&& func) && {
+    return std::move(*this).then(lazy_detail::MapErrStage<std::decay_t<F>>{ std::forward<F>(func) });
+  }
+
+  //! Records `func` (T -> Result<U, E>) to be chained onto the Ok value
+  template <class F>
+  constexpr auto and_then(F&& func) && {
+    return std::move(*this).then(lazy_detail::AndThenStage<std::decay_t<F>>{ std::forward<F>(func) });
+  }
+
+  //! Runs the recorded chain
+  constexpr auto eval() && -> Result<ok_t, err_t> {
+    if (_source->is_ok()) { return run_ok<0, E>(std::move(*_source).unwrap()); }
+    else                  { return run_err<0>(std::move(*_source).unwrap_err()); }
+  }
+};
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+constexpr auto Result<T, E>::lazy() && noexcept -> LazyResult<T, E> {
+  return LazyResult<T, E>(*this, std::tuple<>());
+}
+
+}
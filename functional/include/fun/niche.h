@@ -0,0 +1,189 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#if __cplusplus > 201703L
+#include <bit>
+#endif
+
+namespace fun {
+
+//------------------------------------------------------------------------------
+/**
+ * Customization point describing the "niches" of a type, i.e. values of `T` that a program never uses as real data and
+ * that `Option` may therefore borrow to represent "None" without a separate tag.
+ *
+ * The primary template describes a type without niches. A specialization with a nonzero `count` must provide:
+ *
+ *   static T make(std::size_t i);              // the i-th niche value, for i < count
+ *   static bool is(const T& x, std::size_t i); // whether `x` holds the i-th niche value
+ *
+ * A specialization may also declare `static constexpr bool reserved = true;` when its niche values can never be
+ * formed as real values of `T` (e.g. declared sentinels, the spare states of a nested `Option`). Only such niches are
+ * used to tell apart the alternatives of a `Result`, where a legitimate value must never read back as the other one.
+ *
+ * @note Niche values are indistinguishable from None, which is why pointers only lend out null when asked to (see
+ *       `EnableNullNiche`).
+ */
+template <class T, class En = void>
+struct NicheTraits {
+  static constexpr std::size_t count = 0;
+};
+
+template <class T>
+constexpr bool has_niche_v = NicheTraits<T>::count != 0;
+
+template <class T, class = void>
+struct HasReservedNiche : std::false_type {};
+
+template <class T>
+struct HasReservedNiche<T, std::enable_if_t<NicheTraits<T>::reserved>> : std::bool_constant<has_niche_v<T>> {};
+
+template <class T>
+constexpr bool has_reserved_niche_v = HasReservedNiche<T>::value;
+
+//------------------------------------------------------------------------------
+/**
+ * Selects the constructor that puts the storage of an `Option` or `Result` into one of its niche states (see
+ * `NicheTraits<Option<T>>`, `NicheTraits<Result<T, E>>`).
+ */
+struct NicheTag {};
+
+//------------------------------------------------------------------------------
+/**
+ * Helper for user-declared niches: the listed values of an integral or enumeration type become the niches of that
+ * type, e.g.
+ *
+ *   template <> struct fun::NicheTraits<Errc> : fun::SentinelNiche<Errc, Errc(-1)> {};
+ */
+template <class T, T ...Values>
+struct SentinelNiche {
+  static constexpr std::size_t count = sizeof...(Values);
+  static constexpr bool reserved = true;
+
+  static constexpr T make(const std::size_t i) {
+    constexpr T values[] = { Values... };
+    return values[i];
+  }
+
+  static constexpr bool is(const T& x, const std::size_t i) { return x == make(i); }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * Helper for enumerations whose enumerators all lie at or below `Last`: the (up to 256) underlying values directly
+ * above `Last` become the niches of the enumeration, e.g.
+ *
+ *   template <> struct fun::NicheTraits<Color> : fun::OutOfRangeNiche<Color, Color::Blue> {};
+ */
+template <class E, E Last>
+struct OutOfRangeNiche {
+  using underlying_t = std::underlying_type_t<E>;
+  static constexpr bool reserved = true;
+
+  // The number of underlying values above `Last`, counted in two parts when
+  // `Last` is negative so that no conversion wraps around
+  static constexpr auto headroom() -> std::uintmax_t {
+    constexpr auto max = static_cast<std::uintmax_t>(std::numeric_limits<underlying_t>::max());
+    constexpr auto last = static_cast<underlying_t>(Last);
+    if constexpr (std::is_signed_v<underlying_t>) {
+      if (last < 0) { return max + static_cast<std::uintmax_t>(-(last + 1)) + 1; }
+    }
+    return max - static_cast<std::uintmax_t>(last);
+  }
+
+  static constexpr std::size_t count = std::min<std::uintmax_t>(256, headroom());
+
+  static constexpr E make(const std::size_t i) {
+    return static_cast<E>(static_cast<underlying_t>(Last) + 1 + static_cast<underlying_t>(i));
+  }
+
+  static constexpr bool is(const E& x, const std::size_t i) { return x == make(i); }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * Opt-in for null as the niche of a pointer type `P`, a raw pointer or a `std::unique_ptr` (with the default deleter):
+ * specialize as `std::true_type` where a null `P` is never a meaningful value, e.g.
+ *
+ *   template <> struct fun::EnableNullNiche<const Node*> : std::true_type {};
+ *
+ * An `Option<P>` is then no larger than a `P`, and `fun::some(P(nullptr))` is None. Otherwise a null pointer is a Some
+ * like any other value.
+ */
+template <class P>
+struct EnableNullNiche : std::false_type {};
+
+template <class T>
+struct NicheTraits<T*, std::enable_if_t<EnableNullNiche<T*>::value>> {
+  static constexpr std::size_t count = 1;
+
+  static constexpr T* make(std::size_t) { return nullptr; }
+
+  static constexpr bool is(T* const& x, std::size_t) { return x == nullptr; }
+};
+
+template <class T>
+struct NicheTraits<std::unique_ptr<T>, std::enable_if_t<EnableNullNiche<std::unique_ptr<T>>::value>> {
+  static constexpr std::size_t count = 1;
+
+  static std::unique_ptr<T> make(std::size_t) { return nullptr; }
+
+  static bool is(const std::unique_ptr<T>& x, std::size_t) { return x == nullptr; }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * Floating point types use quiet NaNs with an unusual payload as niches. Only those exact bit patterns are reserved,
+ * ordinary NaNs produced by arithmetic remain valid "Some" values. Usable in constant expressions only with
+ * `std::bit_cast` (C++20).
+ */
+template <class T, class Bits, Bits Base>
+struct NanNiche {
+  static_assert(sizeof(T) == sizeof(Bits), "NanNiche requires a same-sized integer representation");
+
+  static constexpr std::size_t count = 256;
+
+#if defined(__cpp_lib_bit_cast)
+  static constexpr T make(const std::size_t i) { return std::bit_cast<T>(bits_of(i)); }
+
+  static constexpr bool is(const T& x, const std::size_t i) { return std::bit_cast<Bits>(x) == bits_of(i); }
+#else
+  static T make(const std::size_t i) {
+    const auto bits = bits_of(i);
+    T x;
+    std::memcpy(&x, &bits, sizeof(T));
+    return x;
+  }
+
+  static bool is(const T& x, const std::size_t i) {
+    Bits bits;
+    std::memcpy(&bits, &x, sizeof(T));
+    return bits == bits_of(i);
+  }
+#endif
+
+private:
+  static constexpr Bits bits_of(const std::size_t i) { return static_cast<Bits>(Base | static_cast<Bits>(i)); }
+};
+
+template <>
+struct NicheTraits<float>
+  : NanNiche<float, std::uint32_t, 0x7FEF'0000u> {};
+
+template <>
+struct NicheTraits<double>
+  : NanNiche<double, std::uint64_t, 0x7FFE'F00D'0000'0000u> {};
+
+}
@@ -1,3 +1,4 @@
 #pragma once
 
 #include <fun/option/option.impl.h>
+#include <fun/lazy.h>
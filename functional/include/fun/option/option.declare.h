@@ -10,7 +10,9 @@
 #include <stdexcept>
 #include <type_traits>
 #include <cassert>
+#include <memory>
 #include <ostream>
+#include <tuple>
 #include <utility>
 
 #include <fun/option/option_inner.h>
@@ -19,20 +21,22 @@ namespace fun {
 
 template <typename T> class Option;
 
+template <class T, class ...Stages> class LazyOption;
+
 struct NothingTag{};
 
-inline auto nothing() -> NothingTag { return {}; }
+constexpr auto nothing() -> NothingTag { return {}; }
 
-auto some() -> Option<Unit>;
+constexpr auto some() -> Option<Unit>;
 
 template<typename Arg>
-auto some(Arg&& x) -> Option<std::decay_t<Arg>>;
+constexpr auto some(Arg&& x) -> Option<std::decay_t<Arg>>;
 
 template <class T>
-auto some_default() -> Option<T>;
+constexpr auto some_default() -> Option<T>;
 
 template <class T>
-auto some_ref(T& x) -> Option<T&>;
+constexpr auto some_ref(T& x) -> Option<T&>;
 
 template <class T>
 auto some_ref(const T&& x) = delete;
@@ -45,7 +49,7 @@ template <class ...Args>
 struct MakeOptionArgs { std::tuple<Args...> tup; };
 
 template <class ...Args>
-auto make_some(Args&& ...args) -> MakeOptionArgs<Args&&...>
+constexpr auto make_some(Args&& ...args) -> MakeOptionArgs<Args&&...>
 {
   return { std::forward_as_tuple(std::forward<Args>(args)...) };
 }
@@ -69,8 +73,14 @@ auto make_some(Args&& ...args) -> MakeOptionArgs<Args&&...>
 //! by dealing with it monadically and passing a function to the `map` method
 //! to operate on the potentially contained type.
 //!
+//! Moving from an Option moves from its value and leaves it in the same
+//! variant, as with `std::optional`: a moved-from Some is still Some, holding
+//! a moved-from `T`. Where the moved-from `T` is itself the niche that stands
+//! for None (a null `std::unique_ptr` with `EnableNullNiche`, a `Boxed`), the
+//! Option reads as None. Use `take()` to empty it explicitly.
+//!
 template <typename T>
-class Option {
+class FUN_TRIVIAL_ABI Option {
 public:
   using self_t = Option<T>;
   using Inner = T;
@@ -80,9 +90,24 @@ public:
   class Iter;
 
 private:
+  template <class, class> friend struct NicheTraits;
+  template <class> friend class Option;
+
   // Data members
   OptionUnion<T> _inner;
 
+  // Hands the contained value to a consumer without moving it out first, the
+  // Option keeps whatever the consumer leaves behind
+  // ** only call on `Some` variant, otherwise undefined behavior **
+  constexpr auto forward_value() noexcept -> T&& { return static_cast<T&&>(*as_ptr()); }
+
+  // Whether moving the payload, or handing it (or nothing) to an `F` and
+  // keeping what comes back, can throw
+  static constexpr bool nothrow_move = std::is_nothrow_move_constructible_v<T>;
+
+  template <class F, class ...Args>
+  static constexpr bool nothrow_call = is_nothrow_unvoid_callable_v<F, Args...>;
+
 public:
   ~Option() = default;
 
@@ -92,9 +117,9 @@ public:
   Option(const self_t&) = default;
   auto operator=(const self_t&) -> self_t& = default;
 
-  auto clone() const -> self_t { return *this; }
+  constexpr auto clone() const noexcept(std::is_nothrow_copy_constructible_v<T>) -> self_t { return *this; }
 
-  explicit Option(OptionUnion<T> mem) : _inner(std::move(mem)) {}
+  constexpr explicit Option(OptionUnion<T>&& mem) noexcept(nothrow_move) : _inner(std::move(mem)) {}
 
   // Constructors
   //!
@@ -102,50 +127,123 @@ public:
   //!
   Option() = default;
 
-  Option(NothingTag) : Option() {}
+  constexpr Option(NothingTag) noexcept : Option() {}
 
-  explicit Option(T x) : _inner(std::forward<T>(x)) {}
+  //!
+  //! Some value constructed directly in place from `x`, which is therefore
+  //! moved (or copied) exactly once
+  //!
+  template <
+    class U = T,
+    class = std::enable_if_t<
+      std::is_constructible_v<T, U&&> &&
+      !std::is_same_v<std::decay_t<U>, self_t> &&
+      !std::is_same_v<std::decay_t<U>, OptionUnion<T>> &&
+      !std::is_same_v<std::decay_t<U>, NothingTag> &&
+      !std::is_same_v<std::decay_t<U>, ForwardArgs>
+    >
+  >
+  constexpr explicit Option(U&& x) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+    : _inner(ForwardArgs{}, std::forward<U>(x))
+  {}
 
   template <typename ...Args>
-  explicit Option(ForwardArgs, Args&& ... args)
+  constexpr explicit Option(ForwardArgs, Args&& ... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
     : _inner(ForwardArgs{}, std::forward<Args>(args)...)
   {}
 
   template <class ...Args, size_t ...Indices>
-  Option(SomeTag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>)
+  constexpr Option(SomeTag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>)
+    noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
     : Option(ForwardArgs{}, std::forward<Args>(std::get<Indices>(args))...)
   {}
 
   template <class ...Args>
-  Option(MakeOptionArgs<Args...>&& make_args)
+  constexpr Option(MakeOptionArgs<Args...>&& make_args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
     : Option(SomeTag{}, make_args.tup, std::index_sequence_for<Args...>{})
   {}
 
+  template <class ...Args>
+  constexpr Option(SomeTag, std::tuple<Args...>&& args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+    : Option(SomeTag{}, args, std::index_sequence_for<Args...>{})
+  {}
+
+  // Allocator-extended constructors
+  //!
+  //! An Option uses allocators of type `A` if its payload does (see the `std::uses_allocator` specialization), so
+  //! that allocator-aware containers, e.g. a `std::pmr::vector<Option<std::pmr::string>>`, hand theirs down to the
+  //! payload. The payload, if any, is constructed with `alloc` by uses-allocator construction.
+  //!
+  template <class A>
+  constexpr Option(std::allocator_arg_t, const A&) noexcept : Option() {}
+
+  template <class A>
+  constexpr Option(std::allocator_arg_t, const A& alloc, const self_t& other) : Option() {
+    if (other.is_some()) { emplace(std::allocator_arg, alloc, *other.as_ptr()); }
+  }
+
+  template <class A>
+  constexpr Option(std::allocator_arg_t, const A& alloc, self_t&& other) : Option() {
+    if (other.is_some()) { emplace(std::allocator_arg, alloc, other.forward_value()); }
+  }
+
+  template <class A, class ...Args>
+  constexpr Option(std::allocator_arg_t, const A& alloc, ForwardArgs, Args&& ...args)
+    : Option(SomeTag{}, uses_allocator_args<T>(alloc, std::forward<Args>(args)...))
+  {}
+
+  template <
+    class A,
+    class U,
+    class = std::enable_if_t<
+      std::is_constructible_v<T, U&&> &&
+      !std::is_same_v<std::decay_t<U>, self_t> &&
+      !std::is_same_v<std::decay_t<U>, OptionUnion<T>> &&
+      !std::is_same_v<std::decay_t<U>, NothingTag> &&
+      !std::is_same_v<std::decay_t<U>, ForwardArgs>
+    >
+  >
+  constexpr explicit Option(std::allocator_arg_t, const A& alloc, U&& x)
+    : Option(std::allocator_arg, alloc, ForwardArgs{}, std::forward<U>(x))
+  {}
+
+  template <class A, class ...Args, size_t ...Indices>
+  constexpr Option(
+    std::allocator_arg_t, const A& alloc, SomeTag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>
+  )
+    : Option(std::allocator_arg, alloc, ForwardArgs{}, std::forward<Args>(std::get<Indices>(args))...)
+  {}
+
+  template <class A, class ...Args>
+  constexpr Option(std::allocator_arg_t, const A& alloc, MakeOptionArgs<Args...>&& make_args)
+    : Option(std::allocator_arg, alloc, SomeTag{}, make_args.tup, std::index_sequence_for<Args...>{})
+  {}
+
     // variant testing
-  bool is_some() const { return _inner.is_some(); }
-  bool is_none() const { return !is_some(); }
-  explicit operator bool() const { return is_some(); }
+  constexpr bool is_some() const noexcept { return _inner.is_some(); }
+  constexpr bool is_none() const noexcept { return !is_some(); }
+  constexpr explicit operator bool() const noexcept { return is_some(); }
 
-  value_t* as_ptr() { return _inner.as_ptr(); }
-  const value_t* as_ptr() const {
+  constexpr value_t* as_ptr() noexcept { return _inner.as_ptr(); }
+  constexpr const value_t* as_ptr() const noexcept {
     return const_cast<OptionUnion<T>&>(_inner).as_ptr();
   }
-  const value_t* as_const_ptr() const { return as_ptr(); }
+  constexpr const value_t* as_const_ptr() const noexcept { return as_ptr(); }
 
-  auto as_ref() -> Option<value_t&> {
+  constexpr auto as_ref() noexcept -> Option<value_t&> {
     if (is_some()) { return some_ref(*as_ptr()); }
     else           { return {}; }
   }
-  auto as_ref() const -> Option<const value_t&> {
+  constexpr auto as_ref() const noexcept -> Option<const value_t&> {
     if (is_some()) { return some_ref(*as_ptr()); }
     else           { return {}; }
   }
-  auto as_const_ref() const -> Option<const value_t&> { return as_ref(); }
+  constexpr auto as_const_ref() const noexcept -> Option<const value_t&> { return as_ref(); }
 
-  bool operator==(const Option<T>& other) const {
+  constexpr bool operator==(const Option<T>& other) const {
     return _inner == other._inner;
   }
-  bool operator!=(const Option<T>& other) const {
+  constexpr bool operator!=(const Option<T>& other) const {
     return !(*this == other);
   }
 
@@ -157,24 +255,26 @@ public:
   //! dispatches the appropriate function and returns the common type.
   //!
   template <typename SomeFuncT, typename NoneFuncT>
-  auto match(SomeFuncT&&, NoneFuncT&&) && -> MatchReturn<SomeFuncT>;
+  constexpr auto match(SomeFuncT&&, NoneFuncT&&) && noexcept(nothrow_call<SomeFuncT, T> && nothrow_call<NoneFuncT>)
+    -> MatchReturn<SomeFuncT>;
 
   // Iterator creation
-  Iter begin();
-  ConstIter begin() const;
-  ConstIter cbegin() const;
-  Iter end();
-  ConstIter end() const;
-  ConstIter cend() const;
+  constexpr Iter begin();
+  constexpr ConstIter begin() const;
+  constexpr ConstIter cbegin() const;
+  constexpr Iter end();
+  constexpr ConstIter end() const;
+  constexpr ConstIter cend() const;
 
   template<typename E, typename ... Args>
-  auto ok_or(E err) && -> Result<T, E>;
+  constexpr auto ok_or(E err) && noexcept(nothrow_move && std::is_nothrow_move_constructible_v<E>) -> Result<T, E>;
 
   template <class F>
   using ErrorAlternative = InvokeResult_t<F>;
 
   template<typename ErrFuncT>
-  auto ok_or_else(ErrFuncT&& err_func) && -> Result<T, ErrorAlternative<ErrFuncT>>;
+  constexpr auto ok_or_else(ErrFuncT&& err_func) && noexcept(nothrow_move && nothrow_call<ErrFuncT>)
+    -> Result<T, ErrorAlternative<ErrFuncT>>;
 
   template <class F>
   using MappedOption = Option<InvokeResult_t<F, T>>;
@@ -184,16 +284,23 @@ public:
   //! U func(T) or T -> U) to the contained data if there is some.
   //!
   template <typename F /* T -> U */>
-  auto map(F&& func) && -> MappedOption<F>;
+  constexpr auto map(F&& func) && noexcept(nothrow_call<F, T>) -> MappedOption<F>;
+
+  //! `map`, the result of `func` being moved into an Option by uses-allocator construction with `alloc`
+  template <typename A, typename F /* T -> U */>
+  constexpr auto map(std::allocator_arg_t, const A& alloc, F&& func) && -> MappedOption<F>;
 
   template <typename U, typename FuncT>
-  U map_or(U default_val, FuncT&& func) &&;
+  constexpr U map_or(U default_val, FuncT&& func) &&
+    noexcept(nothrow_call<FuncT, T> && std::is_nothrow_move_constructible_v<U>);
 
   template <typename DefaultFunc, typename F>
-  auto map_or_else(DefaultFunc&&, F&&) && -> MappedOption<F>;
+  constexpr auto map_or_else(DefaultFunc&&, F&&) && noexcept(nothrow_call<F, T> && nothrow_call<DefaultFunc>)
+    -> MatchReturn<F>;
 
   template <typename U>
-  auto zip(Option<U>) && -> Option<std::pair<T, U>>;
+  constexpr auto zip(Option<U>) && noexcept(nothrow_move && std::is_nothrow_move_constructible_v<U>)
+    -> Option<std::pair<T, U>>;
 
   template <class F>
   using ValBoundOption = Option<typename InvokeResult_t<F, T>::Inner>;
@@ -204,31 +311,69 @@ public:
   //! returns an Option<U> with the result.
   //!
   template <typename F /* T -> Option<U> */>
-  auto and_then(F&& func) && -> ValBoundOption<F>;
+  constexpr auto and_then(F&& func) && noexcept(nothrow_call<F, T>) -> ValBoundOption<F>;
+
+  //! `and_then`, the Option returned by `func` being moved with `alloc` (see the allocator-extended constructors)
+  template <typename A, typename F /* T -> Option<U> */>
+  constexpr auto and_then(std::allocator_arg_t, const A& alloc, F&& func) && -> ValBoundOption<F>;
 
   template <typename F /* () -> Option<T> */>
-  Option<T> or_else(F&& alt_func) &&;
+  constexpr Option<T> or_else(F&& alt_func) && noexcept(nothrow_move && nothrow_call<F>);
+
+  //!
+  //! Starts a lazy chain of `map`, `and_then` and `filter` calls that is
+  //! fused into a single pass when `eval()` is called (see `LazyOption` in
+  //! fun/lazy.h). The value is moved out of this Option by `eval()`, which
+  //! is to be called within the same full expression.
+  //!
+  constexpr auto lazy() && noexcept -> LazyOption<T>;
+  auto lazy() const& = delete;
 
   template <class F /* const T& -> bool */>
-  auto filter(F&& predicate) && -> Option<T>
+  constexpr auto filter(F&& predicate) && noexcept(nothrow_move && std::is_nothrow_invocable_v<F, const T&>)
+    -> Option<T>
   {
     return std::move(*this).and_then(
       [&](T&& obj) -> Option<T> {
-        const auto satisfied = std::invoke(std::forward<F>(predicate), std::as_const(obj));
+        const auto satisfied = fun::invoke(std::forward<F>(predicate), std::as_const(obj));
         if (satisfied) { return Option<T>(ForwardArgs{}, std::forward<T>(obj)); }
         else           { return {}; }
       }
     );
   }
 
-  Option<T> take();
+  constexpr Option<T> take() noexcept(nothrow_move);
 
-  auto push(T obj) -> self_t&;
+  constexpr auto push(T obj) noexcept(nothrow_move) -> self_t&;
 
   template <typename ...Args>
-  auto emplace(Args&& ...args) -> self_t&;
+  constexpr auto emplace(Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) -> self_t&;
+
+  //! `emplace`, the value being constructed from `args` with `alloc` by uses-allocator construction
+  template <typename A, typename ...Args>
+  constexpr auto emplace(std::allocator_arg_t, const A& alloc, Args&& ...args) -> self_t&;
+
+  //!
+  //! Replaces the value with `value`, returning the previous contents. An
+  //! existing value is assigned over rather than destroyed and rebuilt.
+  //!
+  constexpr auto replace(T value) noexcept(nothrow_move && (std::is_reference_v<T> || std::is_nothrow_move_assignable_v<T>))
+    -> self_t;
+
+  //!
+  //! Returns the contained value, first storing the result of `func` if there
+  //! is none
+  //!
+  template <class F /* () -> T */>
+  constexpr auto get_or_insert_with(F&& func) noexcept(nothrow_call<F>) -> value_t&;
+
+  //!
+  //! Exchanges the contents with `other`. Values on both sides are swapped
+  //! directly, otherwise the Options are exchanged by moves.
+  //!
+  constexpr void swap(self_t& other) noexcept(nothrow_move && std::is_nothrow_swappable_v<T>);
 
-  auto cloned() const -> Option<value_t>;
+  constexpr auto cloned() const noexcept(std::is_nothrow_copy_constructible_v<value_t>) -> Option<value_t>;
 
   //!
   //! Returns the "Some" value
@@ -241,20 +386,31 @@ public:
   //!       behavior of methods other than the destructor and assignment
   //!       operators is unspecified.
   //!
-  T unwrap() &&;
+  constexpr T unwrap() && noexcept(nothrow_move);
 
-  T expect(const char* err_msg) &&;
+  //!
+  //! Returns the "Some" value of an Option the caller knows to be "Some", e.g.
+  //! from having checked `is_some`, without checking it again
+  //!
+  //! @note Calling this function on a "None" Option is undefined behavior,
+  //!       unless `FUN_CHECK_ASSUMPTIONS` is set, in which case it aborts
+  //!
+  constexpr T unwrap_unchecked() && noexcept(nothrow_move);
+
+  constexpr T expect(const char* err_msg) &&;
 
-  // Non-reference overload
-  template <class X = void> // Dummy template argument for SFINAE
-  auto unwrap_or(T alt) && -> /* T */ std::enable_if_t<!std::is_reference_v<T>, first_t<T, X>> {
+  // Non-reference overload, `alt` is only converted to `T` if it is needed
+  template <class U = T>
+  constexpr auto unwrap_or(U&& alt) && noexcept(nothrow_move && std::is_nothrow_constructible_v<T, U&&>) -> /* T */
+    std::enable_if_t<!std::is_reference_v<T> && std::is_constructible_v<T, U&&>, first_t<T, U>>
+  {
     if (is_some()) { return std::move(*this).unwrap(); }
-    else           { return std::move(alt); }
+    else           { return static_cast<T>(std::forward<U>(alt)); }
   }
 
   // Reference overload
   template <class Arg>
-  auto unwrap_or(Arg&& alt) && -> /* T */ std::enable_if_t<std::is_reference_v<T>, first_t<T, Arg>> {
+  constexpr auto unwrap_or(Arg&& alt) && noexcept -> /* T */ std::enable_if_t<std::is_reference_v<T>, first_t<T, Arg>> {
     static_assert(
       !std::is_reference_v<T> || is_safe_reference_convertible_v<Arg, T>,
       "Option<T&>::unwrap_or requires an argument of a compatible reference type"
@@ -265,10 +421,10 @@ public:
   }
 
   template <class F>
-  T unwrap_or_else(F&& alt_func) &&;
+  constexpr T unwrap_or_else(F&& alt_func) && noexcept(nothrow_move && nothrow_call<F>);
 
   template <class X = void> // Dummy template parameter to defer static_assert
-  auto unwrap_or_default() && -> T {
+  constexpr auto unwrap_or_default() && noexcept(nothrow_move && std::is_nothrow_default_constructible_v<T>) -> T {
     static_assert(
       !std::is_reference_v<first_t<T, X>>,
       "Option::unwrap_or_default is disallowed for references"
@@ -284,14 +440,14 @@ public:
     const value_t* _ptr = nullptr;
   public:
     ConstIter() = default;
-    explicit ConstIter(const value_t* ptr);
+    constexpr explicit ConstIter(const value_t* ptr);
 
     // overload *, ->, and ++_
-    const value_t& operator*() const;
-    const value_t* operator->() const;
-    ConstIter& operator++();
-    bool operator==(const ConstIter& other) const;
-    bool operator!=(const ConstIter& other) const;
+    constexpr const value_t& operator*() const;
+    constexpr const value_t* operator->() const;
+    constexpr ConstIter& operator++();
+    constexpr bool operator==(const ConstIter& other) const;
+    constexpr bool operator!=(const ConstIter& other) const;
   };
 
   class Iter {
@@ -299,18 +455,36 @@ public:
     value_t* _ptr = nullptr;
   public:
     Iter() = default;
-    explicit Iter(value_t* ptr);
+    constexpr explicit Iter(value_t* ptr);
 
     // overload *, ->, and ++_
-    value_t& operator*() const;
-    value_t* operator->() const;
-    Iter& operator++();
-    bool operator==(const Iter& other) const;
-    bool operator!=(const Iter& other) const;
+    constexpr value_t& operator*() const;
+    constexpr value_t* operator->() const;
+    constexpr Iter& operator++();
+    constexpr bool operator==(const Iter& other) const;
+    constexpr bool operator!=(const Iter& other) const;
   };
 };
 
+//------------------------------------------------------------------------------
+/**
+ * Options lend the unused states of their storage to enclosing Options and Results, so that e.g.
+ * `Option<Option<std::uint32_t>>` is no larger than `Option<std::uint32_t>`.
+ */
+template <class T>
+struct NicheTraits<Option<T>> {
+  static constexpr std::size_t count = OptionUnion<T>::niche_count;
+  static constexpr bool reserved = true;
+
+  static constexpr Option<T> make(const std::size_t i) { return Option<T>(OptionUnion<T>(NicheTag{}, i)); }
+
+  static constexpr bool is(const Option<T>& x, const std::size_t i) { return x._inner.is_niche(i); }
+};
+
 }
 
+template <class T, class A>
+struct std::uses_allocator<fun::Option<T>, A> : std::uses_allocator<std::remove_cv_t<T>, A> {};
+
 template <class T>
 std::ostream& operator<<(std::ostream& os, const fun::Option<T>& op);
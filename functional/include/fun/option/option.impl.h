@@ -11,24 +11,31 @@
 
 namespace fun {
 
+namespace option_detail {
+
+// Out of line, so that callers of `expect` only carry a call to it
+[[noreturn]] FUN_COLD inline void throw_expect_failure(const char* const err_msg) { throw std::runtime_error(err_msg); }
+
+} // end namespace option_detail
+
 //==============================================================================
 // Option-related function definitions
 //------------------------------------------------------------------------------
-inline auto some() -> Option<Unit> { return some(Unit{}); }
+constexpr auto some() -> Option<Unit> { return some(Unit{}); }
 
 //------------------------------------------------------------------------------
 template<typename Arg>
-auto some(Arg&& x) -> Option<std::decay_t<Arg>> {
+constexpr auto some(Arg&& x) -> Option<std::decay_t<Arg>> {
   return Option<std::decay_t<Arg>>(ForwardArgs{}, std::forward<Arg>(x));
 }
 
 //------------------------------------------------------------------------------
 template <class T>
-auto some_default() -> Option<T> { return Option<T>(ForwardArgs{}); }
+constexpr auto some_default() -> Option<T> { return Option<T>(ForwardArgs{}); }
 
 //------------------------------------------------------------------------------
 template <class T>
-auto some_ref(T& x) -> Option<T&> { return Option<T&>(OptionUnion<T&>(x)); }
+constexpr auto some_ref(T& x) -> Option<T&> { return Option<T&>(OptionUnion<T&>(x)); }
 
 //==============================================================================
 // Option definitions
@@ -39,58 +46,61 @@ auto some_ref(T& x) -> Option<T&> { return Option<T&>(OptionUnion<T&>(x)); }
 //!
 template<typename T>
 template <typename SomeFuncT, typename NoneFuncT>
-auto Option<T>::
-match(SomeFuncT&& func_some, NoneFuncT&& func_none) && -> MatchReturn<SomeFuncT>
+constexpr auto Option<T>::
+match(SomeFuncT&& func_some, NoneFuncT&& func_none) && noexcept(nothrow_call<SomeFuncT, T> && nothrow_call<NoneFuncT>)
+  -> MatchReturn<SomeFuncT>
 {
   static_assert(
     std::is_same_v<std::invoke_result_t<SomeFuncT, T>, std::invoke_result_t<NoneFuncT>>
     , "Some-handling and None-handling functions passed to match do not "
       "have the same return type"
     );
-  if (is_some()) { return unvoid_call(std::forward<SomeFuncT>(func_some), std::move(*this).unwrap()); }
-  else           { return unvoid_call(std::forward<NoneFuncT>(func_none)); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return unvoid_call(std::forward<SomeFuncT>(func_some), forward_value()); }
+  else                               { return unvoid_call(std::forward<NoneFuncT>(func_none)); }
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::begin() -> Iter { return Iter(as_ptr()); }
+constexpr auto Option<T>::begin() -> Iter { return Iter(as_ptr()); }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::begin() const -> ConstIter { return ConstIter(as_ptr()); }
+constexpr auto Option<T>::begin() const -> ConstIter { return ConstIter(as_ptr()); }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::cbegin() const -> ConstIter { return begin(); }
+constexpr auto Option<T>::cbegin() const -> ConstIter { return begin(); }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::end() -> Iter { return Iter(); }
+constexpr auto Option<T>::end() -> Iter { return Iter(); }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::end() const -> ConstIter { return ConstIter(); }
+constexpr auto Option<T>::end() const -> ConstIter { return ConstIter(); }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::cend() const -> ConstIter { return ConstIter(); }
+constexpr auto Option<T>::cend() const -> ConstIter { return ConstIter(); }
 
 //------------------------------------------------------------------------------
 template <typename T>
 template <typename E, typename ... Args>
-auto Option<T>::ok_or(E err) && -> Result<T, E>
+constexpr auto Option<T>::ok_or(E err) && noexcept(nothrow_move && std::is_nothrow_move_constructible_v<E>)
+  -> Result<T, E>
 {
-  if (is_some()) { return fun::make_ok(std::move(*this).unwrap()); }
-  else           { return fun::make_err(std::forward<E>(err)); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return fun::make_ok(forward_value()); }
+  else                               { return fun::make_err(std::forward<E>(err)); }
 }
 
 //------------------------------------------------------------------------------
 template <typename T>
 template<typename ErrFuncT>
-auto Option<T>::ok_or_else(ErrFuncT&& err_func) && -> Result<T, ErrorAlternative<ErrFuncT>>
+constexpr auto Option<T>::ok_or_else(ErrFuncT&& err_func) && noexcept(nothrow_move && nothrow_call<ErrFuncT>)
+  -> Result<T, ErrorAlternative<ErrFuncT>>
 {
-  if (is_some()) { return fun::make_ok(std::move(*this).unwrap()); }
-  else           { return fun::make_err(unvoid_call(std::forward<ErrFuncT>(err_func))); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return fun::make_ok(forward_value()); }
+  else                               { return fun::make_err(unvoid_call(std::forward<ErrFuncT>(err_func))); }
 }
 
 //------------------------------------------------------------------------------
@@ -100,39 +110,55 @@ auto Option<T>::ok_or_else(ErrFuncT&& err_func) && -> Result<T, ErrorAlternative
 //!
 template<typename T>
 template <typename F /* T -> U */>
-auto Option<T>::map(F&& func) && -> MappedOption<F>
+constexpr auto Option<T>::map(F&& func) && noexcept(nothrow_call<F, T>) -> MappedOption<F>
 {
-  if (is_some()) { return fun::make_some(unvoid_call(std::forward<F>(func), std::move(*this).unwrap())); }
+  if (is_some()) { return fun::make_some(unvoid_call(std::forward<F>(func), forward_value())); }
   else { return {}; }
 }
 
+//------------------------------------------------------------------------------
+template<typename T>
+template <typename A, typename F /* T -> U */>
+constexpr auto Option<T>::map(std::allocator_arg_t, const A& alloc, F&& func) && -> MappedOption<F>
+{
+  if (is_some()) {
+    auto&& value = unvoid_call(std::forward<F>(func), forward_value());
+    return MappedOption<F>(std::allocator_arg, alloc, ForwardArgs{}, std::forward<decltype(value)>(value));
+  } else {
+    return {};
+  }
+}
+
 //------------------------------------------------------------------------------
 template<typename T>
 template <typename U, typename FuncT>
-U Option<T>::map_or(U default_val, FuncT&& func) &&
+constexpr U Option<T>::map_or(U default_val, FuncT&& func) &&
+  noexcept(nothrow_call<FuncT, T> && std::is_nothrow_move_constructible_v<U>)
 {
-  if (is_some()) { return unvoid_call(std::forward<FuncT>(func), std::move(*this).unwrap()); }
-  else           { return std::forward<U>(default_val); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return unvoid_call(std::forward<FuncT>(func), forward_value()); }
+  else                               { return std::forward<U>(default_val); }
 }
 
 //------------------------------------------------------------------------------
 template <typename T>
 template <typename DefaultFunc, typename F>
-auto Option<T>::
-map_or_else(DefaultFunc&& default_func, F&& func) && -> MappedOption<F>
+constexpr auto Option<T>::
+map_or_else(DefaultFunc&& default_func, F&& func) && noexcept(nothrow_call<F, T> && nothrow_call<DefaultFunc>)
+  -> MatchReturn<F>
 {
-  if (is_some()) { return unvoid_call(std::forward<F>(func), std::move(*this).unwrap()); }
-  else           { return unvoid_call(std::forward<DefaultFunc>(default_func)); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return unvoid_call(std::forward<F>(func), forward_value()); }
+  else                               { return unvoid_call(std::forward<DefaultFunc>(default_func)); }
 }
 
 //------------------------------------------------------------------------------
 template <typename T>
 template <typename U>
-auto Option<T>::
-zip(Option<U> other) && -> Option<std::pair<T, U>>
+constexpr auto Option<T>::
+zip(Option<U> other) && noexcept(nothrow_move && std::is_nothrow_move_constructible_v<U>)
+  -> Option<std::pair<T, U>>
 {
   if (this->is_some() && other.is_some()) {
-    return fun::make_some(std::move(*this).unwrap(), std::move(other).unwrap());
+    return fun::make_some(forward_value(), other.forward_value());
   } else {
     return {};
   }
@@ -146,24 +172,36 @@ zip(Option<U> other) && -> Option<std::pair<T, U>>
 //!
 template<typename T>
 template <typename F /* T -> Option<U> */>
-auto Option<T>::and_then(F&& func) && -> ValBoundOption<F>
+constexpr auto Option<T>::and_then(F&& func) && noexcept(nothrow_call<F, T>) -> ValBoundOption<F>
 {
-  if (is_some()) { return unvoid_call(std::forward<F>(func), std::move(*this).unwrap()); }
+  if (is_some()) { return unvoid_call(std::forward<F>(func), forward_value()); }
   else           { return {}; }
 }
 
+//------------------------------------------------------------------------------
+template<typename T>
+template <typename A, typename F /* T -> Option<U> */>
+constexpr auto Option<T>::and_then(std::allocator_arg_t, const A& alloc, F&& func) && -> ValBoundOption<F>
+{
+  if (is_some()) {
+    return ValBoundOption<F>(std::allocator_arg, alloc, unvoid_call(std::forward<F>(func), forward_value()));
+  } else {
+    return {};
+  }
+}
+
 //------------------------------------------------------------------------------
 template<typename T>
 template <typename F /* () -> Option<T> */>
-Option<T> Option<T>::or_else(F&& alt_func) &&
+constexpr Option<T> Option<T>::or_else(F&& alt_func) && noexcept(nothrow_move && nothrow_call<F>)
 {
-  if (is_some()) { return fun::make_some(std::move(*this).unwrap()); }
+  if (is_some()) { return fun::make_some(forward_value()); }
   else           { return unvoid_call(std::forward<F>(alt_func)); }
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-Option<T> Option<T>::take()
+constexpr Option<T> Option<T>::take() noexcept(nothrow_move)
 {
   if (is_some()) { return Option<T>(ForwardArgs(), _inner.dump()); }
   else           { return Option<T>(); }
@@ -171,109 +209,176 @@ Option<T> Option<T>::take()
 
 //------------------------------------------------------------------------------
 template<typename T>
-Option<T>& Option<T>::push(T obj) { return emplace(std::forward<T>(obj)); }
+constexpr Option<T>& Option<T>::push(T obj) noexcept(nothrow_move) { return emplace(std::forward<T>(obj)); }
 
 //------------------------------------------------------------------------------
 template <typename T>
 template <typename ...Args>
-auto Option<T>::emplace(Args&& ...args) -> self_t&
+constexpr auto Option<T>::emplace(Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) -> self_t&
 {
   _inner.emplace(std::forward<Args>(args)...);
   return *this;
 }
 
+//------------------------------------------------------------------------------
+template <typename T>
+template <typename A, typename ...Args>
+constexpr auto Option<T>::emplace(std::allocator_arg_t, const A& alloc, Args&& ...args) -> self_t&
+{
+  std::apply(
+    [this](auto&& ...xs) { _inner.emplace(std::forward<decltype(xs)>(xs)...); },
+    uses_allocator_args<T>(alloc, std::forward<Args>(args)...)
+  );
+  return *this;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+constexpr auto Option<T>::replace(T value)
+  noexcept(nothrow_move && (std::is_reference_v<T> || std::is_nothrow_move_assignable_v<T>)) -> self_t
+{
+  auto old = self_t();
+  if (is_some()) {
+    old._inner.emplace(forward_value());
+    if constexpr (!std::is_reference_v<T> && std::is_move_assignable_v<T>) {
+      *as_ptr() = std::move(value);
+      return old;
+    }
+  }
+  _inner.emplace(std::forward<T>(value));
+  return old;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+template <class F /* () -> T */>
+constexpr auto Option<T>::get_or_insert_with(F&& func) noexcept(nothrow_call<F>) -> value_t&
+{
+  if (is_none()) { _inner.emplace(unvoid_call(std::forward<F>(func))); }
+  return *as_ptr();
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+constexpr void Option<T>::swap(self_t& other) noexcept(nothrow_move && std::is_nothrow_swappable_v<T>)
+{
+  // Swapping reference payloads would swap their referents
+  if constexpr (!std::is_reference_v<T> && std::is_swappable_v<T>) {
+    if (is_some() && other.is_some()) {
+      using std::swap;
+      swap(*as_ptr(), *other.as_ptr());
+      return;
+    }
+  }
+  auto tmp = std::move(other);
+  other = std::move(*this);
+  *this = std::move(tmp);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+constexpr void swap(Option<T>& a, Option<T>& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+//------------------------------------------------------------------------------
 template <class T>
-auto Option<T>::cloned() const -> Option<value_t>
+constexpr auto Option<T>::cloned() const noexcept(std::is_nothrow_copy_constructible_v<value_t>) -> Option<value_t>
 {
-  if (is_some()) { return Option<value_t>(clone().unwrap()); }
+  if (is_some()) { return Option<value_t>(ForwardArgs{}, *as_ptr()); }
   else           { return {}; }
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-T Option<T>::unwrap() && { return _inner.dump(); }
+constexpr T Option<T>::unwrap() && noexcept(nothrow_move) { return _inner.dump(); }
+
+//------------------------------------------------------------------------------
+template<typename T>
+constexpr T Option<T>::unwrap_unchecked() && noexcept(nothrow_move) {
+  FUN_ASSUME(is_some(), "Option::unwrap_unchecked called on a None Option");
+  return _inner.dump();
+}
 
 //------------------------------------------------------------------------------
 template<typename T>
-T Option<T>::expect(const char* err_msg) &&
+constexpr T Option<T>::expect(const char* err_msg) &&
 {
-  if (is_some()) { return std::move(*this).unwrap(); }
-  else           { throw std::runtime_error(err_msg); }
+  if (FUN_SUCCESS_BRANCH(is_some())) { return std::move(*this).unwrap(); }
+  else                               { option_detail::throw_expect_failure(err_msg); }
 }
 
 //------------------------------------------------------------------------------
 template <class T>
 template <class F>
-T Option<T>::unwrap_or_else(F&& alt_func) &&
+constexpr T Option<T>::unwrap_or_else(F&& alt_func) && noexcept(nothrow_move && nothrow_call<F>)
 {
   static_assert(
     !std::is_reference_v<T> || is_safe_reference_convertible_v<InvokeResult_t<F>, T>,
     "The callback passed to Option<T&>::unwrap_or_else must return a compatible reference"
   );
 
-  if (is_some()) { return std::move(*this).unwrap(); }
-  else           { return unvoid_call(std::forward<F>(alt_func)); };
+  if (FUN_SUCCESS_BRANCH(is_some())) { return std::move(*this).unwrap(); }
+  else                               { return unvoid_call(std::forward<F>(alt_func)); };
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-Option<T>::ConstIter::ConstIter(const value_t* ptr) : _ptr(ptr) {}
+constexpr Option<T>::ConstIter::ConstIter(const value_t* ptr) : _ptr(ptr) {}
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::ConstIter::operator*() const -> const value_t& { return *_ptr; }
+constexpr auto Option<T>::ConstIter::operator*() const -> const value_t& { return *_ptr; }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::ConstIter::operator->() const -> const value_t* { return _ptr; }
+constexpr auto Option<T>::ConstIter::operator->() const -> const value_t* { return _ptr; }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::ConstIter::operator++() -> ConstIter& {
+constexpr auto Option<T>::ConstIter::operator++() -> ConstIter& {
   if (_ptr != nullptr) { _ptr = nullptr; }
   return *this;
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-bool Option<T>::ConstIter::operator==(const ConstIter& other) const {
+constexpr bool Option<T>::ConstIter::operator==(const ConstIter& other) const {
   return _ptr == other._ptr;
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-bool Option<T>::ConstIter::operator!=(const ConstIter& other) const {
+constexpr bool Option<T>::ConstIter::operator!=(const ConstIter& other) const {
   return !(*this == other);
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-Option<T>::Iter::Iter(value_t* ptr) : _ptr(ptr) {}
+constexpr Option<T>::Iter::Iter(value_t* ptr) : _ptr(ptr) {}
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::Iter::operator*() const -> value_t& { return *_ptr; }
+constexpr auto Option<T>::Iter::operator*() const -> value_t& { return *_ptr; }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::Iter::operator->() const -> value_t* { return _ptr; }
+constexpr auto Option<T>::Iter::operator->() const -> value_t* { return _ptr; }
 
 //------------------------------------------------------------------------------
 template<typename T>
-auto Option<T>::Iter::operator++() -> Iter& {
+constexpr auto Option<T>::Iter::operator++() -> Iter& {
   if (_ptr != nullptr) { _ptr = nullptr; }
   return *this;
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-bool Option<T>::Iter::operator==(const Iter& other) const {
+constexpr bool Option<T>::Iter::operator==(const Iter& other) const {
   return _ptr == other._ptr;
 }
 
 //------------------------------------------------------------------------------
 template<typename T>
-bool Option<T>::Iter::operator!=(const Iter& other) const {
+constexpr bool Option<T>::Iter::operator!=(const Iter& other) const {
   return !(*this == other);
 }
 
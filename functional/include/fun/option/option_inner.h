@@ -1,5 +1,6 @@
 #pragma once
 
+#include <fun/niche.h>
 #include <fun/type_support.h>
 
 namespace fun {
@@ -9,49 +10,46 @@ template <class T, class En = void> class OptionUnion;
 
 //------------------------------------------------------------------------------
 template <class T>
-class OptionUnion<T, std::enable_if_t<std::is_empty_v<T>>>: T {
+class FUN_TRIVIAL_ABI OptionUnion<T, std::enable_if_t<std::is_empty_v<T>>>: T {
   using Self = OptionUnion;
 
-  enum class Tag: std::uint8_t { NONE, SOME };
+  enum class Tag: std::uint8_t { NONE, SOME, NICHE };
   Tag _variant;
 public:
+  // Tag values from NICHE on are lent out to enclosing Options and Results
+  static constexpr std::size_t niche_count = 254;
+
   ~OptionUnion() = default;
 
   OptionUnion(const Self&) = default;
-
-  OptionUnion(Self&& other) noexcept
-    : T(static_cast<T&&>(other))
-    , _variant(other._variant)
-  { other._variant = Tag::NONE; }
-
+  OptionUnion(Self&&) = default;
   Self& operator=(const Self&) = default;
+  Self& operator=(Self&&) = default;
 
-  Self& operator=(Self&& other) noexcept {
-    if (this != &other) {
-      _variant = other._variant;
-      if (_variant == Tag::SOME) { T::operator=(static_cast<T&&>(other)); }
-      other._variant = Tag::NONE;
-    }
-    return *this;
-  }
+  constexpr Self clone() const { return *this; }
 
-  Self clone() const { return *this; }
+  constexpr OptionUnion() noexcept(std::is_nothrow_default_constructible_v<T>) : T(), _variant(Tag::NONE) {}
 
-  OptionUnion() : T(), _variant(Tag::NONE) {}
+  constexpr OptionUnion(NicheTag, const std::size_t i)
+    : T()
+    , _variant(static_cast<Tag>(static_cast<std::size_t>(Tag::NICHE) + i))
+  {}
 
-  explicit OptionUnion(T val) : T(std::move(val)), _variant(Tag::SOME) {}
+  constexpr bool is_niche(const std::size_t i) const {
+    return _variant == static_cast<Tag>(static_cast<std::size_t>(Tag::NICHE) + i);
+  }
 
   template <typename ...Args>
-  explicit OptionUnion(ForwardArgs, Args&& ...args)
+  constexpr explicit OptionUnion(ForwardArgs, Args&& ...args)
     : T(std::forward<Args>(args)...)
     , _variant(Tag::SOME)
   {}
 
-  bool is_some() const { return _variant == Tag::SOME; }
+  constexpr bool is_some() const { return _variant == Tag::SOME; }
 
-  T* as_ptr() { return is_some() ? static_cast<T*>(this) : nullptr; }
+  constexpr T* as_ptr() { return is_some() ? static_cast<T*>(this) : nullptr; }
 
-  bool operator==(const Self& other) const {
+  constexpr bool operator==(const Self& other) const {
     if (_variant != other._variant) { return false; }
     if (is_some()) {
       return static_cast<T const&>(*this) == static_cast<T const&>(other);
@@ -59,13 +57,13 @@ public:
     return true;
   }
 
-  T dump() {
+  constexpr T dump() {
     _variant = Tag::NONE;
     return static_cast<T&&>(*this);
   }
 
   template <class... Args>
-  void emplace(Args&&... args) {
+  constexpr void emplace(Args&&... args) {
     // Constructing a temporary and throwing it away mostly replicates the
     // observable compile-time behavior of a normal emplace().
     void(T(std::forward<Args>(args)...));
@@ -75,138 +73,235 @@ public:
 
 //------------------------------------------------------------------------------
 template <class T>
-class OptionUnion<T&> {
+class FUN_TRIVIAL_ABI OptionUnion<T&> {
   using Self = OptionUnion<T&>;
 
   T* _ptr = nullptr;
 public:
+  static constexpr std::size_t niche_count = 0;
+
   ~OptionUnion() = default;
 
   OptionUnion(const Self&) = default;
-  Self& operator=(const Self&)  = default;
-
-  Self clone() const { return *this; }
+  OptionUnion(Self&&) = default;
+  Self& operator=(const Self&) = default;
+  Self& operator=(Self&&) = default;
 
-  OptionUnion(Self&& other) noexcept: _ptr(other._ptr) {
-    other._ptr = nullptr;
-  }
-
-  Self& operator=(Self&& other) noexcept {
-    if (this != &other) {
-      _ptr = other._ptr;
-      other._ptr = nullptr;
-    }
-    return *this;
-  }
+  constexpr Self clone() const { return *this; }
 
   OptionUnion() = default;
 
-  explicit OptionUnion(T& obj) : _ptr(std::addressof(obj)) {}
+  constexpr explicit OptionUnion(T& obj) : _ptr(std::addressof(obj)) {}
 
-  OptionUnion(ForwardArgs, T& obj) : _ptr(std::addressof(obj)) {}
+  constexpr OptionUnion(ForwardArgs, T& obj) : _ptr(std::addressof(obj)) {}
 
-  bool is_some() const { return _ptr ? true : false; }
+  constexpr bool is_some() const { return _ptr ? true : false; }
 
-  T* as_ptr() { return _ptr; }
+  constexpr T* as_ptr() { return _ptr; }
 
-  bool operator==(const Self& other) const { return _ptr == other._ptr; }
+  constexpr bool operator==(const Self& other) const { return _ptr == other._ptr; }
 
-  T& dump() {
+  constexpr T& dump() {
     const auto ptr = _ptr;
     _ptr = nullptr;
     return *ptr;
   }
 
-  void emplace(T& ref) { _ptr = std::addressof(ref); }
+  constexpr void emplace(T& ref) { _ptr = std::addressof(ref); }
 };
 
 //------------------------------------------------------------------------------
-template <class T, class En>
-class OptionUnion {
+// Tagless storage for types with a niche (see `NicheTraits`), "None" is
+// represented by the first niche value of `T`.
+template <class T>
+class FUN_TRIVIAL_ABI OptionUnion<T, std::enable_if_t<!std::is_empty_v<T> && has_niche_v<T>>> {
   using Self = OptionUnion;
+  using Niche = NicheTraits<T>;
 
-  enum class Tag: std::uint8_t { NONE, SOME };
-  Tag _variant;
+  T _val;
+public:
+  // The remaining niches of `T` are passed on to enclosing Options and Results
+  static constexpr std::size_t niche_count = Niche::count - 1;
+
+  ~OptionUnion() = default;
+
+  OptionUnion(const Self&) = default;
+  OptionUnion(Self&&) = default;
+  Self& operator=(const Self&) = default;
+  Self& operator=(Self&&) = default;
 
-  union {
-    Unit _empty = {};
-    T _val;
-  };
+  constexpr Self clone() const { return *this; }
 
-  void erase() {
+  constexpr OptionUnion() noexcept : _val(Niche::make(0)) {}
+
+  constexpr OptionUnion(NicheTag, const std::size_t i) : _val(Niche::make(i + 1)) {}
+
+  constexpr bool is_niche(const std::size_t i) const { return Niche::is(_val, i + 1); }
+
+  template <typename ...Args>
+  constexpr explicit OptionUnion(ForwardArgs, Args&& ...args)
+    : _val(std::forward<Args>(args)...)
+  {}
+
+  constexpr bool is_some() const { return !Niche::is(_val, 0); }
+
+  constexpr T* as_ptr() { return is_some() ? std::addressof(_val) : nullptr; }
+
+  constexpr bool operator==(const Self& other) const {
     if (is_some()) {
-      _variant = Tag::NONE;
-      _val.~T();
-      _empty = {};
+      return other.is_some() ? (_val == other._val) : false;
+    } else {
+      return !other.is_some();
     }
   }
-public:
-  ~OptionUnion() { erase(); }
 
-  OptionUnion(const Self& other) : _variant(other._variant) {
-    if (_variant == Tag::SOME) {
-      construct_at(std::addressof(_val), other._val);
+  constexpr T dump() {
+    auto val = std::move(_val);
+    _val = Niche::make(0);
+    return val;
+  }
+
+  // Replaces the value, or the niche standing for None, in place. A value
+  // whose construction may throw is built aside first, so that a throw leaves
+  // the Option untouched. Trivial values are simply assigned, which is the
+  // same and stays usable in constant expressions before C++20.
+  template <typename ...Args>
+  constexpr void emplace(Args&& ...args) {
+    if constexpr (std::is_trivially_move_assignable_v<T> && std::is_trivially_destructible_v<T>) {
+      _val = T(std::forward<Args>(args)...);
+    } else if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+      fun::destroy_at(std::addressof(_val));
+      fun::construct_at(std::addressof(_val), std::forward<Args>(args)...);
+    } else {
+      auto tmp = T(std::forward<Args>(args)...);
+      fun::destroy_at(std::addressof(_val));
+      fun::construct_at(std::addressof(_val), std::move(tmp));
     }
   }
+};
 
-  Self& operator=(const Self& other) {
-    if (this != &other) {
-      erase();
-      if (other._variant == Tag::SOME) {
-        construct_at(std::addressof(_val), other._val);
-        _variant = Tag::SOME;
-      }
+//------------------------------------------------------------------------------
+template <class T, bool = std::is_trivially_destructible_v<T>>
+union FUN_TRIVIAL_ABI OptionCell {
+  Unit _empty;
+  T _val;
+
+  constexpr OptionCell() : _empty() {}
+
+  template <typename ...Args>
+  constexpr explicit OptionCell(ForwardArgs, Args&& ...args) : _val(std::forward<Args>(args)...) {}
+};
+
+template <class T>
+union FUN_TRIVIAL_ABI OptionCell<T, false> {
+  Unit _empty;
+  T _val;
+
+  constexpr OptionCell() : _empty() {}
+
+  template <typename ...Args>
+  constexpr explicit OptionCell(ForwardArgs, Args&& ...args) : _val(std::forward<Args>(args)...) {}
+
+  FUN_CONSTEXPR_DTOR ~OptionCell() {}
+};
+
+//------------------------------------------------------------------------------
+// Tagged storage for the generic OptionUnion, its special members are supplied
+// by `SpecialMembers` so that they are trivial whenever those of `T` are.
+template <class T>
+class FUN_TRIVIAL_ABI OptionStorage {
+  using Self = OptionStorage;
+
+  enum class Tag: std::uint8_t { NONE, SOME, NICHE };
+  Tag _variant;
+  OptionCell<T> _cell;
+
+protected:
+  constexpr void erase() {
+    if (is_some()) {
+      _variant = Tag::NONE;
+      fun::destroy_at(std::addressof(_cell._val));
     }
-    return *this;
   }
 
-  Self clone() const { return *this; }
+  constexpr void construct_from(const Self& other) {
+    if (other.is_some()) {
+      fun::construct_at(std::addressof(_cell._val), other._cell._val);
+    }
+    _variant = other._variant;
+  }
 
-  OptionUnion(Self&& other) noexcept: _variant(other._variant) {
-    if (_variant == Tag::SOME) {
-      construct_at(std::addressof(_val), other.dump());
+  // Leaves `other` as it was, holding a moved-from value if it was Some, like
+  // the defaulted moves of trivial payloads do
+  constexpr void construct_from(Self&& other) {
+    if (other.is_some()) {
+      fun::construct_at(std::addressof(_cell._val), std::move(other._cell._val));
     }
+    _variant = other._variant;
   }
 
-  Self& operator=(Self&& other) noexcept {
-    if (this != &other) {
-      erase();
-      if (other._variant == Tag::SOME) {
-        construct_at(std::addressof(_val), other.dump());
-        _variant = Tag::SOME;
+  constexpr void assign_from(const Self& other) {
+    if constexpr (std::is_copy_assignable_v<T>) {
+      if (is_some() && other.is_some()) {
+        _cell._val = other._cell._val;
+        return;
       }
     }
-    return *this;
+    erase();
+    construct_from(other);
   }
 
-  OptionUnion() : _variant(Tag::NONE) {}
+  constexpr void assign_from(Self&& other) {
+    if constexpr (std::is_move_assignable_v<T>) {
+      if (is_some() && other.is_some()) {
+        _cell._val = std::move(other._cell._val);
+        return;
+      }
+    }
+    erase();
+    construct_from(std::move(other));
+  }
+
+public:
+  // Tag values from NICHE on are lent out to enclosing Options and Results
+  static constexpr std::size_t niche_count = 254;
+
+  // The tag is the first byte of the storage, vectorized kernels over arrays
+  // of Options (see fun/kernels.h) test it against this value
+  static constexpr std::uint8_t some_tag = static_cast<std::uint8_t>(Tag::SOME);
+
+  constexpr OptionStorage() noexcept : _variant(Tag::NONE) {}
 
-  explicit OptionUnion(T val) : _variant(Tag::SOME) {
-    construct_at(std::addressof(_val), std::move(val));
+  constexpr OptionStorage(NicheTag, const std::size_t i)
+    : _variant(static_cast<Tag>(static_cast<std::size_t>(Tag::NICHE) + i))
+  {}
+
+  constexpr bool is_niche(const std::size_t i) const {
+    return _variant == static_cast<Tag>(static_cast<std::size_t>(Tag::NICHE) + i);
   }
 
   template <typename ...Args>
-  explicit OptionUnion(ForwardArgs, Args&& ...args) : _variant(Tag::SOME) {
-    construct_at(std::addressof(_val), std::forward<Args>(args)...);
-  }
+  constexpr explicit OptionStorage(ForwardArgs, Args&& ...args)
+    : _variant(Tag::SOME)
+    , _cell(ForwardArgs{}, std::forward<Args>(args)...)
+  {}
 
-  bool is_some() const { return _variant == Tag::SOME; }
+  constexpr bool is_some() const { return _variant == Tag::SOME; }
 
-  T* as_ptr() { return is_some() ? std::addressof(_val) : nullptr; }
+  constexpr T* as_ptr() { return is_some() ? std::addressof(_cell._val) : nullptr; }
 
-  bool operator==(const Self& other) const {
+  constexpr bool operator==(const Self& other) const {
     if (is_some()) {
-      return other.is_some() ? (_val == other._val) : false;
+      return other.is_some() ? (_cell._val == other._cell._val) : false;
     } else {
       return !other.is_some();
     }
   }
 
-  T dump() {
+  constexpr T dump() {
     _variant = Tag::NONE;
-    auto val = std::move(_val);
-    _val.~T();
-    _empty = {};
+    auto val = std::move(_cell._val);
+    fun::destroy_at(std::addressof(_cell._val));
 #if defined(__GNUC__) && __GNUC__ <= 4
     return std::move(val);
 #else
@@ -215,11 +310,26 @@ public:
   }
 
   template <typename ...Args>
-  void emplace(Args&& ...args) {
+  constexpr void emplace(Args&& ...args) {
     erase();
-    construct_at(std::addressof(_val), std::forward<Args>(args)...);
+    fun::construct_at(std::addressof(_cell._val), std::forward<Args>(args)...);
     _variant = Tag::SOME;
   }
 };
 
+//------------------------------------------------------------------------------
+template <class T, class En>
+class FUN_TRIVIAL_ABI OptionUnion : public SpecialMembers<OptionStorage<T>, T> {
+  using Self = OptionUnion;
+  using Base = SpecialMembers<OptionStorage<T>, T>;
+public:
+  using Base::Base;
+
+  OptionUnion() = default;
+
+  constexpr Self clone() const { return *this; }
+
+  constexpr bool operator==(const Self& other) const { return Base::operator==(other); }
+};
+
 }
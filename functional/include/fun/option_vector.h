@@ -0,0 +1,187 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fun/bitmap.h>
+#include <fun/option.h>
+
+namespace fun {
+
+//!
+//! OptionVector type
+//!
+//! A column of `Option<T>` stored as structure-of-arrays: a dense array of
+//! values next to a packed presence bitmap, so that each row costs
+//! `sizeof(T)` plus one bit instead of `sizeof(Option<T>)`. Absent rows hold
+//! a value-initialized `T`.
+//!
+//! Rows are accessed as `Option<T&>` views, in the style of `Option::as_ref`,
+//! and iterating an OptionVector visits only the present rows, skipping
+//! absent runs a word of the bitmap at a time.
+//!
+template <class T>
+class OptionVector {
+  static_assert(!std::is_reference_v<T>, "OptionVector cannot hold references");
+  static_assert(std::is_default_constructible_v<T>, "OptionVector requires a default constructible element type");
+  static_assert(!std::is_same_v<T, bool>, "OptionVector<bool> is not supported, use a pair of Bitmaps");
+
+public:
+  using self_t = OptionVector<T>;
+  using value_t = T;
+
+  using Iter = SetBitIter<T>;
+  using ConstIter = SetBitIter<const T>;
+
+private:
+  std::vector<T> _values;
+  Bitmap _present;
+
+public:
+  OptionVector() = default;
+
+  //! A vector of `n` absent rows
+  explicit OptionVector(const std::size_t n) : _values(n), _present(n) {}
+
+  explicit OptionVector(const std::vector<Option<T>>& ops) {
+    reserve(ops.size());
+    for (const auto& op : ops) { push_back(op.cloned()); }
+  }
+
+  explicit OptionVector(std::vector<Option<T>>&& ops) {
+    reserve(ops.size());
+    for (auto& op : ops) { push_back(std::move(op)); }
+  }
+
+  auto to_options() const& -> std::vector<Option<T>> {
+    auto ops = std::vector<Option<T>>();
+    ops.reserve(size());
+    for (auto i = std::size_t{0}; i < size(); ++i) {
+      if (is_some(i)) { ops.emplace_back(ForwardArgs{}, _values[i]); }
+      else            { ops.emplace_back(); }
+    }
+    return ops;
+  }
+
+  auto to_options() && -> std::vector<Option<T>> {
+    auto ops = std::vector<Option<T>>();
+    ops.reserve(size());
+    for (auto i = std::size_t{0}; i < size(); ++i) {
+      if (is_some(i)) { ops.emplace_back(ForwardArgs{}, std::move(_values[i])); }
+      else            { ops.emplace_back(); }
+    }
+    clear();
+    return ops;
+  }
+
+  auto size() const -> std::size_t { return _values.size(); }
+  auto empty() const -> bool { return _values.empty(); }
+
+  auto count_some() const -> std::size_t { return _present.count(); }
+  auto count_none() const -> std::size_t { return size() - count_some(); }
+
+  void reserve(const std::size_t n) {
+    _values.reserve(n);
+    _present.reserve(n);
+  }
+
+  void clear() {
+    _values.clear();
+    _present.clear();
+  }
+
+  //! Grows with absent rows, or drops the rows past `n`
+  void resize(const std::size_t n) {
+    _values.resize(n);
+    _present.resize(n);
+  }
+
+  auto is_some(const std::size_t i) const -> bool { return _present.test(i); }
+  auto is_none(const std::size_t i) const -> bool { return !is_some(i); }
+
+  auto operator[](const std::size_t i) -> Option<T&> {
+    if (is_some(i)) { return some_ref(_values[i]); }
+    else            { return {}; }
+  }
+
+  auto operator[](const std::size_t i) const -> Option<const T&> {
+    if (is_some(i)) { return some_ref(_values[i]); }
+    else            { return {}; }
+  }
+
+  void set(const std::size_t i, Option<T> op) {
+    _present.set(i, op.is_some());
+    _values[i] = op.is_some() ? std::move(op).unwrap() : T();
+  }
+
+  //! Moves row `i` out, leaving it absent
+  auto take(const std::size_t i) -> Option<T> {
+    if (is_none(i)) { return {}; }
+    _present.set(i, false);
+    auto op = Option<T>(ForwardArgs{}, std::move(_values[i]));
+    _values[i] = T();
+    return op;
+  }
+
+  void push_back(Option<T> op) {
+    const auto present = op.is_some();
+    if (present) { _values.push_back(std::move(op).unwrap()); }
+    else         { _values.emplace_back(); }
+    _present.push_back(present);
+  }
+
+  void push_none() {
+    _values.emplace_back();
+    _present.push_back(false);
+  }
+
+  //! Appends a present row constructed from `args`
+  template <class ...Args>
+  auto emplace_back(Args&& ...args) -> T& {
+    auto& val = _values.emplace_back(std::forward<Args>(args)...);
+    _present.push_back(true);
+    return val;
+  }
+
+  //! The dense value array, absent rows hold a value-initialized `T`
+  auto values() const -> const std::vector<T>& { return _values; }
+
+  auto presence() const -> const Bitmap& { return _present; }
+
+  //! Calls `func(i, value)` for every present row `i`, in order
+  template <class F>
+  void for_each_some(F&& func) {
+    for (auto i = _present.find_next(0); i < size(); i = _present.find_next(i + 1)) { func(i, _values[i]); }
+  }
+
+  template <class F>
+  void for_each_some(F&& func) const {
+    for (auto i = _present.find_next(0); i < size(); i = _present.find_next(i + 1)) { func(i, _values[i]); }
+  }
+
+  // Iteration over the present rows
+  auto begin() -> Iter { return Iter(_values.data(), &_present, _present.find_next(0)); }
+  auto end() -> Iter { return Iter(_values.data(), &_present, size()); }
+  auto begin() const -> ConstIter { return ConstIter(_values.data(), &_present, _present.find_next(0)); }
+  auto end() const -> ConstIter { return ConstIter(_values.data(), &_present, size()); }
+  auto cbegin() const -> ConstIter { return begin(); }
+  auto cend() const -> ConstIter { return end(); }
+
+  bool operator==(const self_t& other) const {
+    if (_present != other._present) { return false; }
+    for (auto i = _present.find_next(0); i < size(); i = _present.find_next(i + 1)) {
+      if (!(_values[i] == other._values[i])) { return false; }
+    }
+    return true;
+  }
+  bool operator!=(const self_t& other) const { return !(*this == other); }
+};
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fun/collect.h>
+
+namespace fun {
+
+//------------------------------------------------------------------------------
+//! Bytes per cache line assumed when keeping per-thread state apart
+inline constexpr std::size_t cache_line_size = 64;
+
+namespace parallel_detail {
+
+inline constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+//------------------------------------------------------------------------------
+// Per-thread state on cache lines of its own, so that threads updating their
+// own slots never invalidate each other's
+template <class State>
+struct alignas(cache_line_size) Padded {
+  State state;
+};
+
+//------------------------------------------------------------------------------
+// Hands out consecutive chunks of [0, n) to the threads of a team. Chunks are
+// large at first and shrink as the work runs out ("guided" scheduling), so
+// threads that finish early take over the remainder in ever smaller pieces
+// while the shared cursor is touched only a few times per thread. Work from
+// the `limit` on is withdrawn once a failure there makes it moot.
+class ChunkQueue {
+  alignas(cache_line_size) std::atomic<std::size_t> _next;
+  alignas(cache_line_size) std::atomic<std::size_t> _limit;
+  std::size_t _size;
+  std::size_t _divisor;
+  std::size_t _min_chunk;
+
+public:
+  ChunkQueue(const std::size_t n, const std::size_t threads)
+    : _next(0)
+    , _limit(n)
+    , _size(n)
+    , _divisor(2 * threads)
+    , _min_chunk(std::max<std::size_t>(1, n / (threads * 256)))
+  {}
+
+  //! Claims the next chunk as [begin, end), unless there is none left
+  auto claim(std::size_t& begin, std::size_t& end) -> bool {
+    begin = _next.load(std::memory_order_relaxed);
+    do {
+      if (begin >= limit()) { return false; }
+      end = std::min(_size, begin + std::max(_min_chunk, (_size - begin) / _divisor));
+    } while (!_next.compare_exchange_weak(begin, end, std::memory_order_relaxed));
+    return true;
+  }
+
+  auto limit() const -> std::size_t { return _limit.load(std::memory_order_relaxed); }
+
+  //! Withdraws the work from `index` on, which running chunks notice before their next element
+  void cut(const std::size_t index) {
+    auto current = limit();
+    while (index < current && !_limit.compare_exchange_weak(current, index, std::memory_order_relaxed)) {}
+  }
+};
+
+//------------------------------------------------------------------------------
+inline auto team_size(const std::size_t threads, const std::size_t n) -> std::size_t {
+  const auto wanted = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  return std::max<std::size_t>(1, std::min(wanted, n));
+}
+
+// Runs `work(i)` for each member `i` of a team of `threads`, the calling thread
+// being member 0. Members that cannot be started are left out, the others
+// share their work between them.
+template <class Work>
+void run_team(const std::size_t threads, Work& work) {
+  auto team = std::vector<std::thread>();
+  team.reserve(threads - 1);
+  for (auto i = std::size_t{1}; i < threads; ++i) {
+    try {
+      team.emplace_back([&work, i] { work(i); });
+    } catch (const std::system_error&) {
+      break;
+    }
+  }
+  work(0);
+  for (auto& member : team) { member.join(); }
+}
+
+// The earliest failure seen by a member of a team: either an Option or Result
+// `Step`, or an exception thrown by the function being mapped
+template <class Step>
+struct Failure {
+  std::size_t index = no_index;
+  Option<Step> step;
+  std::exception_ptr exception;
+};
+
+template <class Step>
+auto earliest(std::vector<Padded<Failure<Step>>>& failures) -> Failure<Step>& {
+  return std::min_element(failures.begin(), failures.end(), [](const auto& a, const auto& b) {
+    return a.state.index < b.state.index;
+  })->state;
+}
+
+template <class R, class F>
+using Step_t = std::invoke_result_t<F&, range_detail::element_t<R>>;
+
+template <class R, class F>
+using Value_t = range_detail::stored_t<typename range_detail::Outcome<Step_t<R, F>>::payload_t>;
+
+template <class R, class F>
+using Traversed_t = typename range_detail::Outcome<Step_t<R, F>>::template rebind<std::vector<Value_t<R, F>>>;
+
+} // end namespace parallel_detail
+
+//------------------------------------------------------------------------------
+/**
+ * Maps `func` (element -> Result<U, E> or Option<U>) over a random-access `range` on a team of `threads` (by default,
+ * one per hardware thread), and collects the payloads in order, i.e. a parallel `sequence` of a transformed range.
+ *
+ * As soon as any call fails, the remaining elements beyond it are abandoned: the other threads stop before their next
+ * element. The result is the same as the sequential one, namely the failure of the earliest element that fails. An
+ * exception thrown by `func` likewise stops the team, and is rethrown on the calling thread.
+ *
+ * `func` is called concurrently from several threads.
+ */
+template <class R, class F>
+auto par_traverse(R&& range, F&& func, const std::size_t threads = 0) -> parallel_detail::Traversed_t<R, F> {
+  using Step = parallel_detail::Step_t<R, F>;
+  using Value = parallel_detail::Value_t<R, F>;
+  using Out = parallel_detail::Traversed_t<R, F>;
+  static_assert(range_detail::is_outcome_v<Step>, "par_traverse needs a function returning an Option or a Result");
+
+  const auto n = static_cast<std::size_t>(std::size(range));
+  const auto first = std::begin(range);
+  const auto team = parallel_detail::team_size(threads, n);
+
+  auto slots = std::vector<Option<Value>>(n);
+  auto failures = std::vector<parallel_detail::Padded<parallel_detail::Failure<Step>>>(team);
+  auto queue = parallel_detail::ChunkQueue(n, team);
+
+  // A member's chunks come in increasing order, so its first failure is its earliest
+  auto work = [&](const std::size_t member) {
+    auto& failure = failures[member].state;
+    auto i = std::size_t{0};
+    try {
+      for (auto begin = std::size_t{0}, end = std::size_t{0}; queue.claim(begin, end);) {
+        for (i = begin; i < end && i < queue.limit(); ++i) {
+          auto step = fun::invoke(func, static_cast<range_detail::element_t<R>>(first[i]));
+          if (range_detail::succeeded(step)) {
+            slots[i].emplace(range_detail::forward_payload<Step&&>(step));
+          } else {
+            failure.index = i;
+            failure.step.emplace(std::move(step));
+            queue.cut(i);
+            return;
+          }
+        }
+      }
+    } catch (...) {
+      failure.index = i;
+      failure.exception = std::current_exception();
+      queue.cut(i);
+    }
+  };
+  parallel_detail::run_team(team, work);
+
+  auto& failure = parallel_detail::earliest(failures);
+  if (failure.exception) { std::rethrow_exception(failure.exception); }
+  if (failure.step.is_some()) { return range_detail::fail<Out, Step&&>(*failure.step.as_ptr()); }
+  return range_detail::succeed<Out>(fun::collect<std::vector<Value>>(std::move(slots)).unwrap());
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Maps `func` (element -> Option<U>) over a random-access `range` on a team of `threads`, like `par_traverse`, and
+ * keeps the values of the Options that hold one, in order. An exception thrown by `func` stops the team, and the one
+ * thrown for the earliest element is rethrown on the calling thread.
+ *
+ * Each thread gathers its values in batches of its own, one per chunk of the range, which are joined at the end.
+ */
+template <class R, class F>
+auto par_filter_map(R&& range, F&& func, const std::size_t threads = 0) -> std::vector<parallel_detail::Value_t<R, F>> {
+  using Step = parallel_detail::Step_t<R, F>;
+  using Value = parallel_detail::Value_t<R, F>;
+  static_assert(range_detail::Outcome<Step>::is_option, "par_filter_map needs a function returning an Option");
+
+  struct Batch {
+    std::size_t begin;
+    std::vector<Value> values;
+  };
+
+  struct Member {
+    std::vector<Batch> batches;
+    parallel_detail::Failure<Step> failure;
+  };
+
+  const auto n = static_cast<std::size_t>(std::size(range));
+  const auto first = std::begin(range);
+  const auto team = parallel_detail::team_size(threads, n);
+
+  auto members = std::vector<parallel_detail::Padded<Member>>(team);
+  auto queue = parallel_detail::ChunkQueue(n, team);
+
+  auto work = [&](const std::size_t member) {
+    auto& self = members[member].state;
+    auto i = std::size_t{0};
+    try {
+      for (auto begin = std::size_t{0}, end = std::size_t{0}; queue.claim(begin, end);) {
+        auto batch = Batch{ begin, {} };
+        for (i = begin; i < end && i < queue.limit(); ++i) {
+          auto op = fun::invoke(func, static_cast<range_detail::element_t<R>>(first[i]));
+          if (op.is_some()) { batch.values.emplace_back(range_detail::forward_payload<Step&&>(op)); }
+        }
+        if (!batch.values.empty()) { self.batches.push_back(std::move(batch)); }
+      }
+    } catch (...) {
+      self.failure.index = i;
+      self.failure.exception = std::current_exception();
+      queue.cut(i);
+    }
+  };
+  parallel_detail::run_team(team, work);
+
+  auto batches = std::vector<Batch*>();
+  auto total = std::size_t{0};
+  auto failure = parallel_detail::Failure<Step>();
+  for (auto& member : members) {
+    if (member.state.failure.index < failure.index) { failure = std::move(member.state.failure); }
+    for (auto& batch : member.state.batches) {
+      batches.push_back(&batch);
+      total += batch.values.size();
+    }
+  }
+  if (failure.exception) { std::rethrow_exception(failure.exception); }
+
+  std::sort(batches.begin(), batches.end(), [](const Batch* a, const Batch* b) { return a->begin < b->begin; });
+  auto out = std::vector<Value>();
+  out.reserve(total);
+  for (auto* batch : batches) {
+    for (auto& value : batch->values) { out.push_back(std::move(value)); }
+  }
+  return out;
+}
+
+}
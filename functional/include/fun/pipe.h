@@ -1,36 +1,158 @@
 #pragma once
 
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+#include <fun/type_support.h>
+
 namespace fun {
 
+namespace pipe_detail {
+
 //------------------------------------------------------------------------------
+// The type that `pipe(x, fs...)` evaluates to, and whether evaluating it can
+// throw. Each stage receives the previous stage's result as an rvalue.
+template <class T, class ...Fs>
+struct Pipeline {
+  using type = T;
+  static constexpr bool nothrow = true;
+};
+
+template <class T, class F, class ...Fs>
+struct Pipeline<T, F, Fs...> {
+  using stage_t = std::invoke_result_t<F, T>;
+  using type = typename Pipeline<stage_t, Fs...>::type;
+  static constexpr bool nothrow = std::is_nothrow_invocable_v<F, T> && Pipeline<stage_t, Fs...>::nothrow;
+};
+
+// Stages consume their argument: an rvalue is used in place, an lvalue is
+// copied first, as it would be by a by-value parameter
+template <class M>
+constexpr auto consume(M&& m) -> std::conditional_t<std::is_lvalue_reference_v<M>, std::decay_t<M>, M&&> {
+  return std::forward<M>(m);
+}
+
+} // end namespace pipe_detail
+
+template <class T, class ...Fs>
+using PipeResult_t = typename pipe_detail::Pipeline<T, Fs...>::type;
+
+template <class T, class ...Fs>
+constexpr bool is_nothrow_pipeable_v = pipe_detail::Pipeline<T, Fs...>::nothrow;
+
+//------------------------------------------------------------------------------
+/**
+ * Threads `x` through the functions `fs`, left to right, i.e. `pipe(x, f, g)` is `g(f(x))`. Every intermediate result
+ * is a temporary that is handed to the next stage by reference, so the pipeline itself never moves a value, a stage
+ * that takes its argument by value moves it at most once.
+ */
 template <class T>
-auto pipe(T&& x) -> T { return std::forward<T>(x); }
+constexpr auto pipe(T&& x) noexcept(std::is_nothrow_constructible_v<T, T&&>) -> T { return std::forward<T>(x); }
 
-template <class T, class F, class ...Args>
-auto pipe(T&& x, F&& f, Args&& ...args) {
-  return pipe(f(std::forward<T>(x)), std::forward<Args>(args)...);
+template <class T, class F, class ...Fs>
+constexpr auto pipe(T&& x, F&& f, Fs&& ...fs) noexcept(is_nothrow_pipeable_v<T, F, Fs...>)
+  -> PipeResult_t<T, F, Fs...>
+{
+  if constexpr (sizeof...(Fs) == 0) {
+    return fun::invoke(std::forward<F>(f), std::forward<T>(x));
+  } else {
+    return fun::pipe(fun::invoke(std::forward<F>(f), std::forward<T>(x)), std::forward<Fs>(fs)...);
+  }
 }
 
 //------------------------------------------------------------------------------
-template <class F>
-auto lift(F&& f) {
-  return
-    [f = std::forward<F>(f)]
-    (auto functor) {
-      return std::move(functor).map(f);
-    };
+/**
+ * A stored, reusable pipeline: `compose(f, g)(x)` is `pipe(x, f, g)`. The functions are kept by value, calling an
+ * rvalue Composed moves them into their stages.
+ */
+template <class ...Fs>
+class Composed {
+  std::tuple<Fs...> _fs;
+
+  template <class Self, class T, std::size_t ...I>
+  static constexpr auto call(Self&& self, T&& x, std::index_sequence<I...>)
+    noexcept(is_nothrow_pipeable_v<T, decltype(std::get<I>(std::forward<Self>(self)._fs))...>)
+    -> PipeResult_t<T, decltype(std::get<I>(std::forward<Self>(self)._fs))...>
+  {
+    return fun::pipe(std::forward<T>(x), std::get<I>(std::forward<Self>(self)._fs)...);
+  }
+
+public:
+  template <class ...Gs>
+  constexpr explicit Composed(ForwardArgs, Gs&& ...gs) : _fs(std::forward<Gs>(gs)...) {}
+
+  template <class T>
+  constexpr auto operator()(T&& x) const& noexcept(is_nothrow_pipeable_v<T, const Fs&...>)
+    -> PipeResult_t<T, const Fs&...>
+  {
+    return call(*this, std::forward<T>(x), std::index_sequence_for<Fs...>());
+  }
+
+  template <class T>
+  constexpr auto operator()(T&& x) & noexcept(is_nothrow_pipeable_v<T, Fs&...>) -> PipeResult_t<T, Fs&...> {
+    return call(*this, std::forward<T>(x), std::index_sequence_for<Fs...>());
+  }
+
+  template <class T>
+  constexpr auto operator()(T&& x) && noexcept(is_nothrow_pipeable_v<T, Fs&&...>) -> PipeResult_t<T, Fs&&...> {
+    return call(std::move(*this), std::forward<T>(x), std::index_sequence_for<Fs...>());
+  }
+};
+
+template <class ...Fs>
+constexpr auto compose(Fs&& ...fs) -> Composed<std::decay_t<Fs>...> {
+  return Composed<std::decay_t<Fs>...>(ForwardArgs{}, std::forward<Fs>(fs)...);
 }
 
 //------------------------------------------------------------------------------
+/**
+ * Pipeline stage that maps `f` over an Option or Result, see `lift`. An rvalue functor is consumed in place rather than
+ * moved into the stage first.
+ */
 template <class F>
-auto bind(F&& f) {
-  return
-    [f = std::forward<F>(f)]
-    (auto monad) {
-      return std::move(monad).and_then(f);
-    };
-}
+class Lift {
+  F _f;
+
+public:
+  template <class G>
+  constexpr explicit Lift(ForwardArgs, G&& g) : _f(std::forward<G>(g)) {}
+
+  template <class M>
+  constexpr auto operator()(M&& functor) const
+    noexcept(noexcept(pipe_detail::consume(std::declval<M>()).map(std::declval<const F&>())))
+    -> decltype(pipe_detail::consume(std::declval<M>()).map(std::declval<const F&>()))
+  {
+    return pipe_detail::consume(std::forward<M>(functor)).map(_f);
+  }
+};
+
+template <class F>
+constexpr auto lift(F&& f) -> Lift<std::decay_t<F>> { return Lift<std::decay_t<F>>(ForwardArgs{}, std::forward<F>(f)); }
+
+//------------------------------------------------------------------------------
+/**
+ * Pipeline stage that chains `f` onto an Option or Result with `and_then`, see `bind`.
+ */
+template <class F>
+class Bind {
+  F _f;
+
+public:
+  template <class G>
+  constexpr explicit Bind(ForwardArgs, G&& g) : _f(std::forward<G>(g)) {}
+
+  template <class M>
+  constexpr auto operator()(M&& monad) const
+    noexcept(noexcept(pipe_detail::consume(std::declval<M>()).and_then(std::declval<const F&>())))
+    -> decltype(pipe_detail::consume(std::declval<M>()).and_then(std::declval<const F&>()))
+  {
+    return pipe_detail::consume(std::forward<M>(monad)).and_then(_f);
+  }
+};
+
+template <class F>
+constexpr auto bind(F&& f) -> Bind<std::decay_t<F>> { return Bind<std::decay_t<F>>(ForwardArgs{}, std::forward<F>(f)); }
 
 } // end namespace fun
@@ -1,3 +1,4 @@
 #pragma once
 
 #include <fun/result/result.impl.h>
+#include <fun/lazy.h>
@@ -5,177 +5,269 @@
 //! @copyright MIT LIcense
 //!
 
+#include <memory>
 #include <ostream>
+#include <tuple>
 
 #include <fun/type_support.h>
 #include <fun/option/option.declare.h>
+#include <fun/result/result_inner.h>
 
 namespace fun {
 
 //------------------------------------------------------------------------------
 template <class T, class E> class Result;
 
+template <class T, class E, class ...Stages> class LazyResult;
+
+// `ok(x)` and `err(x)` hold their value until it is converted into a Result,
+// which moves it once more. `make_ok` and `make_err` (and the `ok<E>(x)` and
+// `err<T>(x)` forms) construct the payload directly in the Result.
 template <class T> struct MakeOkResult{ T val; };
 template <class E> struct MakeErrResult{ E val; };
 
 template <class Arg>
-auto ok(Arg&& val) -> MakeOkResult<std::decay_t<Arg>>;
+constexpr auto ok(Arg&& val) -> MakeOkResult<std::decay_t<Arg>>;
 
 template <class E, class Arg>
-auto ok(Arg&& val) -> Result<std::decay_t<Arg>, E>;
+constexpr auto ok(Arg&& val) -> Result<std::decay_t<Arg>, E>;
 
 template <class T>
-auto ok_cref(const T& val) -> MakeOkResult<const T&>;
+constexpr auto ok_cref(const T& val) -> MakeOkResult<const T&>;
 
 template <class T>
 auto ok_cref(const T&& val) = delete;
 
 template <class T>
-auto ok_ref(T& val) -> MakeOkResult<T&>;
+constexpr auto ok_ref(T& val) -> MakeOkResult<T&>;
 
 template <class T>
 auto ok_ref(const T&& val) = delete;
 
 template <class E, class T>
-auto ok_ref(T& val) -> Result<T&, E>;
+constexpr auto ok_ref(T& val) -> Result<T&, E>;
 
 template <class E, class T>
 auto ok_ref(const T&& val) = delete;
 
 template <class Arg>
-auto err(Arg&& val) -> MakeErrResult<std::decay_t<Arg>>;
+constexpr auto err(Arg&& val) -> MakeErrResult<std::decay_t<Arg>>;
 
 template <class T, class Arg>
-auto err(Arg&& val) -> Result<T, std::decay_t<Arg>>;
+constexpr auto err(Arg&& val) -> Result<T, std::decay_t<Arg>>;
 
 template <class E>
-auto err_cref(const E& val) -> MakeErrResult<const E&>;
+constexpr auto err_cref(const E& val) -> MakeErrResult<const E&>;
 
 template <class E>
 auto err_cref(const E&& val) = delete;
 
 template <class E>
-auto err_ref(E& val) -> MakeErrResult<E&>;
+constexpr auto err_ref(E& val) -> MakeErrResult<E&>;
 
 template <class E>
 auto err_ref(const E&& val) = delete;
 
 template <class T, class E>
-auto err_ref(E& val) -> Result<T, E&>;
+constexpr auto err_ref(E& val) -> Result<T, E&>;
 
 template <class T, class E>
 auto err_ref(const E&& val) = delete;
 
-struct OkTag {};
-struct ErrTag {};
-
 template <class Tag, class ...Args>
 struct MakeResultArgs { std::tuple<Args...> tup; };
 
 template <class ...Args>
-auto make_ok(Args&& ...args) -> MakeResultArgs<OkTag, Args&&...>
+constexpr auto make_ok(Args&& ...args) -> MakeResultArgs<OkTag, Args&&...>
 {
   return { std::forward_as_tuple(std::forward<Args>(args)...) };
 }
 
 template <class ...Args>
-auto make_err(Args&& ...args) -> MakeResultArgs<ErrTag, Args&&...>
+constexpr auto make_err(Args&& ...args) -> MakeResultArgs<ErrTag, Args&&...>
 {
   return { std::forward_as_tuple(std::forward<Args>(args)...) };
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-class Result {
+class FUN_TRIVIAL_ABI Result {
 public:
   using self_t = Result<T, E>;
 
   using value_t = std::remove_reference_t<T>;
   using error_t = std::remove_reference_t<E>;
 
+  // Results that pack their error into the low bit of a pointer (see
+  // `ResultLayout::Pointer`) can only provide their error by value
+  using error_ref_t = std::conditional_t<ResultUnion<T, E>::is_err_addressable, error_t&, error_t>;
+  using error_cref_t = std::conditional_t<ResultUnion<T, E>::is_err_addressable, const error_t&, error_t>;
+
 private:
-  enum { Ok, Err } _variant;
-  union {
-    Sized<T> _ok;
-    Sized<E> _err;
-  };
+  template <class, class> friend struct NicheTraits;
+  template <class, class> friend class Result;
+
+  ResultUnion<T, E> _inner;
 
   // ** only call on `Ok` variant, otherwise undefined behavior **
-  T dump_ok();
+  constexpr T dump_ok();
 
   // ** only call on `Err` variant, otherwise undefined behavior **
-  E dump_err();
+  constexpr E dump_err();
+
+  // Hand the contained value or error to a consumer without moving it out
+  // first, the Result keeps whatever the consumer leaves behind. An error
+  // packed into a pointer is passed by value.
+  // ** only call on the matching variant, otherwise undefined behavior **
+  constexpr auto forward_ok() noexcept -> T&& { return static_cast<T&&>(_inner.ok_val()); }
+  constexpr decltype(auto) forward_err() noexcept {
+    if constexpr (ResultUnion<T, E>::is_err_addressable) { return static_cast<E&&>(_inner.err_val()); }
+    else                                                 { return dump_err(); }
+  }
+
+  // Whether moving the value or the error, or handing either one to an `F`
+  // and keeping what comes back, can throw
+  static constexpr bool nothrow_move_ok = std::is_nothrow_move_constructible_v<T>;
+  static constexpr bool nothrow_move_err = std::is_nothrow_move_constructible_v<E>;
+
+  template <class F, class ...Args>
+  static constexpr bool nothrow_call = is_nothrow_unvoid_callable_v<F, Args...>;
 
 public:
-  ~Result();
+  ~Result() = default;
 
-  Result(self_t&&);
-  auto operator=(self_t&&) -> self_t&;
+  Result(self_t&&) = default;
+  auto operator=(self_t&&) -> self_t& = default;
 
-  Result(const self_t&);
-  auto operator=(const self_t&) -> self_t&;
+  Result(const self_t&) = default;
+  auto operator=(const self_t&) -> self_t& = default;
 
   Result() = delete;
 
-  auto clone() const -> self_t;
+  constexpr auto clone() const
+    noexcept(std::is_nothrow_copy_constructible_v<T> && std::is_nothrow_copy_constructible_v<E>) -> self_t;
+
+  constexpr explicit Result(ResultUnion<T, E> mem) noexcept(nothrow_move_ok && nothrow_move_err)
+    : _inner(std::move(mem))
+  {}
 
   template <typename ...Args>
-  Result(OkTag, ForwardArgs, Args&& ...args);
+  constexpr Result(OkTag, ForwardArgs, Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>);
 
   template <typename ...Args>
-  Result(ErrTag, ForwardArgs, Args&& ...args);
+  constexpr Result(ErrTag, ForwardArgs, Args&& ...args) noexcept(std::is_nothrow_constructible_v<E, Args&&...>);
 
-  Result(MakeOkResult<T>);
-  Result(MakeErrResult<E>);
+  constexpr Result(MakeOkResult<T>) noexcept(nothrow_move_ok);
+  constexpr Result(MakeErrResult<E>) noexcept(nothrow_move_err);
+
+  template <class Tag>
+  using TagPayload = std::conditional_t<std::is_same_v<Tag, OkTag>, T, E>;
 
   template <class Tag, class ...Args, size_t ...Indices>
-  Result(Tag tag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>)
+  constexpr Result(Tag tag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>)
+    noexcept(std::is_nothrow_constructible_v<TagPayload<Tag>, Args&&...>)
     : Result(tag, ForwardArgs{}, std::forward<Args>(std::get<Indices>(args))...)
   {}
 
   template <class Tag, class ...Args>
-  Result(MakeResultArgs<Tag, Args...>&& make_args)
+  constexpr Result(MakeResultArgs<Tag, Args...>&& make_args)
+    noexcept(std::is_nothrow_constructible_v<TagPayload<Tag>, Args&&...>)
     : Result(Tag{}, make_args.tup, std::index_sequence_for<Args...>{})
   {}
 
-  auto operator=(const MakeOkResult<T>&) -> self_t&;
-  auto operator=(const MakeErrResult<E>&) -> self_t&;
+  template <class Tag, class ...Args>
+  constexpr Result(Tag tag, std::tuple<Args...>&& args)
+    noexcept(std::is_nothrow_constructible_v<TagPayload<Tag>, Args&&...>)
+    : Result(tag, args, std::index_sequence_for<Args...>{})
+  {}
+
+  // Allocator-extended constructors
+  //!
+  //! A Result uses allocators of type `A` if either payload does (see the `std::uses_allocator` specialization), so
+  //! that allocator-aware containers hand theirs down to the payload, which is constructed with `alloc` by
+  //! uses-allocator construction.
+  //!
+  template <class A>
+  constexpr Result(std::allocator_arg_t, const A& alloc, const self_t& other)
+    : Result(other.is_ok() ? self_t(std::allocator_arg, alloc, OkTag{}, ForwardArgs{}, other._inner.ok_val())
+                           : self_t(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, other._inner.err_val()))
+  {}
+
+  template <class A>
+  constexpr Result(std::allocator_arg_t, const A& alloc, self_t&& other)
+    : Result(other.is_ok() ? self_t(std::allocator_arg, alloc, OkTag{}, ForwardArgs{}, other.forward_ok())
+                           : self_t(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, other.forward_err()))
+  {}
+
+  template <class A, class Tag, class ...Args>
+  constexpr Result(std::allocator_arg_t, const A& alloc, Tag tag, ForwardArgs, Args&& ...args)
+    : Result(tag, uses_allocator_args<TagPayload<Tag>>(alloc, std::forward<Args>(args)...))
+  {}
+
+  template <class A>
+  constexpr Result(std::allocator_arg_t, const A& alloc, MakeOkResult<T> x)
+    : Result(std::allocator_arg, alloc, OkTag{}, ForwardArgs{}, std::forward<T>(x.val))
+  {}
+
+  template <class A>
+  constexpr Result(std::allocator_arg_t, const A& alloc, MakeErrResult<E> x)
+    : Result(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, std::forward<E>(x.val))
+  {}
+
+  template <class A, class Tag, class ...Args, size_t ...Indices>
+  constexpr Result(
+    std::allocator_arg_t, const A& alloc, Tag tag, std::tuple<Args...>& args, std::integer_sequence<size_t, Indices...>
+  )
+    : Result(std::allocator_arg, alloc, tag, ForwardArgs{}, std::forward<Args>(std::get<Indices>(args))...)
+  {}
+
+  template <class A, class Tag, class ...Args>
+  constexpr Result(std::allocator_arg_t, const A& alloc, MakeResultArgs<Tag, Args...>&& make_args)
+    : Result(std::allocator_arg, alloc, Tag{}, make_args.tup, std::index_sequence_for<Args...>{})
+  {}
 
-  bool is_ok() const;
-  bool is_err() const;
-  explicit operator bool() const { return is_ok(); }
+  constexpr auto operator=(const MakeOkResult<T>&)
+    noexcept(std::is_nothrow_copy_constructible_v<T> && nothrow_move_ok && nothrow_move_err) -> self_t&;
+  constexpr auto operator=(const MakeErrResult<E>&)
+    noexcept(std::is_nothrow_copy_constructible_v<E> && nothrow_move_ok && nothrow_move_err) -> self_t&;
 
-  auto as_ptr() -> value_t*;
-  auto as_ptr() const -> const value_t*;
-  auto as_const_ptr() const -> const value_t* { return as_ptr(); }
-  auto as_err_ptr() -> error_t*;
-  auto as_err_ptr() const -> const error_t*;
-  auto as_const_err_ptr() const -> const error_t* { return as_err_ptr(); }
+  constexpr bool is_ok() const noexcept;
+  constexpr bool is_err() const noexcept;
+  constexpr explicit operator bool() const noexcept { return is_ok(); }
 
-  bool operator==(const self_t& other) const;
-  bool operator!=(const self_t& other) const;
+  constexpr auto as_ptr() noexcept -> value_t*;
+  constexpr auto as_ptr() const noexcept -> const value_t*;
+  constexpr auto as_const_ptr() const noexcept -> const value_t* { return as_ptr(); }
+  constexpr auto as_err_ptr() noexcept -> error_t*;
+  constexpr auto as_err_ptr() const noexcept -> const error_t*;
+  constexpr auto as_const_err_ptr() const noexcept -> const error_t* { return as_err_ptr(); }
 
-  bool operator==(const MakeOkResult<T>& other) const {
-    if (is_ok()) { return _ok._val == other.val; }
+  constexpr bool operator==(const self_t& other) const;
+  constexpr bool operator!=(const self_t& other) const;
+
+  constexpr bool operator==(const MakeOkResult<T>& other) const {
+    if (is_ok()) { return _inner.ok_val() == other.val; }
     else         { return false; }
   }
-  bool operator==(const MakeErrResult<E>& other) const {
+  constexpr bool operator==(const MakeErrResult<E>& other) const {
     if (is_ok()) { return false; }
-    else         { return _err._val == other.val; }
+    else         { return _inner.err_val() == other.val; }
   }
 
   template <class U>
-  bool operator!=(const U& other) const { return !(*this == other); }
+  constexpr bool operator!=(const U& other) const { return !(*this == other); }
 
-  auto unwrap() && -> T;
+  constexpr auto unwrap() && noexcept(nothrow_move_ok) -> T;
 
-  auto unwrap_or(T alt) && -> T;
+  //! `alt` is only converted to `T` if it is needed
+  template <class U = T, class = std::enable_if_t<std::is_constructible_v<T, U&&>>>
+  constexpr auto unwrap_or(U&& alt) && noexcept(nothrow_move_ok && std::is_nothrow_constructible_v<T, U&&>) -> T;
 
   template <class F>
-  auto unwrap_or_else(F&& alt_func) && -> T;
+  constexpr auto unwrap_or_else(F&& alt_func) && noexcept(nothrow_move_ok && nothrow_call<F, E>) -> T;
 
   template <class X = void> // Dummy template parameter to defer static_assert
-  auto unwrap_or_default() && -> T {
+  constexpr auto unwrap_or_default() && noexcept(nothrow_move_ok && std::is_nothrow_default_constructible_v<T>) -> T {
     static_assert(
       !std::is_reference_v<first_t<T, X>>,
       "Result::unwrap_or_default is disallowed for references"
@@ -184,71 +276,153 @@ public:
     return std::move(*this).unwrap_or_else([](auto&&) -> T { return {}; });
   }
 
-  auto unwrap_err() && -> E;
+  constexpr auto unwrap_err() && noexcept(nothrow_move_err) -> E;
+
+  //! Return the value, or the error, of a Result the caller knows to be `Ok`, or `Err`, without checking it again. On
+  //! the other variant they are undefined behavior, unless `FUN_CHECK_ASSUMPTIONS` is set, in which case they abort.
+  constexpr auto unwrap_unchecked() && noexcept(nothrow_move_ok) -> T;
+  constexpr auto unwrap_err_unchecked() && noexcept(nothrow_move_err) -> E;
+
+  constexpr auto as_ref() noexcept -> Result<value_t&, error_ref_t>;
 
-  auto as_ref() -> Result<value_t&, error_t&>;
+  constexpr auto as_ref() const noexcept -> Result<const value_t&, error_cref_t>;
 
-  auto as_ref() const -> Result<const value_t&, const error_t&>;
+  constexpr auto as_cref() const noexcept -> Result<const value_t&, error_cref_t>;
 
-  auto as_cref() const -> Result<const value_t&, const error_t&>;
+  //!
+  //! Replaces the contents with an Ok value constructed in place from `args`
+  //!
+  //! @note If that construction throws and `T` is not trivially copyable,
+  //!       the Result is left valueless and may then only be destroyed or
+  //!       assigned to.
+  //!
+  template <typename ...Args>
+  constexpr auto emplace_ok(Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) -> self_t&;
+
+  //! Replaces the contents with an error constructed in place from `args`, see `emplace_ok`
+  template <typename ...Args>
+  constexpr auto emplace_err(Args&& ...args) noexcept(std::is_nothrow_constructible_v<E, Args&&...>) -> self_t&;
 
-  auto ok() && -> Option<T>;
-  auto err() && -> Option<E>;
+  //! Replaces the contents with `other`, returning the previous contents
+  constexpr auto replace(self_t other) noexcept(nothrow_move_ok && nothrow_move_err) -> self_t;
+
+  //!
+  //! Exchanges the contents with `other`. Values (or errors) on both sides
+  //! are swapped directly, otherwise the Results are exchanged by moves.
+  //!
+  constexpr void swap(self_t& other) noexcept(
+    nothrow_move_ok && nothrow_move_err && std::is_nothrow_swappable_v<T> && std::is_nothrow_swappable_v<E>
+  );
+
+  constexpr auto ok() && noexcept(nothrow_move_ok) -> Option<T>;
+  constexpr auto err() && noexcept(nothrow_move_err) -> Option<E>;
 
   template <class F>
   using MatchReturn = InvokeResult_t<F, T>;
 
   template <typename OkFunc, typename ErrFunc>
-  auto match(OkFunc&& func_ok, ErrFunc&& func_err) && -> MatchReturn<OkFunc>;
+  constexpr auto match(OkFunc&& func_ok, ErrFunc&& func_err) && noexcept(nothrow_call<OkFunc, T> && nothrow_call<ErrFunc, E>)
+    -> MatchReturn<OkFunc>;
+
+  template <typename U, typename F>
+  constexpr auto map_or(U default_val, F&& func) && noexcept(nothrow_call<F, T> && std::is_nothrow_move_constructible_v<U>)
+    -> U;
+
+  //! Like `map_or`, but the default is only computed (from the error) if it is needed
+  template <typename DefaultFunc, typename F>
+  constexpr auto map_or_else(DefaultFunc&& default_func, F&& func) &&
+    noexcept(nothrow_call<F, T> && nothrow_call<DefaultFunc, E>) -> MatchReturn<F>;
 
   template <class F>
   using MapReturn = Result<InvokeResult_t<F, T>, E>;
 
   template <typename F>
-  auto map(F&& func) && -> MapReturn<F>;
+  constexpr auto map(F&& func) && noexcept(nothrow_call<F, T> && nothrow_move_err) -> MapReturn<F>;
+
+  //! `map`, the value (or error) being moved into the new Result by uses-allocator construction with `alloc`
+  template <typename A, typename F>
+  constexpr auto map(std::allocator_arg_t, const A& alloc, F&& func) && -> MapReturn<F>;
 
   template <class F>
   using ErrMapReturn = Result<T, InvokeResult_t<F, E>>;
 
   template <typename F>
-  auto map_err(F&& func) && -> ErrMapReturn<F>;
+  constexpr auto map_err(F&& func) && noexcept(nothrow_call<F, E> && nothrow_move_ok) -> ErrMapReturn<F>;
+
+  //! `map_err`, see the allocator-extended `map`
+  template <typename A, typename F>
+  constexpr auto map_err(std::allocator_arg_t, const A& alloc, F&& func) && -> ErrMapReturn<F>;
 
   template <typename U>
-  auto zip(Result<U, E>) && -> Result<std::pair<T, U>, E>;
+  constexpr auto zip(Result<U, E>) && noexcept(nothrow_move_ok && nothrow_move_err && std::is_nothrow_move_constructible_v<U>)
+    -> Result<std::pair<T, U>, E>;
 
   template <class F>
   using AndThenReturn = Result<typename InvokeResult_t<F, T>::value_t, E>;
 
   template <typename F /* T -> Result<U, E> */>
-  auto and_then(F&& func) && -> AndThenReturn<F>;
+  constexpr auto and_then(F&& func) && noexcept(nothrow_call<F, T> && nothrow_move_err) -> AndThenReturn<F>;
+
+  //! `and_then`, the Result returned by `func` (or the error) being moved with `alloc`
+  template <typename A, typename F /* T -> Result<U, E> */>
+  constexpr auto and_then(std::allocator_arg_t, const A& alloc, F&& func) && -> AndThenReturn<F>;
 
   template <class F>
   using OrElseReturn = Result<T, typename InvokeResult_t<F, E>::error_t>;
 
   template <typename F>
-  auto or_else(F&& alt_func) && -> OrElseReturn<F>;
+  constexpr auto or_else(F&& alt_func) && noexcept(nothrow_call<F, E> && nothrow_move_ok) -> OrElseReturn<F>;
+
+  //!
+  //! Starts a lazy chain of `map`, `map_err` and `and_then` calls that is
+  //! fused into a single pass when `eval()` is called (see `LazyResult` in
+  //! fun/lazy.h). The value or error is moved out of this Result by `eval()`,
+  //! which is to be called within the same full expression.
+  //!
+  constexpr auto lazy() && noexcept -> LazyResult<T, E>;
+  auto lazy() const& = delete;
 };
 
 template <class T>
-auto ok_val(T&& val) -> MakeOkResult<T&&>
+constexpr auto ok_val(T&& val) -> MakeOkResult<T&&>
 {
   return { std::forward<T>(val) };
 }
 
+//------------------------------------------------------------------------------
+/**
+ * Results lend the unused states of their storage to enclosing Options and Results, so that e.g.
+ * `Option<Result<T, E>>` is no larger than `Result<T, E>`.
+ */
+template <class T, class E>
+struct NicheTraits<Result<T, E>> {
+  static constexpr std::size_t count = ResultUnion<T, E>::niche_count;
+  static constexpr bool reserved = true;
+
+  static constexpr Result<T, E> make(const std::size_t i) { return Result<T, E>(ResultUnion<T, E>(NicheTag{}, i)); }
+
+  static constexpr bool is(const Result<T, E>& x, const std::size_t i) { return x._inner.is_niche(i); }
+};
+
 }
 
+template <class T, class E, class A>
+struct std::uses_allocator<fun::Result<T, E>, A>
+  : std::bool_constant<std::uses_allocator_v<std::remove_cv_t<T>, A> || std::uses_allocator_v<std::remove_cv_t<E>, A>>
+{};
+
 template <class T, class E>
-bool operator==(const fun::MakeOkResult<T>& a, const fun::Result<T, E>& b) {
+constexpr bool operator==(const fun::MakeOkResult<T>& a, const fun::Result<T, E>& b) {
   return b == a;
 }
 
 template <class T, class E>
-bool operator==(const fun::MakeErrResult<E>& a, const fun::Result<T, E>& b) {
+constexpr bool operator==(const fun::MakeErrResult<E>& a, const fun::Result<T, E>& b) {
   return b == a;
 }
 
 template <class U, class T, class E>
-bool operator!=(const U& a, const fun::Result<T, E>& b) {
+constexpr bool operator!=(const U& a, const fun::Result<T, E>& b) {
   return b != a;
 }
 
@@ -10,65 +10,95 @@
 
 namespace fun {
 
+namespace result_detail {
+
+// The error type `E` of a `Result<T, E>`, references included
+template <class R>
+struct ErrorOf;
+
+template <class T, class E>
+struct ErrorOf<Result<T, E>> { using type = E; };
+
+// The error of `x`, a Result that is an `X` (or a reference to one). Only
+// errors of rvalues are moved from, and an error packed into a pointer is
+// provided by value.
+// ** only call on the `Err` variant, otherwise undefined behavior **
+template <class X, class V>
+constexpr auto forward_err(V& x) noexcept -> decltype(auto) {
+  using Res = std::remove_cv_t<V>;
+  if constexpr (std::is_reference_v<typename Res::error_ref_t>) {
+    auto& err = *x.as_err_ptr();
+    if constexpr (std::is_lvalue_reference_v<X> || std::is_reference_v<typename ErrorOf<Res>::type>) {
+      return (err);
+    } else {
+      return std::move(err);
+    }
+  } else {
+    return x.as_cref().unwrap_err();
+  }
+}
+
+} // end namespace result_detail
+
 //==============================================================================
 // Result-releated function definitions
 //------------------------------------------------------------------------------
 template <class Arg>
-auto ok(Arg&& val) -> MakeOkResult<std::decay_t<Arg>> {
+constexpr auto ok(Arg&& val) -> MakeOkResult<std::decay_t<Arg>> {
   return { std::forward<Arg>(val) };
 }
 
 //------------------------------------------------------------------------------
 template <class E, class Arg>
-auto ok(Arg&& val) -> Result<std::decay_t<Arg>, E> {
+constexpr auto ok(Arg&& val) -> Result<std::decay_t<Arg>, E> {
   return { OkTag{}, ForwardArgs{}, std::forward<Arg>(val) };
 }
 
 //------------------------------------------------------------------------------
 template <class T>
-auto ok_cref(const T& val) -> MakeOkResult<const T&> {
+constexpr auto ok_cref(const T& val) -> MakeOkResult<const T&> {
   return { val };
 }
 
 //------------------------------------------------------------------------------
 template <class T>
-auto ok_ref(T& val) -> MakeOkResult<T&> {
+constexpr auto ok_ref(T& val) -> MakeOkResult<T&> {
   return { val };
 }
 
 //------------------------------------------------------------------------------
 template <class E, class T>
-auto ok_ref(T& val) -> Result<T&, E> {
+constexpr auto ok_ref(T& val) -> Result<T&, E> {
   return { OkTag{}, ForwardArgs{}, val };
 }
 
 //------------------------------------------------------------------------------
 template <class Arg>
-auto err(Arg&& val) -> MakeErrResult<std::decay_t<Arg>> {
+constexpr auto err(Arg&& val) -> MakeErrResult<std::decay_t<Arg>> {
   return { std::forward<Arg>(val) };
 }
 
 //------------------------------------------------------------------------------
 template <class T, class Arg>
-auto err(Arg&& val) -> Result<T, std::decay_t<Arg>> {
+constexpr auto err(Arg&& val) -> Result<T, std::decay_t<Arg>> {
   return { ErrTag{}, ForwardArgs{}, std::forward<Arg>(val) };
 }
 
 //------------------------------------------------------------------------------
 template <class E>
-auto err_cref(const E& val) -> MakeErrResult<const E&> {
+constexpr auto err_cref(const E& val) -> MakeErrResult<const E&> {
   return { val };
 }
 
 //------------------------------------------------------------------------------
 template <class E>
-auto err_ref(E& val) -> MakeErrResult<E&> {
+constexpr auto err_ref(E& val) -> MakeErrResult<E&> {
   return { val };
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto err_ref(E& val) -> Result<T, E&> {
+constexpr auto err_ref(E& val) -> Result<T, E&> {
   return { ErrTag{}, ForwardArgs{}, val };
 }
 
@@ -76,263 +106,354 @@ auto err_ref(E& val) -> Result<T, E&> {
 // Option definitions
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::dump_ok() -> T {
-  assert(_variant == Ok);
-  return std::move(_ok).unwrap();
+constexpr auto Result<T, E>::dump_ok() -> T {
+  assert(is_ok());
+  return _inner.dump_ok();
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::dump_err() -> E {
-  assert(_variant == Err);
-  return std::move(_err).unwrap();
+constexpr auto Result<T, E>::dump_err() -> E {
+  assert(is_err());
+  return _inner.dump_err();
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-Result<T, E>::~Result() {
-  if (_variant == Ok) { _ok.~Sized<T>(); }
-  else                { _err.~Sized<E>(); }
+constexpr auto Result<T, E>::operator=(const MakeOkResult<T>& other)
+  noexcept(std::is_nothrow_copy_constructible_v<T> && nothrow_move_ok && nothrow_move_err) -> self_t&
+{
+  return *this = self_t(other);
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-Result<T, E>::Result(self_t&& other)
-  : _variant(other._variant)
+constexpr auto Result<T, E>::operator=(const MakeErrResult<E>& other)
+  noexcept(std::is_nothrow_copy_constructible_v<E> && nothrow_move_ok && nothrow_move_err) -> self_t&
 {
-  if (_variant == Ok) { new (&_ok)  Sized<T>{ other.dump_ok() }; }
-  else                { new (&_err) Sized<E>{ other.dump_err() }; }
+  return *this = self_t(other);
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator=(self_t&& other) -> self_t& {
-  if (this != &other) {
-    (*this).~Result<T, E>();
-    new (this) self_t(std::move(other));
-  }
-  return *this;
+constexpr auto Result<T, E>::clone() const
+  noexcept(std::is_nothrow_copy_constructible_v<T> && std::is_nothrow_copy_constructible_v<E>) -> self_t
+{
+  return self_t(*this);
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-Result<T, E>::Result(const self_t& other)
-  : _variant(other._variant)
-{
-  if (_variant == Ok) { new (&_ok) Sized<T>(other._ok.val()); }
-  else                { new (&_err) Sized<E>(other._err.val()); }
-}
+template <typename ...Args>
+constexpr Result<T, E>::Result(OkTag, ForwardArgs, Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+  : _inner(OkTag{}, ForwardArgs{}, std::forward<Args>(args)...)
+{}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator=(const self_t& other) -> self_t& {
-  if (this != &other) {
-    (*this).~Result<T, E>();
-    new (this) self_t(other);
-  }
-  return *this;
-}
+template <typename ...Args>
+constexpr Result<T, E>::Result(ErrTag, ForwardArgs, Args&& ...args) noexcept(std::is_nothrow_constructible_v<E, Args&&...>)
+  : _inner(ErrTag{}, ForwardArgs{}, std::forward<Args>(args)...)
+{}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator=(const MakeOkResult<T>& other) -> self_t& {
-  (*this).~Result<T, E>();
-  new (this) Result<T, E>(other);
-  return *this;
-}
+constexpr Result<T, E>::Result(MakeOkResult<T> ok) noexcept(nothrow_move_ok)
+  : Result(OkTag{}, ForwardArgs{}, std::forward<T>(ok.val))
+{}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator=(const MakeErrResult<E>& other) -> self_t& {
-  (*this).~Result<T, E>();
-  new (this) Result<T, E>(other);
-  return *this;
-}
+constexpr Result<T, E>::Result(MakeErrResult<E> err) noexcept(nothrow_move_err)
+  : Result(ErrTag{}, ForwardArgs{}, std::forward<E>(err.val))
+{}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::clone() const -> self_t { return self_t(*this); }
+constexpr auto Result<T, E>::is_ok() const noexcept -> bool { return _inner.is_ok(); }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-template <typename ...Args>
-Result<T, E>::Result(OkTag, ForwardArgs, Args&& ...args)
-  : _variant(Ok), _ok(Sized<T>(std::forward<Args>(args)...))
-{}
+constexpr auto Result<T, E>::is_err() const noexcept -> bool { return !is_ok(); }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-template <typename ...Args>
-Result<T, E>::Result(ErrTag, ForwardArgs, Args&& ...args)
-  : _variant(Err), _err(Sized<E>(std::forward<Args>(args)...))
-{}
+constexpr auto Result<T, E>::as_ptr() noexcept -> value_t* { return is_ok() ? &_inner.ok_val() : nullptr; }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-Result<T, E>::Result(MakeOkResult<T> ok)
-  : Result(OkTag{}, ForwardArgs{}, std::forward<T>(ok.val))
-{}
+constexpr auto Result<T, E>::as_ptr() const noexcept -> const value_t* { return is_ok() ? &_inner.ok_val() : nullptr; }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-Result<T, E>::Result(MakeErrResult<E> err)
-  : Result(ErrTag{}, ForwardArgs{}, std::forward<E>(err.val))
-{}
+constexpr auto Result<T, E>::as_err_ptr() noexcept -> error_t* {
+  static_assert(ResultUnion<T, E>::is_err_addressable, "This Result stores its error packed into a pointer");
+  return is_err() ? &_inner.err_val() : nullptr;
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::is_ok() const -> bool { return _variant == Ok; }
+constexpr auto Result<T, E>::as_err_ptr() const noexcept -> const error_t* {
+  static_assert(ResultUnion<T, E>::is_err_addressable, "This Result stores its error packed into a pointer");
+  return is_err() ? &_inner.err_val() : nullptr;
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::is_err() const -> bool { return !is_ok(); }
+constexpr auto Result<T, E>::operator==(const self_t& other) const -> bool {
+  if (is_ok()) {
+    return other.is_ok() ? (_inner.ok_val() == other._inner.ok_val()) : false;
+  } else {
+    return other.is_err() ? (_inner.err_val() == other._inner.err_val()) : false;
+  }
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_ptr() -> value_t* { return is_ok() ? &_ok.val() : nullptr; }
+constexpr auto Result<T, E>::operator!=(const self_t& other) const -> bool { return !(*this == other); }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_ptr() const -> const value_t* { return is_ok() ? &_ok.val() : nullptr; }
+constexpr auto Result<T, E>::unwrap() && noexcept(nothrow_move_ok) -> T { return dump_ok(); }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_err_ptr() -> error_t* { return is_err() ? &_err.val() : nullptr; }
+template <class U, class>
+constexpr auto Result<T, E>::unwrap_or(U&& alt) && noexcept(nothrow_move_ok && std::is_nothrow_constructible_v<T, U&&>)
+  -> T
+{
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return dump_ok(); }
+  else                             { return static_cast<T>(std::forward<U>(alt)); }
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_err_ptr() const -> const error_t* { return is_err() ? &_err.val() : nullptr; }
+template <class F>
+constexpr auto Result<T, E>::unwrap_or_else(F&& alt_func) && noexcept(nothrow_move_ok && nothrow_call<F, E>) -> T {
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return dump_ok(); }
+  else                             { return unvoid_call(std::forward<F>(alt_func), forward_err()); }
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator==(const self_t& other) const -> bool {
-  if (is_ok()) {
-    return other.is_ok() ? (_ok.val() == other._ok.val()) : false;
-  } else {
-    return other.is_err() ? (_err.val() == other._err.val()) : false;
-  }
+constexpr auto Result<T, E>::unwrap_err() && noexcept(nothrow_move_err) -> E { return dump_err(); }
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+constexpr auto Result<T, E>::unwrap_unchecked() && noexcept(nothrow_move_ok) -> T {
+  FUN_ASSUME(is_ok(), "Result::unwrap_unchecked called on an Err Result");
+  return _inner.dump_ok();
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::operator!=(const self_t& other) const -> bool { return !(*this == other); }
+constexpr auto Result<T, E>::unwrap_err_unchecked() && noexcept(nothrow_move_err) -> E {
+  FUN_ASSUME(is_err(), "Result::unwrap_err_unchecked called on an Ok Result");
+  return _inner.dump_err();
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::unwrap() && -> T { return dump_ok(); }
+constexpr auto Result<T, E>::as_ref() noexcept -> Result<value_t&, error_ref_t> {
+  if (is_ok()) { return { OkTag{}, ForwardArgs{}, _inner.ok_val() }; }
+  else         { return { ErrTag{}, ForwardArgs{}, _inner.err_val() }; }
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::unwrap_or(T alt) && -> T {
-  if (is_ok()) { return dump_ok(); }
-  else         { return std::forward<T>(alt); }
+constexpr auto Result<T, E>::as_ref() const noexcept -> Result<const value_t&, error_cref_t> {
+  if (is_ok()) { return { OkTag{}, ForwardArgs{}, _inner.ok_val() }; }
+  else         { return { ErrTag{}, ForwardArgs{}, _inner.err_val() }; }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-template <class F>
-auto Result<T, E>::unwrap_or_else(F&& alt_func) && -> T {
-  return std::move(*this).match(
-    [](T&& x) -> T { return std::forward<T>(x); },
-    [&](E&& err) -> T { return unvoid_call(std::forward<F>(alt_func), std::forward<E>(err)); }
-  );
+constexpr auto Result<T, E>::as_cref() const noexcept -> Result<const value_t&, error_cref_t> {
+  return as_ref();
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::unwrap_err() && -> E { return dump_err(); }
+template <typename ...Args>
+constexpr auto Result<T, E>::emplace_ok(Args&& ...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+  -> self_t&
+{
+  _inner.emplace_ok(std::forward<Args>(args)...);
+  return *this;
+}
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_ref() -> Result<value_t&, error_t&> {
-  if (is_ok()) { return { OkTag{}, ForwardArgs{}, _ok.val() }; }
-  else         { return { ErrTag{}, ForwardArgs{}, _err.val() }; }
+template <typename ...Args>
+constexpr auto Result<T, E>::emplace_err(Args&& ...args) noexcept(std::is_nothrow_constructible_v<E, Args&&...>)
+  -> self_t&
+{
+  _inner.emplace_err(std::forward<Args>(args)...);
+  return *this;
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_ref() const -> Result<const value_t&, const error_t&> {
-  if (is_ok()) { return { OkTag{}, ForwardArgs{}, _ok.val() }; }
-  else         { return { ErrTag{}, ForwardArgs{}, _err.val() }; }
+constexpr auto Result<T, E>::replace(self_t other) noexcept(nothrow_move_ok && nothrow_move_err) -> self_t {
+  swap(other);
+  return other;
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::as_cref() const -> Result<const value_t&, const error_t&> {
-  return as_ref();
+constexpr void Result<T, E>::swap(self_t& other) noexcept(
+  nothrow_move_ok && nothrow_move_err && std::is_nothrow_swappable_v<T> && std::is_nothrow_swappable_v<E>
+) {
+  using std::swap;
+  // Swapping reference payloads would swap their referents
+  if constexpr (!std::is_reference_v<T> && std::is_swappable_v<T>) {
+    if (is_ok() && other.is_ok()) {
+      swap(_inner.ok_val(), other._inner.ok_val());
+      return;
+    }
+  }
+  if constexpr (!std::is_reference_v<E> && std::is_swappable_v<E> && ResultUnion<T, E>::is_err_addressable) {
+    if (is_err() && other.is_err()) {
+      swap(_inner.err_val(), other._inner.err_val());
+      return;
+    }
+  }
+  auto tmp = std::move(other);
+  other = std::move(*this);
+  *this = std::move(tmp);
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::ok() && -> Option<T> {
-  if (is_ok()) { return Option<T>{ ForwardArgs{}, dump_ok() }; }
-  else         { return {}; }
+constexpr void swap(Result<T, E>& a, Result<T, E>& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+constexpr auto Result<T, E>::ok() && noexcept(nothrow_move_ok) -> Option<T> {
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return Option<T>{ ForwardArgs{}, forward_ok() }; }
+  else                             { return {}; }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
-auto Result<T, E>::err() && -> Option<E> {
-  if (is_err()) { return Option<E>{ ForwardArgs{}, dump_err() }; }
+constexpr auto Result<T, E>::err() && noexcept(nothrow_move_err) -> Option<E> {
+  if (is_err()) { return Option<E>{ ForwardArgs{}, forward_err() }; }
   else          { return {}; }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename OkFunc, typename ErrFunc>
-auto Result<T, E>::match(OkFunc&& func_ok, ErrFunc&& func_err) && -> MatchReturn<OkFunc> {
+constexpr auto Result<T, E>::match(OkFunc&& func_ok, ErrFunc&& func_err) &&
+  noexcept(nothrow_call<OkFunc, T> && nothrow_call<ErrFunc, E>) -> MatchReturn<OkFunc>
+{
   static_assert(
     std::is_same_v<std::invoke_result_t<OkFunc, T>, std::invoke_result_t<ErrFunc, E>>
     , "Ok-handling and Err-handling functions passed to match do not "
       "have the same return type"
     );
-  if (is_ok()) { return unvoid_call(std::forward<OkFunc>(func_ok), dump_ok()); }
-  else         { return unvoid_call(std::forward<ErrFunc>(func_err), dump_err()); }
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return unvoid_call(std::forward<OkFunc>(func_ok), forward_ok()); }
+  else                             { return unvoid_call(std::forward<ErrFunc>(func_err), forward_err()); }
+}
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+template <typename U, typename F>
+constexpr auto Result<T, E>::map_or(U default_val, F&& func) &&
+  noexcept(nothrow_call<F, T> && std::is_nothrow_move_constructible_v<U>) -> U
+{
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return unvoid_call(std::forward<F>(func), forward_ok()); }
+  else                             { return std::forward<U>(default_val); }
+}
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+template <typename DefaultFunc, typename F>
+constexpr auto Result<T, E>::map_or_else(DefaultFunc&& default_func, F&& func) &&
+  noexcept(nothrow_call<F, T> && nothrow_call<DefaultFunc, E>) -> MatchReturn<F>
+{
+  if (FUN_SUCCESS_BRANCH(is_ok())) { return unvoid_call(std::forward<F>(func), forward_ok()); }
+  else                             { return unvoid_call(std::forward<DefaultFunc>(default_func), forward_err()); }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename F>
-auto Result<T, E>::map(F&& func) && -> MapReturn<F> {
-  if (is_ok()) { return { OkTag{}, ForwardArgs{}, unvoid_call(std::forward<F>(func), dump_ok()) }; }
-  else         { return { ErrTag{}, ForwardArgs{}, dump_err() }; }
+constexpr auto Result<T, E>::map(F&& func) && noexcept(nothrow_call<F, T> && nothrow_move_err) -> MapReturn<F> {
+  if (is_ok()) { return { OkTag{}, ForwardArgs{}, unvoid_call(std::forward<F>(func), forward_ok()) }; }
+  else         { return { ErrTag{}, ForwardArgs{}, forward_err() }; }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename F>
-auto Result<T, E>::map_err(F&& func) && -> ErrMapReturn<F> {
-  if (is_err()) { return { ErrTag{}, ForwardArgs{}, unvoid_call(std::forward<F>(func), dump_err()) }; }
-  else          { return { OkTag{}, ForwardArgs{}, dump_ok() }; }
+constexpr auto Result<T, E>::map_err(F&& func) && noexcept(nothrow_call<F, E> && nothrow_move_ok) -> ErrMapReturn<F> {
+  if (is_err()) { return { ErrTag{}, ForwardArgs{}, unvoid_call(std::forward<F>(func), forward_err()) }; }
+  else          { return { OkTag{}, ForwardArgs{}, forward_ok() }; }
+}
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+template <typename A, typename F>
+constexpr auto Result<T, E>::map(std::allocator_arg_t, const A& alloc, F&& func) && -> MapReturn<F> {
+  if (is_ok()) {
+    auto&& value = unvoid_call(std::forward<F>(func), forward_ok());
+    return MapReturn<F>(std::allocator_arg, alloc, OkTag{}, ForwardArgs{}, std::forward<decltype(value)>(value));
+  } else {
+    return MapReturn<F>(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, forward_err());
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+template <typename A, typename F>
+constexpr auto Result<T, E>::map_err(std::allocator_arg_t, const A& alloc, F&& func) && -> ErrMapReturn<F> {
+  if (is_err()) {
+    auto&& error = unvoid_call(std::forward<F>(func), forward_err());
+    return ErrMapReturn<F>(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, std::forward<decltype(error)>(error));
+  } else {
+    return ErrMapReturn<F>(std::allocator_arg, alloc, OkTag{}, ForwardArgs{}, forward_ok());
+  }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename U>
-auto Result<T, E>::
-zip(Result<U, E> other) && -> Result<std::pair<T, U>, E> {
+constexpr auto Result<T, E>::
+zip(Result<U, E> other) && noexcept(nothrow_move_ok && nothrow_move_err && std::is_nothrow_move_constructible_v<U>)
+  -> Result<std::pair<T, U>, E>
+{
   if (this->is_ok() && other.is_ok()) {
-    return fun::make_ok(std::move(*this).unwrap(), std::move(other).unwrap());
+    return fun::make_ok(forward_ok(), other.forward_ok());
   } else if (this->is_ok()) {
-    return fun::make_err(std::move(other).unwrap_err());
+    return fun::make_err(other.forward_err());
   } else {
-    return fun::make_err(std::move(*this).unwrap_err());
+    return fun::make_err(forward_err());
   }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename F /* T -> Result<U, E> */>
-auto Result<T, E>::and_then(F&& func) && -> AndThenReturn<F> {
-    if (is_ok()) { return unvoid_call(std::forward<F>(func), dump_ok()); }
-    else         { return { ErrTag{}, ForwardArgs{}, dump_err() }; }
+constexpr auto Result<T, E>::and_then(F&& func) && noexcept(nothrow_call<F, T> && nothrow_move_err) -> AndThenReturn<F> {
+    if (is_ok()) { return unvoid_call(std::forward<F>(func), forward_ok()); }
+    else         { return { ErrTag{}, ForwardArgs{}, forward_err() }; }
+}
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+template <typename A, typename F /* T -> Result<U, E> */>
+constexpr auto Result<T, E>::and_then(std::allocator_arg_t, const A& alloc, F&& func) && -> AndThenReturn<F> {
+  if (is_ok()) { return AndThenReturn<F>(std::allocator_arg, alloc, unvoid_call(std::forward<F>(func), forward_ok())); }
+  else         { return AndThenReturn<F>(std::allocator_arg, alloc, ErrTag{}, ForwardArgs{}, forward_err()); }
 }
 
 //------------------------------------------------------------------------------
 template <class T, class E>
 template <typename F>
-auto Result<T, E>::or_else(F&& alt_func) && -> OrElseReturn<F> {
-  if (is_ok()) { return { OkTag{}, ForwardArgs{}, dump_ok() }; }
-    else       { return unvoid_call(std::forward<F>(alt_func), dump_err()); }
+constexpr auto Result<T, E>::or_else(F&& alt_func) && noexcept(nothrow_call<F, E> && nothrow_move_ok) -> OrElseReturn<F> {
+  if (is_ok()) { return { OkTag{}, ForwardArgs{}, forward_ok() }; }
+    else       { return unvoid_call(std::forward<F>(alt_func), forward_err()); }
 }
 
 }
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <fun/niche.h>
+#include <fun/type_support.h>
+
+namespace fun {
+
+struct OkTag {};
+struct ErrTag {};
+
+//------------------------------------------------------------------------------
+template <class T, class E, bool = are_trivially_destructible_v<Sized<T>, Sized<E>>>
+union FUN_TRIVIAL_ABI ResultCell {
+  Unit _empty;
+  Sized<T> _ok;
+  Sized<E> _err;
+
+  constexpr ResultCell() : _empty() {}
+
+  template <typename ...Args>
+  constexpr explicit ResultCell(OkTag, Args&& ...args) : _ok(std::forward<Args>(args)...) {}
+
+  template <typename ...Args>
+  constexpr explicit ResultCell(ErrTag, Args&& ...args) : _err(std::forward<Args>(args)...) {}
+};
+
+template <class T, class E>
+union FUN_TRIVIAL_ABI ResultCell<T, E, false> {
+  Unit _empty;
+  Sized<T> _ok;
+  Sized<E> _err;
+
+  constexpr ResultCell() : _empty() {}
+
+  template <typename ...Args>
+  constexpr explicit ResultCell(OkTag, Args&& ...args) : _ok(std::forward<Args>(args)...) {}
+
+  template <typename ...Args>
+  constexpr explicit ResultCell(ErrTag, Args&& ...args) : _err(std::forward<Args>(args)...) {}
+
+  FUN_CONSTEXPR_DTOR ~ResultCell() {}
+};
+
+//------------------------------------------------------------------------------
+// Tagged storage for ResultUnion, its special members are supplied by
+// `SpecialMembers` so that they are trivial whenever those of `T` and `E` are.
+template <class T, class E>
+class FUN_TRIVIAL_ABI ResultStorage {
+  using Self = ResultStorage;
+
+  // `Valueless` is only observable transiently, while a non-trivial special
+  // member of ResultUnion replaces the contents, or after constructing a new
+  // payload in place has thrown (see `emplace_into`)
+  enum class Tag: std::uint8_t { Ok, Err, Valueless, Niche };
+  Tag _variant;
+  ResultCell<T, E> _cell;
+
+protected:
+  constexpr ResultStorage() : _variant(Tag::Valueless) {}
+
+  constexpr void erase() {
+    if (_variant == Tag::Ok)       { fun::destroy_at(std::addressof(_cell._ok)); }
+    else if (_variant == Tag::Err) { fun::destroy_at(std::addressof(_cell._err)); }
+    _variant = Tag::Valueless;
+  }
+
+  constexpr void construct_from(const Self& other) {
+    if (other._variant == Tag::Ok) {
+      fun::construct_at(std::addressof(_cell._ok), other._cell._ok.val());
+    } else if (other._variant == Tag::Err) {
+      fun::construct_at(std::addressof(_cell._err), other._cell._err.val());
+    }
+    _variant = other._variant;
+  }
+
+  constexpr void construct_from(Self&& other) {
+    if (other._variant == Tag::Ok) {
+      fun::construct_at(std::addressof(_cell._ok), std::move(other._cell._ok));
+    } else if (other._variant == Tag::Err) {
+      fun::construct_at(std::addressof(_cell._err), std::move(other._cell._err));
+    }
+    _variant = other._variant;
+  }
+
+  constexpr void assign_from(const Self& other) {
+    if constexpr (std::is_copy_assignable_v<Sized<T>>) {
+      if (_variant == Tag::Ok && other._variant == Tag::Ok) {
+        _cell._ok = other._cell._ok;
+        return;
+      }
+    }
+    if constexpr (std::is_copy_assignable_v<Sized<E>>) {
+      if (_variant == Tag::Err && other._variant == Tag::Err) {
+        _cell._err = other._cell._err;
+        return;
+      }
+    }
+    erase();
+    construct_from(other);
+  }
+
+  constexpr void assign_from(Self&& other) {
+    if constexpr (std::is_move_assignable_v<Sized<T>>) {
+      if (_variant == Tag::Ok && other._variant == Tag::Ok) {
+        _cell._ok = std::move(other._cell._ok);
+        return;
+      }
+    }
+    if constexpr (std::is_move_assignable_v<Sized<E>>) {
+      if (_variant == Tag::Err && other._variant == Tag::Err) {
+        _cell._err = std::move(other._cell._err);
+        return;
+      }
+    }
+    erase();
+    construct_from(std::move(other));
+  }
+
+  // Replaces the contents in place. As with `std::variant::emplace`, a
+  // trivially copyable payload whose construction may throw is built aside
+  // first, so that a throw leaves the old contents untouched. Any other
+  // payload is built in place, and a throw leaves the storage valueless.
+  template <class P, class Slot, typename ...Args>
+  constexpr void emplace_into(Slot& slot, const Tag variant, Args&& ...args) {
+    if constexpr (!std::is_nothrow_constructible_v<Sized<P>, Args&&...> && std::is_trivially_copyable_v<Sized<P>>) {
+      auto tmp = Sized<P>(std::forward<Args>(args)...);
+      erase();
+      fun::construct_at(std::addressof(slot), std::move(tmp));
+    } else {
+      erase();
+      fun::construct_at(std::addressof(slot), std::forward<Args>(args)...);
+    }
+    _variant = variant;
+  }
+
+public:
+  static constexpr bool is_err_addressable = true;
+
+  // Tag values from Niche on are lent out to enclosing Options and Results
+  static constexpr std::size_t niche_count = 253;
+
+  constexpr ResultStorage(NicheTag, const std::size_t i)
+    : _variant(static_cast<Tag>(static_cast<std::size_t>(Tag::Niche) + i))
+  {}
+
+  constexpr bool is_niche(const std::size_t i) const {
+    return _variant == static_cast<Tag>(static_cast<std::size_t>(Tag::Niche) + i);
+  }
+
+  template <typename ...Args>
+  constexpr explicit ResultStorage(OkTag, ForwardArgs, Args&& ...args)
+    : _variant(Tag::Ok)
+    , _cell(OkTag{}, std::forward<Args>(args)...)
+  {}
+
+  template <typename ...Args>
+  constexpr explicit ResultStorage(ErrTag, ForwardArgs, Args&& ...args)
+    : _variant(Tag::Err)
+    , _cell(ErrTag{}, std::forward<Args>(args)...)
+  {}
+
+  constexpr bool is_ok() const { return _variant == Tag::Ok; }
+
+  constexpr auto ok_val() -> std::remove_reference_t<T>& { return _cell._ok.val(); }
+  constexpr auto ok_val() const -> const std::remove_reference_t<T>& { return _cell._ok.val(); }
+
+  constexpr auto err_val() -> std::remove_reference_t<E>& { return _cell._err.val(); }
+  constexpr auto err_val() const -> const std::remove_reference_t<E>& { return _cell._err.val(); }
+
+  // ** only call on `Ok` variant, otherwise undefined behavior **
+  constexpr T dump_ok() { return std::move(_cell._ok).unwrap(); }
+
+  // ** only call on `Err` variant, otherwise undefined behavior **
+  constexpr E dump_err() { return std::move(_cell._err).unwrap(); }
+
+  template <typename ...Args>
+  constexpr void emplace_ok(Args&& ...args) { emplace_into<T>(_cell._ok, Tag::Ok, std::forward<Args>(args)...); }
+
+  template <typename ...Args>
+  constexpr void emplace_err(Args&& ...args) { emplace_into<E>(_cell._err, Tag::Err, std::forward<Args>(args)...); }
+};
+
+//------------------------------------------------------------------------------
+/**
+ * A type that carries no state: an empty, trivially constructible and copyable class that can therefore be stored as
+ * an (elided) empty base, regardless of which alternative is active.
+ */
+template <class T>
+constexpr bool is_stateless_v =
+  std::is_empty_v<T> && !std::is_final_v<T> &&
+  std::is_trivially_default_constructible_v<T> && std::is_trivially_copyable_v<T>;
+
+template <class T, class = void>
+struct PointeeAlignment : std::integral_constant<std::size_t, 1> {};
+
+template <class T>
+struct PointeeAlignment<T*, std::enable_if_t<std::is_object_v<T> && (sizeof(T) > 0)>>
+  : std::integral_constant<std::size_t, alignof(T)> {};
+
+//------------------------------------------------------------------------------
+/**
+ * Opt-in for `ResultLayout::Pointer`: specialize as `std::true_type` to store a `Result<T*, E*>` of pointers to aligned
+ * objects as a single pointer. Such a Result can then only provide its error by value, i.e. `as_err_ptr()` is not
+ * available and `as_ref()` refers to the value but copies the error.
+ */
+template <class T, class E>
+struct EnablePointerPacking : std::false_type {};
+
+enum class ResultLayout {
+  // a one byte tag next to a union of both alternatives
+  Tagged,
+  // only a tag, both alternatives are stateless empty bases
+  Stateless,
+  // one alternative is stateless and is represented by a reserved niche of
+  // the other (see `NicheTraits`)
+  Niche,
+  // both alternatives are pointers to aligned objects and the tag is the low
+  // bit of the pointer, only when enabled by `EnablePointerPacking`
+  Pointer,
+};
+
+template <class T, class E>
+constexpr ResultLayout result_layout_v =
+  (is_stateless_v<T> && is_stateless_v<E> && (std::is_same_v<T, E> || !(std::is_base_of_v<T, E> || std::is_base_of_v<E, T>)))
+    ? ResultLayout::Stateless
+  : ((is_stateless_v<T> && !is_stateless_v<E> && has_reserved_niche_v<E>) ||
+     (is_stateless_v<E> && !is_stateless_v<T> && has_reserved_niche_v<T>))
+    ? ResultLayout::Niche
+  : (EnablePointerPacking<T, E>::value && PointeeAlignment<T>::value >= 2 && PointeeAlignment<E>::value >= 2)
+    ? ResultLayout::Pointer
+  : ResultLayout::Tagged;
+
+//------------------------------------------------------------------------------
+template <class T, class E, ResultLayout = result_layout_v<T, E>>
+class ResultUnion;
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+class FUN_TRIVIAL_ABI ResultUnion<T, E, ResultLayout::Tagged>
+  : public SpecialMembers<ResultStorage<T, E>, Sized<T>, Sized<E>>
+{
+  using Base = SpecialMembers<ResultStorage<T, E>, Sized<T>, Sized<E>>;
+public:
+  using Base::Base;
+};
+
+//------------------------------------------------------------------------------
+template <class T, class E, bool = std::is_same_v<T, E>>
+struct StatelessPair : T, E {
+  constexpr T& ok_base() { return *this; }
+  constexpr const T& ok_base() const { return *this; }
+  constexpr E& err_base() { return *this; }
+  constexpr const E& err_base() const { return *this; }
+};
+
+template <class T, class E>
+struct StatelessPair<T, E, true> : T {
+  constexpr T& ok_base() { return *this; }
+  constexpr const T& ok_base() const { return *this; }
+  constexpr E& err_base() { return *this; }
+  constexpr const E& err_base() const { return *this; }
+};
+
+template <class T, class E>
+class FUN_TRIVIAL_ABI ResultUnion<T, E, ResultLayout::Stateless> : StatelessPair<T, E> {
+  enum class Tag: std::uint8_t { Ok, Err, Niche };
+  Tag _variant;
+public:
+  static constexpr bool is_err_addressable = true;
+
+  // Tag values from Niche on are lent out to enclosing Options and Results
+  static constexpr std::size_t niche_count = 254;
+
+  constexpr ResultUnion(NicheTag, const std::size_t i)
+    : _variant(static_cast<Tag>(static_cast<std::size_t>(Tag::Niche) + i))
+  {}
+
+  constexpr bool is_niche(const std::size_t i) const {
+    return _variant == static_cast<Tag>(static_cast<std::size_t>(Tag::Niche) + i);
+  }
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(OkTag, ForwardArgs, Args&& ...args)
+    : _variant(Tag::Ok)
+  {
+    // Constructing a temporary and throwing it away replicates the
+    // observable compile-time behavior of constructing the alternative
+    void(T(std::forward<Args>(args)...));
+  }
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(ErrTag, ForwardArgs, Args&& ...args)
+    : _variant(Tag::Err)
+  {
+    void(E(std::forward<Args>(args)...));
+  }
+
+  constexpr bool is_ok() const { return _variant == Tag::Ok; }
+
+  constexpr auto ok_val() -> T& { return this->ok_base(); }
+  constexpr auto ok_val() const -> const T& { return this->ok_base(); }
+
+  constexpr auto err_val() -> E& { return this->err_base(); }
+  constexpr auto err_val() const -> const E& { return this->err_base(); }
+
+  constexpr T dump_ok() { return this->ok_base(); }
+
+  constexpr E dump_err() { return this->err_base(); }
+
+  template <typename ...Args>
+  constexpr void emplace_ok(Args&& ...args) {
+    void(T(std::forward<Args>(args)...));
+    _variant = Tag::Ok;
+  }
+
+  template <typename ...Args>
+  constexpr void emplace_err(Args&& ...args) {
+    void(E(std::forward<Args>(args)...));
+    _variant = Tag::Err;
+  }
+};
+
+//------------------------------------------------------------------------------
+template <class T, class E>
+class FUN_TRIVIAL_ABI ResultUnion<T, E, ResultLayout::Niche>
+  : std::conditional_t<is_stateless_v<T>, T, E>
+{
+  static constexpr bool ok_is_stateless = is_stateless_v<T>;
+
+  using Stateless = std::conditional_t<ok_is_stateless, T, E>;
+  using Dense = std::conditional_t<ok_is_stateless, E, T>;
+  using Niche = NicheTraits<Dense>;
+
+  struct StatelessTag {};
+  struct DenseTag {};
+
+  using OkAlternative = std::conditional_t<ok_is_stateless, StatelessTag, DenseTag>;
+  using ErrAlternative = std::conditional_t<ok_is_stateless, DenseTag, StatelessTag>;
+
+  Dense _dense;
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(StatelessTag, Args&& ...args)
+    : Stateless(std::forward<Args>(args)...)
+    , _dense(Niche::make(0))
+  {}
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(DenseTag, Args&& ...args)
+    : Stateless()
+    , _dense(std::forward<Args>(args)...)
+  {}
+
+  constexpr bool is_dense() const { return !Niche::is(_dense, 0); }
+
+  constexpr Stateless& stateless() { return *this; }
+  constexpr const Stateless& stateless() const { return *this; }
+
+public:
+  static constexpr bool is_err_addressable = true;
+
+  // The remaining niches of the dense alternative are passed on to enclosing
+  // Options and Results
+  static constexpr std::size_t niche_count = Niche::count - 1;
+
+  constexpr ResultUnion(NicheTag, const std::size_t i)
+    : Stateless()
+    , _dense(Niche::make(i + 1))
+  {}
+
+  constexpr bool is_niche(const std::size_t i) const { return Niche::is(_dense, i + 1); }
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(OkTag, ForwardArgs, Args&& ...args)
+    : ResultUnion(OkAlternative{}, std::forward<Args>(args)...)
+  {}
+
+  template <typename ...Args>
+  constexpr explicit ResultUnion(ErrTag, ForwardArgs, Args&& ...args)
+    : ResultUnion(ErrAlternative{}, std::forward<Args>(args)...)
+  {}
+
+  constexpr bool is_ok() const { return ok_is_stateless != is_dense(); }
+
+  constexpr auto ok_val() -> T& {
+    if constexpr (ok_is_stateless) { return stateless(); } else { return _dense; }
+  }
+  constexpr auto ok_val() const -> const T& {
+    if constexpr (ok_is_stateless) { return stateless(); } else { return _dense; }
+  }
+
+  constexpr auto err_val() -> E& {
+    if constexpr (ok_is_stateless) { return _dense; } else { return stateless(); }
+  }
+  constexpr auto err_val() const -> const E& {
+    if constexpr (ok_is_stateless) { return _dense; } else { return stateless(); }
+  }
+
+  constexpr T dump_ok() { return std::move(ok_val()); }
+
+  constexpr E dump_err() { return std::move(err_val()); }
+
+  // The dense alternative is cheap to move, like the pointers and Options
+  // that provide niches
+  template <typename ...Args>
+  constexpr void emplace_ok(Args&& ...args) { *this = ResultUnion(OkAlternative{}, std::forward<Args>(args)...); }
+
+  template <typename ...Args>
+  constexpr void emplace_err(Args&& ...args) { *this = ResultUnion(ErrAlternative{}, std::forward<Args>(args)...); }
+};
+
+//------------------------------------------------------------------------------
+// The `Err` pointer is stored with its (otherwise always clear) low bit set,
+// so unlike the other layouts the error is only available by value. Tagging
+// the pointer needs `reinterpret_cast`, so this layout is never usable in
+// constant expressions.
+template <class T, class E>
+class FUN_TRIVIAL_ABI ResultUnion<T, E, ResultLayout::Pointer> {
+  T _ptr;
+
+  static constexpr std::uintptr_t err_bit = 1;
+
+  std::uintptr_t bits() const { return reinterpret_cast<std::uintptr_t>(_ptr); }
+public:
+  static constexpr bool is_err_addressable = false;
+
+  static constexpr std::size_t niche_count = 0;
+
+  template <typename ...Args>
+  explicit ResultUnion(OkTag, ForwardArgs, Args&& ...args)
+    : _ptr{ std::forward<Args>(args)... }
+  {}
+
+  template <typename ...Args>
+  explicit ResultUnion(ErrTag, ForwardArgs, Args&& ...args)
+    : _ptr(reinterpret_cast<T>(reinterpret_cast<std::uintptr_t>(E{ std::forward<Args>(args)... }) | err_bit))
+  {}
+
+  bool is_ok() const { return (bits() & err_bit) == 0; }
+
+  auto ok_val() -> T& { return _ptr; }
+  auto ok_val() const -> const T& { return _ptr; }
+
+  auto err_val() const -> E { return reinterpret_cast<E>(bits() & ~err_bit); }
+
+  T dump_ok() { return _ptr; }
+
+  E dump_err() { return err_val(); }
+
+  template <typename ...Args>
+  void emplace_ok(Args&& ...args) { *this = ResultUnion(OkTag{}, ForwardArgs{}, std::forward<Args>(args)...); }
+
+  template <typename ...Args>
+  void emplace_err(Args&& ...args) { *this = ResultUnion(ErrTag{}, ForwardArgs{}, std::forward<Args>(args)...); }
+};
+
+}
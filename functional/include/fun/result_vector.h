@@ -0,0 +1,208 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fun/bitmap.h>
+#include <fun/result.h>
+
+namespace fun {
+
+//!
+//! ResultVector type
+//!
+//! A columnar batch of `Result<T, E>` for workloads where errors are rare:
+//! Ok values are kept in a dense array next to a packed Ok mask, while
+//! errors are stored sparsely as (row, error) entries sorted by row. Each
+//! row therefore costs `sizeof(T)` plus one bit, and only failed rows pay
+//! for their error. Err rows hold a value-initialized `T` in the dense
+//! array.
+//!
+//! Rows are accessed as `Result<T&, E&>` views, in the style of
+//! `Result::as_ref`.
+//!
+template <class T, class E>
+class ResultVector {
+  static_assert(!std::is_reference_v<T> && !std::is_reference_v<E>, "ResultVector cannot hold references");
+  static_assert(std::is_default_constructible_v<T>, "ResultVector requires a default constructible value type");
+  static_assert(!std::is_same_v<T, bool>, "ResultVector<bool, E> is not supported");
+
+public:
+  using self_t = ResultVector<T, E>;
+  using value_t = T;
+  using error_t = E;
+
+  //! A failed row and its error
+  using ErrEntry = std::pair<std::size_t, E>;
+
+private:
+  std::vector<T> _oks;
+  Bitmap _ok_mask;
+  std::vector<ErrEntry> _errs;
+
+  auto find_err(const std::size_t i) const -> typename std::vector<ErrEntry>::const_iterator {
+    return std::lower_bound(
+      _errs.begin(), _errs.end(), i, [](const ErrEntry& entry, const std::size_t row) { return entry.first < row; }
+    );
+  }
+
+  auto find_err(const std::size_t i) -> typename std::vector<ErrEntry>::iterator {
+    return _errs.begin() + (std::as_const(*this).find_err(i) - _errs.cbegin());
+  }
+
+public:
+  ResultVector() = default;
+
+  explicit ResultVector(const std::vector<Result<T, E>>& results) {
+    reserve(results.size());
+    for (const auto& res : results) { push_back(res.clone()); }
+  }
+
+  explicit ResultVector(std::vector<Result<T, E>>&& results) {
+    reserve(results.size());
+    for (auto& res : results) { push_back(std::move(res)); }
+  }
+
+  auto to_results() const& -> std::vector<Result<T, E>> {
+    auto results = std::vector<Result<T, E>>();
+    results.reserve(size());
+    auto err = _errs.begin();
+    for (auto i = std::size_t{0}; i < size(); ++i) {
+      if (is_ok(i)) { results.emplace_back(OkTag{}, ForwardArgs{}, _oks[i]); }
+      else          { results.emplace_back(ErrTag{}, ForwardArgs{}, (err++)->second); }
+    }
+    return results;
+  }
+
+  auto to_results() && -> std::vector<Result<T, E>> {
+    auto results = std::vector<Result<T, E>>();
+    results.reserve(size());
+    auto err = _errs.begin();
+    for (auto i = std::size_t{0}; i < size(); ++i) {
+      if (is_ok(i)) { results.emplace_back(OkTag{}, ForwardArgs{}, std::move(_oks[i])); }
+      else          { results.emplace_back(ErrTag{}, ForwardArgs{}, std::move((err++)->second)); }
+    }
+    clear();
+    return results;
+  }
+
+  auto size() const -> std::size_t { return _oks.size(); }
+  auto empty() const -> bool { return _oks.empty(); }
+
+  auto count_ok() const -> std::size_t { return size() - count_err(); }
+  auto count_err() const -> std::size_t { return _errs.size(); }
+
+  //! Reserves room for `n` rows, errors are not reserved for
+  void reserve(const std::size_t n) {
+    _oks.reserve(n);
+    _ok_mask.reserve(n);
+  }
+
+  void clear() {
+    _oks.clear();
+    _ok_mask.clear();
+    _errs.clear();
+  }
+
+  auto is_ok(const std::size_t i) const -> bool { return _ok_mask.test(i); }
+  auto is_err(const std::size_t i) const -> bool { return !is_ok(i); }
+
+  auto operator[](const std::size_t i) -> Result<T&, E&> {
+    if (is_ok(i)) { return { OkTag{}, ForwardArgs{}, _oks[i] }; }
+    else          { return { ErrTag{}, ForwardArgs{}, find_err(i)->second }; }
+  }
+
+  auto operator[](const std::size_t i) const -> Result<const T&, const E&> {
+    if (is_ok(i)) { return { OkTag{}, ForwardArgs{}, _oks[i] }; }
+    else          { return { ErrTag{}, ForwardArgs{}, find_err(i)->second }; }
+  }
+
+  void set(const std::size_t i, Result<T, E> res) {
+    if (res.is_ok()) {
+      if (is_err(i)) { _errs.erase(find_err(i)); }
+      _oks[i] = std::move(res).unwrap();
+      _ok_mask.set(i, true);
+    } else {
+      if (is_err(i)) { find_err(i)->second = std::move(res).unwrap_err(); }
+      else           { _errs.emplace(find_err(i), i, std::move(res).unwrap_err()); }
+      _oks[i] = T();
+      _ok_mask.set(i, false);
+    }
+  }
+
+  void push_back(Result<T, E> res) {
+    if (res.is_ok()) { push_ok(std::move(res).unwrap()); }
+    else             { push_err(std::move(res).unwrap_err()); }
+  }
+
+  void push_ok(T val) {
+    _oks.push_back(std::move(val));
+    _ok_mask.push_back(true);
+  }
+
+  void push_err(E err) {
+    _errs.emplace_back(size(), std::move(err));
+    _oks.emplace_back();
+    _ok_mask.push_back(false);
+  }
+
+  //! The dense value array, Err rows hold a value-initialized `T`
+  auto values() const -> const std::vector<T>& { return _oks; }
+
+  auto ok_mask() const -> const Bitmap& { return _ok_mask; }
+
+  //! Iterable over the Ok values, skipping Err rows
+  auto oks() -> SetBitRange<T> { return { _oks.data(), &_ok_mask }; }
+  auto oks() const -> SetBitRange<const T> { return { _oks.data(), &_ok_mask }; }
+
+  //! The failed rows and their errors, ordered by row
+  auto errs() const -> const std::vector<ErrEntry>& { return _errs; }
+
+  auto first_err() const -> Option<const ErrEntry&> {
+    if (_errs.empty()) { return {}; }
+    else               { return some_ref(_errs.front()); }
+  }
+
+  //! Splits the batch into its Ok values and its errors, each in row order
+  auto partition() const& -> std::pair<std::vector<T>, std::vector<E>> {
+    auto parts = std::pair<std::vector<T>, std::vector<E>>();
+    parts.first.reserve(count_ok());
+    for (const auto& val : oks()) { parts.first.push_back(val); }
+    parts.second.reserve(count_err());
+    for (const auto& entry : _errs) { parts.second.push_back(entry.second); }
+    return parts;
+  }
+
+  auto partition() && -> std::pair<std::vector<T>, std::vector<E>> {
+    auto parts = std::pair<std::vector<T>, std::vector<E>>();
+    if (_errs.empty()) {
+      parts.first = std::move(_oks);
+    } else {
+      parts.first.reserve(count_ok());
+      for (auto& val : oks()) { parts.first.push_back(std::move(val)); }
+      parts.second.reserve(count_err());
+      for (auto& entry : _errs) { parts.second.push_back(std::move(entry.second)); }
+    }
+    clear();
+    return parts;
+  }
+
+  bool operator==(const self_t& other) const {
+    if (_ok_mask != other._ok_mask || _errs != other._errs) { return false; }
+    for (auto i = _ok_mask.find_next(0); i < size(); i = _ok_mask.find_next(i + 1)) {
+      if (!(_oks[i] == other._oks[i])) { return false; }
+    }
+    return true;
+  }
+  bool operator!=(const self_t& other) const { return !(*this == other); }
+};
+
+}
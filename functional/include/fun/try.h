@@ -1,11 +1,16 @@
 #pragma once
 
+#include <type_traits>
+#include <utility>
+
 #include <fun/option.h>
 #include <fun/result.h>
 
 #define FUN_TRY_CHECK_DIVERGE(tmp_id, expr)                                    \
   auto tmp_id = (expr);                                                        \
-  if (!tmp_id) { return ::fun::try_detail::diverge(::std::move(tmp_id)); }
+  if (FUN_FAILURE_BRANCH(!tmp_id)) {                                           \
+    return ::fun::try_detail::diverge(tmp_id);                                 \
+  }
 
 #define FUN_TRY_DECLARE_IMPL(tmp_id, dst_id, expr)                             \
   FUN_TRY_CHECK_DIVERGE(tmp_id, expr);                                         \
@@ -31,13 +36,112 @@
   FUN_TRY_DISCARDING_IMPL1(__COUNTER__, expr)
 
 namespace fun {
+
+//------------------------------------------------------------------------------
+/**
+ * Converts the errors of type `From` that are propagated (by `FUN_TRY` or `co_await`) out of a function returning a
+ * `Result<T, To>`, like Rust's `From`. `convert` returns either a `To` or whatever a `To` is constructed from. By
+ * default, the error is handed over as it is, when it implicitly converts to a `To`.
+ *
+ * Specialize it for errors that know nothing of each other:
+ *
+ *   template <>
+ *   struct fun::ErrorFrom<AppError, ParseError> {
+ *     static auto convert(ParseError&& e) -> AppError { return AppError::parse(e.line); }
+ *   };
+ *
+ * An Option's None is propagated out of a function returning a Result as the error converted from `NothingTag`.
+ */
+template <class To, class From, class = void>
+struct ErrorFrom {};
+
+template <class To, class From>
+struct ErrorFrom<To, From, std::enable_if_t<std::is_convertible_v<From&&, To>>> {
+  static constexpr auto convert(From&& e) noexcept -> From&& { return std::forward<From>(e); }
+};
+
 namespace try_detail {
 
+template <class To, class From, class = void>
+struct is_convertible_err : std::false_type {};
+
+template <class To, class From>
+struct is_convertible_err<To, From, std::void_t<decltype(ErrorFrom<To, From>::convert(std::declval<From&&>()))>>
+  : std::true_type {};
+
+// What the failure of an `X` is propagated as: its error, or `NothingTag` for
+// an Option's None
+template <class X>
+struct Failure;
+
+template <class T>
+struct Failure<Option<T>> { using type = NothingTag; };
+
+template <class T, class E>
+struct Failure<Result<T, E>> { using type = E; };
+
+// The error of `x`, an `X`, as it is to be propagated out of a function
+// returning a `Result<?, To>`
+// ** only call on the `None`/`Err` variants, otherwise undefined behavior **
+template <class To, class X, class V>
+constexpr auto propagated_err(V& x) -> decltype(auto) {
+  using From = typename Failure<std::remove_cv_t<V>>::type;
+  if constexpr (std::is_same_v<From, NothingTag>) {
+    static_assert(is_convertible_err<To, NothingTag>::value,
+                  "An Option is propagated out of a function returning a Result<T, E> only where "
+                  "fun::ErrorFrom<E, fun::NothingTag> converts its None");
+    return To(ErrorFrom<To, NothingTag>::convert(NothingTag{}));
+  } else {
+    static_assert(is_convertible_err<To, From>::value,
+                  "The error type is not convertible, specialize fun::ErrorFrom to convert it");
+    if constexpr (std::is_reference_v<decltype(result_detail::forward_err<X>(x))>) {
+      return ErrorFrom<To, From>::convert(result_detail::forward_err<X>(x));
+    } else {
+      // An error packed into a pointer comes as a temporary, which is not to be referred to past this call
+      return To(ErrorFrom<To, From>::convert(result_detail::forward_err<X>(x)));
+    }
+  }
+}
+
+// The failure of `source`, an `X` or a reference to one, as a `Result<U, F>`.
+// It is built out of line (see `FUN_COLD`), so that converting the error does
+// not weigh on the hot path of the caller.
+template <class U, class F, class X, class Source>
+FUN_COLD constexpr auto diverged_result(Source source) -> Result<U, F> {
+  return Result<U, F>(ErrTag{}, ForwardArgs{}, propagated_err<F, X&&>(source));
+}
+
+// Becomes the failure of the Option or Result returned by the enclosing
+// function. The error of `_source` is converted and moved straight into the
+// return value.
+template <class X>
+class Diverged {
+  X& _source;
+
+  // Passed to `diverged_result` by value, so that it can stay in registers
+  static constexpr bool small_source = std::is_trivially_copyable_v<X> && sizeof(X) <= 2 * sizeof(void*);
+
+public:
+  constexpr explicit Diverged(X& source) noexcept : _source(source) {}
+
+  template <class U>
+  constexpr operator Option<U>() && noexcept {
+    static_assert(std::is_same_v<typename Failure<X>::type, NothingTag>,
+                  "A Result's error cannot be propagated out of a function returning an Option, discard it with ok()");
+    return Option<U>();
+  }
+
+  template <class U, class F>
+  constexpr operator Result<U, F>() && {
+    return diverged_result<U, F, X, std::conditional_t<small_source, X, X&>>(_source);
+  }
+};
+
 template <class T>
-auto diverge(fun::Option<T>&&) { return fun::nothing(); }
+constexpr auto diverge(fun::Option<T>& opt) noexcept { return Diverged<fun::Option<T>>(opt); }
 
 template <class T, class E>
-auto diverge(fun::Result<T, E>&& res) { return fun::err(std::move(res).unwrap_err()); }
+constexpr auto diverge(fun::Result<T, E>& res) noexcept { return Diverged<fun::Result<T, E>>(res); }
 
 } // end namespace try_detail
 } // end namespace fun
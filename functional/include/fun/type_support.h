@@ -1,7 +1,12 @@
 #pragma once
 
-#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
 #include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
 
 namespace fun {
 
@@ -21,17 +26,18 @@ template <class T> struct Sized;
 
 template <class T>
 struct Sized<T&> {
-  std::reference_wrapper<T> _val;
+  T* _ptr;
 
-  Sized(T& ref) : _val(ref) {}
-  Sized(const std::reference_wrapper<T> ref) : _val(ref) {}
+  constexpr Sized(T& ref) : _ptr(std::addressof(ref)) {}
+  constexpr Sized(const std::reference_wrapper<T> ref) : _ptr(std::addressof(ref.get())) {}
 
-  Sized(const Sized<T&>& other) : _val(other._val) {}
+  Sized(const Sized<T&>& other) = default;
+  Sized<T&>& operator=(const Sized<T&>& other) = default;
 
-  auto val() -> T& { return _val; }
-  auto val() const -> const T& { return _val; }
+  constexpr auto val() -> T& { return *_ptr; }
+  constexpr auto val() const -> const T& { return *_ptr; }
 
-  auto unwrap() && -> T& { return _val; }
+  constexpr auto unwrap() && -> T& { return *_ptr; }
 };
 
 template <class T>
@@ -39,13 +45,14 @@ struct Sized {
   T _val;
 
   template <class ...Args>
-  Sized(Args&&... args) : _val(std::forward<Args>(args)...)
+  constexpr Sized(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+    : _val(std::forward<Args>(args)...)
   {}
 
-  auto val() -> T& { return _val; }
-  auto val() const -> const T& { return _val; }
+  constexpr auto val() -> T& { return _val; }
+  constexpr auto val() const -> const T& { return _val; }
 
-  auto unwrap() && -> T { return std::move(_val); }
+  constexpr auto unwrap() && -> T { return std::move(_val); }
 };
 
 //------------------------------------------------------------------------------
@@ -76,22 +83,323 @@ constexpr bool is_safe_reference_convertible_v =
 template <class T, class U>
 using first_t = std::conditional_t<true, T, U>;
 
+//------------------------------------------------------------------------------
+/**
+ * `std::invoke` that is usable in constant expressions before C++20 (only member pointers are routed through
+ * `std::invoke`, which is not constexpr until then).
+ */
+template <class F, class ...Args>
+constexpr auto invoke(F&& f, Args&& ...args) noexcept(std::is_nothrow_invocable_v<F, Args...>)
+  -> std::invoke_result_t<F, Args...>
+{
+  if constexpr (std::is_member_pointer_v<std::decay_t<F>>) {
+    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  } else {
+    return std::forward<F>(f)(std::forward<Args>(args)...);
+  }
+}
+
 //------------------------------------------------------------------------------
 template <class F, class ...Args>
-auto unvoid_call(F&& f, Args&& ...args) -> InvokeResult_t<F, Args...> {
+constexpr auto unvoid_call(F&& f, Args&& ...args) noexcept(std::is_nothrow_invocable_v<F, Args...>)
+  -> InvokeResult_t<F, Args...>
+{
   if constexpr (std::is_same_v<std::invoke_result_t<F, Args...>, void>) {
-    std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    fun::invoke(std::forward<F>(f), std::forward<Args>(args)...);
     return Unit{};
   } else {
-    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    return fun::invoke(std::forward<F>(f), std::forward<Args>(args)...);
   }
 }
 
+//------------------------------------------------------------------------------
+/**
+ * Tests whether neither calling `f` with `args` nor moving its (unvoided) result can throw, i.e. whether a combinator
+ * that hands its payload to `f` and stores what comes back can be `noexcept`.
+ */
+template <class F, class ...Args>
+constexpr bool is_nothrow_unvoid_callable_v =
+  std::is_nothrow_invocable_v<F, Args...> && std::is_nothrow_move_constructible_v<InvokeResult_t<F, Args...>>;
+
+//------------------------------------------------------------------------------
+/**
+ * Constant-evaluation support for non-trivial payloads needs C++20: constexpr destructors and `std::construct_at`.
+ * With C++17, only `Option`s and `Result`s of trivially copyable payloads are usable in constant expressions.
+ */
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define FUN_CONSTEXPR_DTOR constexpr
+#else
+#define FUN_CONSTEXPR_DTOR
+#endif
+
 //------------------------------------------------------------------------------
 template <class T, class... Args>
-auto construct_at(T* location, Args&&... args) -> T& {
+constexpr auto construct_at(T* location, Args&&... args) -> T& {
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+  return *std::construct_at(location, std::forward<Args>(args)...);
+#else
   ::new (static_cast<void*>(location)) T(std::forward<Args>(args)...);
   return *location;
+#endif
+}
+
+template <class T>
+constexpr void destroy_at(T* location) {
+  if constexpr (!std::is_trivially_destructible_v<T>) { location->~T(); }
 }
 
+//------------------------------------------------------------------------------
+/**
+ * The arguments, as a tuple of references, that construct a `T` from `args` with the allocator `alloc` by
+ * uses-allocator construction: `alloc` is passed after `std::allocator_arg`, or else last, if `T` uses allocators of
+ * type `A`, and left out otherwise (like C++20's `std::uses_allocator_construction_args`, pairs aside).
+ */
+template <class T, class A, class ...Args>
+constexpr auto uses_allocator_args(const A& alloc, Args&& ...args) noexcept {
+  if constexpr (!std::uses_allocator_v<std::remove_cv_t<T>, A>) {
+    return std::forward_as_tuple(std::forward<Args>(args)...);
+  } else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, const A&, Args&&...>) {
+    return std::forward_as_tuple(std::allocator_arg, alloc, std::forward<Args>(args)...);
+  } else {
+    static_assert(std::is_constructible_v<T, Args&&..., const A&>, "T uses allocators but takes none from these args");
+    return std::forward_as_tuple(std::forward<Args>(args)..., alloc);
+  }
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Opt-in `[[clang::trivial_abi]]` for the storage of `Option` and `Result`. With it, an `Option`/`Result` whose payloads
+ * are themselves trivial for the purpose of calls (e.g. `std::unique_ptr` under libc++'s trivial ABI) is passed and
+ * returned in registers despite its non-trivial special members. This changes the calling convention, so every
+ * translation unit of a program must agree on `FUN_ENABLE_TRIVIAL_ABI`.
+ */
+#ifndef FUN_ENABLE_TRIVIAL_ABI
+#define FUN_ENABLE_TRIVIAL_ABI 0
+#endif
+
+#if FUN_ENABLE_TRIVIAL_ABI && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::trivial_abi)
+#define FUN_TRIVIAL_ABI [[clang::trivial_abi]]
+#endif
+#endif
+
+#ifndef FUN_TRIVIAL_ABI
+#define FUN_TRIVIAL_ABI
+#endif
+
+//------------------------------------------------------------------------------
+/**
+ * Branch hints for the success (Some/Ok) and failure (None/Err) paths of `Option`, `Result` and `FUN_TRY`. Failure is
+ * taken to be rare: its branches are laid out off the hot path, and the code that runs only on them (the throw of
+ * `expect`, the propagation of `FUN_TRY`) is outlined as cold (`FUN_COLD`). For code where failure is common, define
+ * `FUN_EXPECT_FAILURE` to 1 to flip the hints, which also keeps the failure paths inline. Like
+ * `FUN_ENABLE_TRIVIAL_ABI`, every translation unit of a program must agree on it.
+ */
+#ifndef FUN_EXPECT_FAILURE
+#define FUN_EXPECT_FAILURE 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FUN_SUCCESS_BRANCH(cond) __builtin_expect(static_cast<bool>(cond), !FUN_EXPECT_FAILURE)
+#define FUN_FAILURE_BRANCH(cond) __builtin_expect(static_cast<bool>(cond), FUN_EXPECT_FAILURE)
+#else
+#define FUN_SUCCESS_BRANCH(cond) static_cast<bool>(cond)
+#define FUN_FAILURE_BRANCH(cond) static_cast<bool>(cond)
+#endif
+
+#if FUN_EXPECT_FAILURE
+#define FUN_COLD
+#elif defined(__GNUC__) || defined(__clang__)
+#define FUN_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define FUN_COLD __declspec(noinline)
+#else
+#define FUN_COLD
+#endif
+
+//------------------------------------------------------------------------------
+/**
+ * Preconditions of the `*_unchecked` accessors of `Option` and `Result`. By default they are handed to the optimizer as
+ * assumptions, so that a variant the caller has already checked is not checked again, and breaking one is undefined
+ * behavior. With `FUN_CHECK_ASSUMPTIONS` set to 1, the default in debug (no `NDEBUG`) and sanitized builds, breaking
+ * one instead reports it and aborts.
+ */
+#ifndef FUN_CHECK_ASSUMPTIONS
+#if !defined(NDEBUG) || defined(__SANITIZE_ADDRESS__)
+#define FUN_CHECK_ASSUMPTIONS 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(undefined_behavior_sanitizer)
+#define FUN_CHECK_ASSUMPTIONS 1
+#endif
+#endif
+#endif
+
+#ifndef FUN_CHECK_ASSUMPTIONS
+#define FUN_CHECK_ASSUMPTIONS 0
+#endif
+
+namespace assume_detail {
+
+[[noreturn]] FUN_COLD inline void violated(const char* const msg) noexcept {
+  std::fprintf(stderr, "%s\n", msg);
+  std::abort();
+}
+
+} // end namespace assume_detail
+
+#if FUN_CHECK_ASSUMPTIONS
+#define FUN_ASSUME(cond, msg) (static_cast<bool>(cond) ? void(0) : ::fun::assume_detail::violated(msg))
+#elif defined(__GNUC__) || defined(__clang__)
+#define FUN_ASSUME(cond, msg) (static_cast<bool>(cond) ? void(0) : __builtin_unreachable())
+#elif defined(_MSC_VER)
+#define FUN_ASSUME(cond, msg) __assume(cond)
+#else
+#define FUN_ASSUME(cond, msg) void(0)
+#endif
+
+//------------------------------------------------------------------------------
+/**
+ * Layers that give a tagged-union `Storage` class the special members of its payloads: each of the destructor, the
+ * copy/move constructors and the copy/move assignment operators is trivial exactly when it is trivial for every one of
+ * `Payloads`, and is otherwise implemented in terms of the following `Storage` members:
+ *
+ *   void erase();                          // destroy the active payload, if any
+ *   void construct_from(const Storage&);   // copy the state of another storage into this erased one
+ *   void construct_from(Storage&&);        // move the state of another storage into this erased one
+ *   void assign_from(const Storage&);      // copy the state of another storage into this one
+ *   void assign_from(Storage&&);           // move the state of another storage into this one
+ *
+ * `assign_from` assigns the payload directly when both sides hold the same alternative, so that e.g. a `std::string`
+ * keeps its buffer, and otherwise replaces the contents. `Storage` itself must be default constructible into an erased
+ * state. The non-trivial members are `noexcept` exactly when the corresponding operations of every one of `Payloads`
+ * are (destructors are assumed not to throw), so that e.g. `std::vector` relocates its elements by moving them only
+ * when that is safe.
+ */
+template <class Storage, bool TrivialDtor>
+struct FUN_TRIVIAL_ABI StorageDtor : Storage {
+  using Storage::Storage;
+};
+
+template <class Storage>
+struct FUN_TRIVIAL_ABI StorageDtor<Storage, false> : Storage {
+  using Storage::Storage;
+
+  StorageDtor() = default;
+  StorageDtor(const StorageDtor&) = default;
+  StorageDtor(StorageDtor&&) = default;
+  StorageDtor& operator=(const StorageDtor&) = default;
+  StorageDtor& operator=(StorageDtor&&) = default;
+
+  FUN_CONSTEXPR_DTOR ~StorageDtor() { this->erase(); }
+};
+
+template <class Base, bool TrivialCtors, bool NothrowCopy, bool NothrowMove>
+struct FUN_TRIVIAL_ABI StorageCtors : Base {
+  using Base::Base;
+};
+
+template <class Base, bool NothrowCopy, bool NothrowMove>
+struct FUN_TRIVIAL_ABI StorageCtors<Base, false, NothrowCopy, NothrowMove> : Base {
+  using Base::Base;
+
+  StorageCtors() = default;
+
+  constexpr StorageCtors(const StorageCtors& other) noexcept(NothrowCopy) : Base() { this->construct_from(other); }
+
+  constexpr StorageCtors(StorageCtors&& other) noexcept(NothrowMove) : Base() {
+    this->construct_from(std::move(other));
+  }
+
+  StorageCtors& operator=(const StorageCtors&) = default;
+  StorageCtors& operator=(StorageCtors&&) = default;
+};
+
+template <class Base, bool TrivialAssigns, bool NothrowCopy, bool NothrowMove>
+struct FUN_TRIVIAL_ABI StorageAssigns : Base {
+  using Base::Base;
+};
+
+template <class Base, bool NothrowCopy, bool NothrowMove>
+struct FUN_TRIVIAL_ABI StorageAssigns<Base, false, NothrowCopy, NothrowMove> : Base {
+  using Base::Base;
+
+  StorageAssigns() = default;
+  StorageAssigns(const StorageAssigns&) = default;
+  StorageAssigns(StorageAssigns&&) = default;
+
+  constexpr StorageAssigns& operator=(const StorageAssigns& other) noexcept(NothrowCopy) {
+    if (this != &other) { this->assign_from(other); }
+    return *this;
+  }
+
+  constexpr StorageAssigns& operator=(StorageAssigns&& other) noexcept(NothrowMove) {
+    if (this != &other) { this->assign_from(std::move(other)); }
+    return *this;
+  }
+};
+
+// Deletes the copy members when a payload cannot be copied, so that e.g. `std::move_if_noexcept` does not pick them
+template <class Base, bool Copyable>
+struct FUN_TRIVIAL_ABI StorageCopies : Base {
+  using Base::Base;
+};
+
+template <class Base>
+struct FUN_TRIVIAL_ABI StorageCopies<Base, false> : Base {
+  using Base::Base;
+
+  StorageCopies() = default;
+  StorageCopies(const StorageCopies&) = delete;
+  StorageCopies(StorageCopies&&) = default;
+  StorageCopies& operator=(const StorageCopies&) = delete;
+  StorageCopies& operator=(StorageCopies&&) = default;
+};
+
+template <class ...Payloads>
+constexpr bool are_trivially_destructible_v = (std::is_trivially_destructible_v<Payloads> && ...);
+
+template <class ...Payloads>
+constexpr bool are_trivially_copy_constructible_v =
+  are_trivially_destructible_v<Payloads...> &&
+  ((std::is_trivially_copy_constructible_v<Payloads> && std::is_trivially_move_constructible_v<Payloads>) && ...);
+
+template <class ...Payloads>
+constexpr bool are_trivially_copy_assignable_v =
+  are_trivially_copy_constructible_v<Payloads...> &&
+  ((std::is_trivially_copy_assignable_v<Payloads> && std::is_trivially_move_assignable_v<Payloads>) && ...);
+
+template <class ...Payloads>
+constexpr bool are_nothrow_copy_constructible_v = (std::is_nothrow_copy_constructible_v<Payloads> && ...);
+
+template <class ...Payloads>
+constexpr bool are_nothrow_move_constructible_v = (std::is_nothrow_move_constructible_v<Payloads> && ...);
+
+// Payloads that cannot be assigned are replaced instead
+template <class ...Payloads>
+constexpr bool are_nothrow_copy_assignable_v =
+  are_nothrow_copy_constructible_v<Payloads...> &&
+  ((std::is_nothrow_copy_assignable_v<Payloads> || !std::is_copy_assignable_v<Payloads>) && ...);
+
+template <class ...Payloads>
+constexpr bool are_nothrow_move_assignable_v =
+  are_nothrow_move_constructible_v<Payloads...> &&
+  ((std::is_nothrow_move_assignable_v<Payloads> || !std::is_move_assignable_v<Payloads>) && ...);
+
+template <class Storage, class ...Payloads>
+using SpecialMembers =
+  StorageCopies<
+    StorageAssigns<
+      StorageCtors<
+        StorageDtor<Storage, are_trivially_destructible_v<Payloads...>>,
+        are_trivially_copy_constructible_v<Payloads...>,
+        are_nothrow_copy_constructible_v<Payloads...>,
+        are_nothrow_move_constructible_v<Payloads...>
+      >,
+      are_trivially_copy_assignable_v<Payloads...>,
+      are_nothrow_copy_assignable_v<Payloads...>,
+      are_nothrow_move_assignable_v<Payloads...>
+    >,
+    (std::is_copy_constructible_v<Payloads> && ...)
+  >;
+
 }
@@ -0,0 +1,493 @@
+#pragma once
+
+//!
+//! @author Alex Pronschinske
+//! @copyright MIT License
+//!
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus > 201703L
+#include <ranges>
+#endif
+
+#include <fun/collect.h>
+
+//------------------------------------------------------------------------------
+/**
+ * Lazy, allocation-free range adaptors over Options and Results, for use in `std::ranges` pipelines. They build on
+ * `<ranges>` and are therefore only available with C++20.
+ */
+#if defined(__cpp_lib_ranges)
+
+namespace fun {
+
+namespace views_detail {
+
+//------------------------------------------------------------------------------
+// How `UnwrapView` selects and reaches into its elements. `Take` is used
+// instead for ranges whose elements are temporaries, and turns one into an
+// Option for `FilterMapView`.
+struct SomeAccess {
+  template <class X> static constexpr bool accepts = range_detail::Outcome<X>::is_option;
+
+  template <class O>
+  static constexpr bool has(const O& op) noexcept { return op.is_some(); }
+
+  template <class O>
+  static constexpr auto get(O&& op) noexcept -> decltype(auto) { return range_detail::forward_payload<O&&>(op); }
+
+  struct Take {
+    template <class O>
+    constexpr auto operator()(O&& op) const -> std::remove_cvref_t<O> { return std::forward<O>(op); }
+  };
+};
+
+struct OkAccess {
+  template <class X> static constexpr bool accepts = range_detail::Outcome<X>::is_result;
+
+  template <class R>
+  static constexpr bool has(const R& res) noexcept { return res.is_ok(); }
+
+  template <class R>
+  static constexpr auto get(R&& res) noexcept -> decltype(auto) { return range_detail::forward_payload<R&&>(res); }
+
+  struct Take {
+    template <class R>
+    constexpr auto operator()(R&& res) const { return std::move(res).ok(); }
+  };
+};
+
+struct ErrAccess {
+  template <class X> static constexpr bool accepts = range_detail::Outcome<X>::is_result;
+
+  template <class R>
+  static constexpr bool has(const R& res) noexcept { return res.is_err(); }
+
+  template <class R>
+  static constexpr auto get(R&& res) noexcept -> decltype(auto) { return result_detail::forward_err<R&&>(res); }
+
+  struct Take {
+    template <class R>
+    constexpr auto operator()(R&& res) const { return std::move(res).err(); }
+  };
+};
+
+//------------------------------------------------------------------------------
+// A cached begin iterator, which copies and moves leave behind rather than
+// carry along: it would point into the source view's base
+template <class I>
+struct BeginCache : Option<I> {
+  BeginCache() = default;
+  constexpr BeginCache(const BeginCache&) noexcept : Option<I>() {}
+  constexpr BeginCache(BeginCache&& other) noexcept : Option<I>() { other.reset(); }
+
+  constexpr auto operator=(const BeginCache& other) noexcept -> BeginCache& {
+    if (this != &other) { reset(); }
+    return *this;
+  }
+
+  constexpr auto operator=(BeginCache&& other) noexcept -> BeginCache& {
+    reset();
+    other.reset();
+    return *this;
+  }
+
+  constexpr void reset() noexcept { static_cast<Option<I>&>(*this) = Option<I>(); }
+};
+
+template <class V>
+using iterator_concept_t = std::conditional_t<
+  std::ranges::bidirectional_range<V>,
+  std::bidirectional_iterator_tag,
+  std::conditional_t<std::ranges::forward_range<V>, std::forward_iterator_tag, std::input_iterator_tag>
+>;
+
+// Only forward iterators have a C++17 iterator category
+template <class V, class Ref, bool = std::ranges::forward_range<V>>
+struct IteratorCategory {};
+
+template <class V, class Ref>
+struct IteratorCategory<V, Ref, true> {
+  using iterator_category =
+    std::conditional_t<std::is_reference_v<Ref>, std::forward_iterator_tag, std::input_iterator_tag>;
+};
+
+//==============================================================================
+// The payloads of the Options (or Results) of `V` that hold one (or match
+// `Access`), referred to in place. The underlying range is walked directly,
+// so the view is as capable as `V` up to bidirectional.
+template <std::ranges::input_range V, class Access>
+  requires std::ranges::view<V> && std::is_reference_v<std::ranges::range_reference_t<V>>
+class UnwrapView : public std::ranges::view_interface<UnwrapView<V, Access>> {
+  static_assert(
+    Access::template accepts<std::ranges::range_value_t<V>>,
+    "fun::views::flatten needs a range of Options, oks and errs a range of Results"
+  );
+
+  using base_reference_t = std::ranges::range_reference_t<V>;
+  using reference_t = decltype(Access::get(std::declval<base_reference_t>()));
+
+  class Iterator : public IteratorCategory<V, reference_t> {
+    std::ranges::iterator_t<V> _current = std::ranges::iterator_t<V>();
+    std::ranges::sentinel_t<V> _end = std::ranges::sentinel_t<V>();
+
+    constexpr void satisfy() {
+      while (_current != _end && !Access::has(*_current)) { ++_current; }
+    }
+
+  public:
+    using iterator_concept = iterator_concept_t<V>;
+    using value_type = std::remove_cvref_t<reference_t>;
+    using difference_type = std::ranges::range_difference_t<V>;
+
+    Iterator() requires std::default_initializable<std::ranges::iterator_t<V>> = default;
+
+    constexpr Iterator(std::ranges::iterator_t<V> current, std::ranges::sentinel_t<V> end)
+      : _current(std::move(current))
+      , _end(std::move(end))
+    {
+      satisfy();
+    }
+
+    constexpr auto base() const& -> const std::ranges::iterator_t<V>& { return _current; }
+
+    constexpr auto operator*() const -> reference_t { return Access::get(*_current); }
+
+    constexpr auto operator++() -> Iterator& {
+      ++_current;
+      satisfy();
+      return *this;
+    }
+
+    constexpr void operator++(int) requires (!std::ranges::forward_range<V>) { ++*this; }
+
+    constexpr auto operator++(int) -> Iterator requires std::ranges::forward_range<V> {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    // There is always a selected element before any but the first one
+    constexpr auto operator--() -> Iterator& requires std::ranges::bidirectional_range<V> {
+      do { --_current; } while (!Access::has(*_current));
+      return *this;
+    }
+
+    constexpr auto operator--(int) -> Iterator requires std::ranges::bidirectional_range<V> {
+      auto prev = *this;
+      --*this;
+      return prev;
+    }
+
+    friend constexpr bool operator==(const Iterator& a, const Iterator& b)
+      requires std::equality_comparable<std::ranges::iterator_t<V>>
+    {
+      return a._current == b._current;
+    }
+
+    friend constexpr bool operator==(const Iterator& it, std::default_sentinel_t) { return it._current == it._end; }
+  };
+
+  V _base = V();
+  BeginCache<Iterator> _begin;
+
+public:
+  UnwrapView() requires std::default_initializable<V> = default;
+
+  constexpr explicit UnwrapView(V base) : _base(std::move(base)) {}
+
+  constexpr auto base() const& -> V requires std::copy_constructible<V> { return _base; }
+  constexpr auto base() && -> V { return std::move(_base); }
+
+  //! Forward ranges find their first selected element only once
+  constexpr auto begin() -> Iterator {
+    if constexpr (std::ranges::forward_range<V>) {
+      return _begin.get_or_insert_with([this] { return Iterator(std::ranges::begin(_base), std::ranges::end(_base)); });
+    } else {
+      return Iterator(std::ranges::begin(_base), std::ranges::end(_base));
+    }
+  }
+
+  constexpr auto end() {
+    if constexpr (std::ranges::common_range<V>) { return Iterator(std::ranges::end(_base), std::ranges::end(_base)); }
+    else                                        { return std::default_sentinel; }
+  }
+};
+
+//==============================================================================
+// The payloads of the Options returned by `func` for the elements of `V`.
+// Each result is kept in the view while the iterator is on it, as in
+// `std::ranges::basic_istream_view`, so the view is an input range.
+template <std::ranges::input_range V, std::move_constructible F>
+  requires std::ranges::view<V> && std::is_object_v<F>
+class FilterMapView : public std::ranges::view_interface<FilterMapView<V, F>> {
+  using output_t = std::invoke_result_t<F&, std::ranges::range_reference_t<V>>;
+  static_assert(
+    range_detail::Outcome<output_t>::is_option,
+    "fun::views::filter_map needs a function returning an Option"
+  );
+
+  using reference_t = typename output_t::value_t&;
+
+  V _base = V();
+  Option<F> _func; // assignable even where `F` is not, as views must be
+  output_t _current;
+
+  class Iterator {
+    FilterMapView* _parent;
+    std::ranges::iterator_t<V> _pos;
+
+    constexpr bool done() const { return _parent->_current.is_none(); }
+
+    // Assigning over `_current` reuses the previous payload's resources
+    constexpr void satisfy() {
+      const auto end = std::ranges::end(_parent->_base);
+      for (; _pos != end; ++_pos) {
+        _parent->_current = fun::invoke(*_parent->_func.as_ptr(), *_pos);
+        if (_parent->_current.is_some()) { return; }
+      }
+      _parent->_current = output_t();
+    }
+
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = std::remove_cvref_t<reference_t>;
+    using difference_type = std::ranges::range_difference_t<V>;
+
+    constexpr Iterator(FilterMapView& parent, std::ranges::iterator_t<V> pos)
+      : _parent(std::addressof(parent))
+      , _pos(std::move(pos))
+    {
+      satisfy();
+    }
+
+    Iterator(Iterator&&) = default;
+    auto operator=(Iterator&&) -> Iterator& = default;
+
+    constexpr auto base() const& -> const std::ranges::iterator_t<V>& { return _pos; }
+
+    constexpr auto operator*() const -> reference_t { return *_parent->_current.as_ptr(); }
+
+    constexpr auto operator++() -> Iterator& {
+      ++_pos;
+      satisfy();
+      return *this;
+    }
+
+    constexpr void operator++(int) { ++*this; }
+
+    friend constexpr bool operator==(const Iterator& it, std::default_sentinel_t) { return it.done(); }
+  };
+
+public:
+  FilterMapView() requires std::default_initializable<V> = default;
+
+  constexpr FilterMapView(V base, F func)
+    : _base(std::move(base))
+    , _func(ForwardArgs{}, std::move(func))
+  {}
+
+  constexpr auto base() const& -> V requires std::copy_constructible<V> { return _base; }
+  constexpr auto base() && -> V { return std::move(_base); }
+
+  constexpr auto begin() -> Iterator { return Iterator(*this, std::ranges::begin(_base)); }
+  constexpr auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+};
+
+template <class R, class F>
+FilterMapView(R&&, F) -> FilterMapView<std::views::all_t<R>, F>;
+
+//==============================================================================
+// The Ok values of the Results returned by `func` for the elements of `V`, up
+// to the first error, which is then kept by the view. Like `FilterMapView`,
+// this is an input range.
+template <std::ranges::input_range V, std::move_constructible F>
+  requires std::ranges::view<V> && std::is_object_v<F>
+class TryTransformView : public std::ranges::view_interface<TryTransformView<V, F>> {
+  using output_t = std::invoke_result_t<F&, std::ranges::range_reference_t<V>>;
+  static_assert(
+    range_detail::Outcome<output_t>::is_result,
+    "fun::views::try_transform needs a function returning a Result"
+  );
+
+  using reference_t = typename output_t::value_t&;
+  using err_t = typename range_detail::Outcome<output_t>::err_t;
+
+  V _base = V();
+  Option<F> _func;
+  Option<output_t> _current;
+  Option<err_t> _error;
+
+  class Iterator {
+    TryTransformView* _parent;
+    std::ranges::iterator_t<V> _pos;
+
+    constexpr bool done() const { return _parent->_current.is_none(); }
+
+    constexpr void satisfy() {
+      auto& current = _parent->_current;
+      if (_pos == std::ranges::end(_parent->_base)) {
+        current = Option<output_t>();
+        return;
+      }
+
+      current.emplace(fun::invoke(*_parent->_func.as_ptr(), *_pos));
+      if (current.as_ptr()->is_err()) {
+        _parent->_error.emplace(std::move(*current.as_ptr()).unwrap_err());
+        current = Option<output_t>();
+      }
+    }
+
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = std::remove_cvref_t<reference_t>;
+    using difference_type = std::ranges::range_difference_t<V>;
+
+    constexpr Iterator(TryTransformView& parent, std::ranges::iterator_t<V> pos)
+      : _parent(std::addressof(parent))
+      , _pos(std::move(pos))
+    {
+      satisfy();
+    }
+
+    Iterator(Iterator&&) = default;
+    auto operator=(Iterator&&) -> Iterator& = default;
+
+    constexpr auto base() const& -> const std::ranges::iterator_t<V>& { return _pos; }
+
+    constexpr auto operator*() const -> reference_t { return *_parent->_current.as_ptr()->as_ptr(); }
+
+    constexpr auto operator++() -> Iterator& {
+      ++_pos;
+      satisfy();
+      return *this;
+    }
+
+    constexpr void operator++(int) { ++*this; }
+
+    friend constexpr bool operator==(const Iterator& it, std::default_sentinel_t) { return it.done(); }
+  };
+
+public:
+  TryTransformView() requires std::default_initializable<V> = default;
+
+  constexpr TryTransformView(V base, F func)
+    : _base(std::move(base))
+    , _func(ForwardArgs{}, std::move(func))
+  {}
+
+  constexpr auto base() const& -> V requires std::copy_constructible<V> { return _base; }
+  constexpr auto base() && -> V { return std::move(_base); }
+
+  //! Each pass starts without an error
+  constexpr auto begin() -> Iterator {
+    _error = Option<err_t>();
+    return Iterator(*this, std::ranges::begin(_base));
+  }
+
+  constexpr auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+
+  //! The error that ended the last pass early, if any
+  constexpr auto error() & noexcept -> Option<err_t>& { return _error; }
+  constexpr auto error() const& noexcept -> const Option<err_t>& { return _error; }
+  constexpr auto error() && noexcept(std::is_nothrow_move_constructible_v<err_t>) -> Option<err_t> {
+    return std::move(_error);
+  }
+};
+
+template <class R, class F>
+TryTransformView(R&&, F) -> TryTransformView<std::views::all_t<R>, F>;
+
+//==============================================================================
+// An adaptor with all but its range bound, usable as `range | adaptor`
+template <class Make>
+struct Closure {
+  Make make;
+
+  template <std::ranges::viewable_range R>
+  constexpr auto operator()(R&& range) const { return make(std::forward<R>(range)); }
+
+  template <std::ranges::viewable_range R>
+  friend constexpr auto operator|(R&& range, const Closure& self) { return self.make(std::forward<R>(range)); }
+};
+
+template <class Make>
+Closure(Make) -> Closure<Make>;
+
+template <class Access>
+struct UnwrapFn {
+  template <std::ranges::viewable_range R>
+  constexpr auto operator()(R&& range) const {
+    using Base = std::views::all_t<R>;
+    if constexpr (std::is_reference_v<std::ranges::range_reference_t<R>>) {
+      return UnwrapView<Base, Access>(std::views::all(std::forward<R>(range)));
+    } else {
+      return FilterMapView<Base, typename Access::Take>(std::views::all(std::forward<R>(range)), {});
+    }
+  }
+};
+
+template <template <class, class> class View>
+struct MakeView {
+  template <class R, class F>
+  constexpr auto operator()(R&& range, F&& func) const {
+    return View<std::views::all_t<R>, std::decay_t<F>>(std::views::all(std::forward<R>(range)), std::forward<F>(func));
+  }
+};
+
+template <class Make>
+struct WithFunctionFn {
+  template <std::ranges::viewable_range R, class F>
+  constexpr auto operator()(R&& range, F&& func) const { return Make()(std::forward<R>(range), std::forward<F>(func)); }
+
+  template <class F>
+  constexpr auto operator()(F&& func) const {
+    return Closure{
+      [func = std::forward<F>(func)](auto&& range) { return Make()(std::forward<decltype(range)>(range), func); }
+    };
+  }
+};
+
+} // end namespace views_detail
+
+namespace views {
+
+//!
+//! `range | filter_map(func)` applies `func` (T -> Option<U>) to each element
+//! and yields the values of the Options that hold one
+//!
+inline constexpr views_detail::WithFunctionFn<views_detail::MakeView<views_detail::FilterMapView>> filter_map{};
+
+//!
+//! `range | flatten` yields the values of the Options of `range` that hold
+//! one. The values are referred to in place when `range` holds its Options,
+//! and the view is then as capable as `range` up to bidirectional.
+//!
+inline constexpr views_detail::Closure<views_detail::UnwrapFn<views_detail::SomeAccess>> flatten{};
+
+//! `range | oks` yields the Ok values of a range of Results, see `flatten`
+inline constexpr views_detail::Closure<views_detail::UnwrapFn<views_detail::OkAccess>> oks{};
+
+//! `range | errs` yields the errors of a range of Results, see `flatten`
+inline constexpr views_detail::Closure<views_detail::UnwrapFn<views_detail::ErrAccess>> errs{};
+
+//!
+//! `range | try_transform(func)` applies `func` (T -> Result<U, E>) to each
+//! element and yields the Ok values until the first error, which the view
+//! then keeps, e.g.
+//!
+//!   auto ports = lines | fun::views::try_transform(parse_port);
+//!   for (const auto port : ports) { listen(port); }
+//!   if (ports.error().is_some()) { ... }
+//!
+inline constexpr views_detail::WithFunctionFn<views_detail::MakeView<views_detail::TryTransformView>> try_transform{};
+
+}
+
+}
+
+#endif
@@ -1,12 +1,33 @@
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <list>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
+#include <ranges>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <fun/boxed.h>
+#include <fun/collect.h>
+#include <fun/context.h>
+#include <fun/coroutine.h>
+#include <fun/error.h>
+#include <fun/kernels.h>
+#include <fun/option_vector.h>
+#include <fun/parallel.h>
 #include <fun/pipe.h>
 #include <fun/result.h>
+#include <fun/result_vector.h>
 #include <fun/try.h>
+#include <fun/views.h>
 #include <gtest/gtest.h>
 
 #include "testing.h"
@@ -17,6 +38,11 @@
 #define FUN_INCLUDE_COMPILATION_FAILURE_TESTS 0
 #endif
 
+// Null pointers of these types are never used as values here
+template <> struct fun::EnableNullNiche<int*> : std::true_type {};
+template <> struct fun::EnableNullNiche<void(*)()> : std::true_type {};
+template <> struct fun::EnableNullNiche<std::unique_ptr<int>> : std::true_type {};
+
 //------------------------------------------------------------------------------
 class Monolith {
 private:
@@ -578,6 +604,20 @@ TEST(OptionTest, expect) {
   ASSERT_THROW(x.clone().expect("error message"), std::runtime_error);
 }
 
+//------------------------------------------------------------------------------
+TEST(OptionTest, unwrap_unchecked) {
+  auto x = fun::some(example_unique_one());
+  ASSERT_TRUE(x.is_some());
+  EXPECT_EQ(*std::move(x).unwrap_unchecked(), 1);
+
+  auto r = 0;
+  EXPECT_EQ(&fun::some_ref(r).unwrap_unchecked(), &r);
+
+#if FUN_CHECK_ASSUMPTIONS
+  EXPECT_DEATH(fun::Option<int>().unwrap_unchecked(), "unwrap_unchecked called on a None Option");
+#endif
+}
+
 //------------------------------------------------------------------------------
 TEST(OptionTest, emplace_unit) {
   auto x = fun::Option<fun::Unit>();
@@ -659,6 +699,9 @@ TEST(OptionTest, empty_base) {
   EXPECT_TRUE(op2.is_none());
   op2 = std::move(op1);
   EXPECT_TRUE(op2.is_some());
+  // Moves are trivial for a trivially copyable payload, so they leave the source as it was
+  EXPECT_TRUE(op1.is_some());
+  op1.take();
   EXPECT_TRUE(op1.is_none());
   op1.emplace(fun::Unit());
   EXPECT_TRUE(op1 == op2);
@@ -697,6 +740,18 @@ TEST(ResultTest, unwrap) {
   ASSERT_TRUE(p.get());
 }
 
+//------------------------------------------------------------------------------
+TEST(ResultTest, unwrap_unchecked) {
+  EXPECT_EQ(*fun::ok<std::string>(example_unique_one()).unwrap_unchecked(), 1);
+  EXPECT_EQ(fun::err<std::unique_ptr<int>>(std::string("bad")).unwrap_err_unchecked(), "bad");
+
+#if FUN_CHECK_ASSUMPTIONS
+  using IntResult = fun::Result<int, int>;
+  EXPECT_DEATH(IntResult(fun::make_err(0)).unwrap_unchecked(), "unwrap_unchecked called on an Err Result");
+  EXPECT_DEATH(IntResult(fun::make_ok(0)).unwrap_err_unchecked(), "unwrap_err_unchecked called on an Ok Result");
+#endif
+}
+
 //------------------------------------------------------------------------------
 TEST(ResultTest, unwrap_or_default) {
   auto empty_str = fun::err<std::string>(0).unwrap_or_default();
@@ -984,6 +1039,332 @@ TEST(LayoutTest, option_sizes) {
   EXPECT_EQ(sizeof(fun::Option<std::uint64_t>), sizeof(std::pair<std::uint8_t, std::uint64_t>));
 }
 
+//------------------------------------------------------------------------------
+enum class Errc: std::uint8_t { Busy, Timeout, Refused };
+
+template <> struct fun::NicheTraits<Errc> : fun::OutOfRangeNiche<Errc, Errc::Refused> {};
+
+enum class Port: std::uint16_t {};
+
+template <> struct fun::NicheTraits<Port> : fun::SentinelNiche<Port, Port(0)> {};
+
+enum class Delta: std::int8_t { Down = -2, Flat = -1 };
+
+template <> struct fun::NicheTraits<Delta> : fun::OutOfRangeNiche<Delta, Delta::Flat> {};
+
+enum class Offset: std::int64_t { Back = -3 };
+
+template <> struct fun::NicheTraits<Offset> : fun::OutOfRangeNiche<Offset, Offset::Back> {};
+
+// A niche type that can only be constructed, never assigned
+struct Handle {
+  int fd;
+
+  explicit Handle(const int f) noexcept : fd(f) {}
+  Handle(const Handle&) = default;
+  auto operator=(const Handle&) -> Handle& = delete;
+};
+
+template <>
+struct fun::NicheTraits<Handle> {
+  static constexpr std::size_t count = 1;
+  static constexpr bool reserved = true;
+
+  static Handle make(std::size_t) { return Handle(-1); }
+
+  static bool is(const Handle& x, std::size_t) { return x.fd == -1; }
+};
+
+template <> struct fun::EnablePointerPacking<int*, double*> : std::true_type {};
+template <> struct fun::EnablePointerPacking<std::uint32_t*, Port*> : std::true_type {};
+
+TEST(LayoutTest, option_niche_sizes) {
+  EXPECT_EQ(sizeof(fun::Option<int*>), sizeof(int*));
+  EXPECT_EQ(sizeof(fun::Option<void(*)()>), sizeof(void(*)()));
+  EXPECT_EQ(sizeof(fun::Option<std::unique_ptr<int>>), sizeof(std::unique_ptr<int>));
+  EXPECT_EQ(sizeof(fun::Option<char*>), sizeof(std::pair<std::uint8_t, char*>));
+  EXPECT_EQ(sizeof(fun::Option<std::unique_ptr<char>>), sizeof(std::pair<std::uint8_t, std::unique_ptr<char>>));
+  EXPECT_EQ(sizeof(fun::Option<float>), sizeof(float));
+  EXPECT_EQ(sizeof(fun::Option<double>), sizeof(double));
+  EXPECT_EQ(sizeof(fun::Option<Errc>), sizeof(Errc));
+  EXPECT_EQ(sizeof(fun::Option<Port>), sizeof(Port));
+  EXPECT_EQ(sizeof(fun::Option<Delta>), sizeof(Delta));
+  EXPECT_EQ(sizeof(fun::Option<Handle>), sizeof(Handle));
+  EXPECT_EQ(sizeof(fun::Option<int&>), sizeof(int*));
+}
+
+//------------------------------------------------------------------------------
+TEST(LayoutTest, niches_above_negative_enumerators) {
+  // Only the values from 0 to 127 lie above Flat (-1)
+  static_assert(fun::NicheTraits<Delta>::count == 128);
+  static_assert(fun::NicheTraits<Offset>::count == 256);
+
+  auto delta = fun::Option<Delta>();
+  EXPECT_TRUE(delta.is_none());
+  delta = fun::some(Delta::Flat);
+  EXPECT_TRUE(delta == fun::some(Delta::Flat));
+  EXPECT_TRUE(fun::Option<fun::Option<Delta>>(fun::some(fun::Option<Delta>())).unwrap().is_none());
+}
+
+TEST(OptionTest, niche_emplace_constructs_in_place) {
+  auto handle = fun::Option<Handle>();
+  EXPECT_TRUE(handle.is_none());
+  handle.emplace(3);
+  EXPECT_EQ(handle.as_ptr()->fd, 3);
+  handle.emplace(4);
+  EXPECT_EQ(handle.as_ptr()->fd, 4);
+}
+
+TEST(LayoutTest, result_sizes) {
+  EXPECT_EQ(sizeof(fun::Result<std::uint8_t, std::uint8_t>), 2);
+  EXPECT_EQ(sizeof(fun::Result<std::uint32_t, std::uint8_t>), sizeof(std::pair<std::uint8_t, std::uint32_t>));
+  EXPECT_EQ(sizeof(fun::Result<std::uint64_t, std::uint32_t>), sizeof(std::pair<std::uint8_t, std::uint64_t>));
+  EXPECT_EQ(sizeof(fun::Result<fun::Unit, fun::Unit>), 1);
+  EXPECT_EQ(sizeof(fun::Result<fun::Unit, std::is_empty<void>>), 1);
+  EXPECT_EQ(sizeof(fun::Result<fun::Unit, Errc>), sizeof(Errc));
+  EXPECT_EQ(sizeof(fun::Result<Port, fun::Unit>), sizeof(Port));
+  EXPECT_EQ(sizeof(fun::Result<fun::Option<Errc>, fun::Unit>), sizeof(Errc));
+  EXPECT_EQ(sizeof(fun::Result<int*, fun::Unit>), sizeof(std::pair<std::uint8_t, int*>));
+  EXPECT_EQ(sizeof(fun::Result<fun::Unit, double>), sizeof(std::pair<std::uint8_t, double>));
+  EXPECT_EQ(sizeof(fun::Result<int*, double*>), sizeof(void*));
+  EXPECT_EQ(sizeof(fun::Result<std::uint32_t*, Port*>), sizeof(void*));
+  EXPECT_EQ(sizeof(fun::Result<double*, int*>), sizeof(std::pair<std::uint8_t, double*>));
+  EXPECT_EQ(sizeof(fun::Result<char*, int*>), sizeof(std::pair<std::uint8_t, char*>));
+}
+
+//------------------------------------------------------------------------------
+TEST(ResultTest, packed_layouts) {
+  auto u = fun::Result<fun::Unit, Errc>(fun::make_ok());
+  EXPECT_TRUE(u.is_ok());
+  u = fun::err(Errc::Timeout);
+  EXPECT_TRUE(u.is_err());
+  EXPECT_EQ(u.clone().unwrap_err(), Errc::Timeout);
+  EXPECT_TRUE(u == fun::err(Errc::Timeout));
+  EXPECT_EQ(*u.as_err_ptr(), Errc::Timeout);
+  u = fun::ok(fun::Unit{});
+  EXPECT_EQ(std::move(u).map([](fun::Unit) { return 3; }).unwrap_or(0), 3);
+
+  auto s = fun::Result<fun::Unit, fun::Unit>(fun::make_err());
+  EXPECT_TRUE(s.is_err());
+  s = fun::ok(fun::Unit{});
+  EXPECT_TRUE(s.is_ok());
+
+  auto n = 1;
+  auto x = 2.0;
+  auto p = fun::Result<int*, double*>(fun::make_ok(&n));
+  EXPECT_TRUE(p.is_ok());
+  EXPECT_EQ(p.clone().unwrap(), &n);
+  EXPECT_EQ(*p.as_ptr(), &n);
+  p = fun::err(&x);
+  EXPECT_TRUE(p.is_err());
+  EXPECT_EQ(p.clone().unwrap_err(), &x);
+  EXPECT_EQ(p.as_ref().unwrap_err(), &x);
+  EXPECT_TRUE(p == fun::err(&x));
+  EXPECT_TRUE(p != fun::ok(&n));
+  EXPECT_EQ(p.clone().map_err([](double* d) { return *d; }).unwrap_err(), 2.0);
+
+  auto q = fun::Result<int*, fun::Unit>(fun::make_ok(&n));
+  EXPECT_TRUE(q.is_ok());
+  EXPECT_EQ(*q.clone().unwrap(), 1);
+  q = fun::err(fun::Unit{});
+  EXPECT_TRUE(q.is_err());
+  EXPECT_TRUE(q.clone().ok().is_none());
+}
+
+//------------------------------------------------------------------------------
+TEST(ResultTest, niche_values_stay_values) {
+  auto null_ok = fun::Result<int*, fun::Unit>(fun::make_ok(static_cast<int*>(nullptr)));
+  EXPECT_TRUE(null_ok.is_ok());
+  EXPECT_EQ(null_ok.clone().unwrap(), nullptr);
+
+  auto null_err = fun::Result<fun::Unit, int*>(fun::make_err(static_cast<int*>(nullptr)));
+  EXPECT_TRUE(null_err.is_err());
+
+  const auto nan = fun::NicheTraits<double>::make(0);
+  EXPECT_TRUE((fun::Result<double, fun::Unit>(fun::make_ok(nan)).is_ok()));
+
+  // Unpacked pointers still lend out their errors
+  auto n = 1;
+  auto p = fun::Result<double*, int*>(fun::make_err(&n));
+  EXPECT_EQ(*p.as_err_ptr(), &n);
+}
+
+//------------------------------------------------------------------------------
+TEST(LayoutTest, nested_sizes) {
+  using std::uint32_t;
+  EXPECT_EQ(sizeof(fun::Option<fun::Option<uint32_t>>), sizeof(fun::Option<uint32_t>));
+  EXPECT_EQ(sizeof(fun::Option<fun::Option<fun::Option<uint32_t>>>), sizeof(fun::Option<uint32_t>));
+  EXPECT_EQ(sizeof(fun::Option<fun::Option<fun::Unit>>), sizeof(fun::Option<fun::Unit>));
+  EXPECT_EQ(sizeof(fun::Option<fun::Option<double>>), sizeof(double));
+  EXPECT_EQ(sizeof(fun::Option<fun::Option<std::string>>), sizeof(fun::Option<std::string>));
+  EXPECT_EQ(sizeof(fun::Option<fun::Result<uint32_t, Errc>>), sizeof(fun::Result<uint32_t, Errc>));
+  EXPECT_EQ(sizeof(fun::Option<fun::Result<fun::Unit, Errc>>), sizeof(Errc));
+  EXPECT_EQ(sizeof(fun::Option<fun::Result<fun::Unit, fun::Unit>>), 1);
+  EXPECT_EQ(sizeof(fun::Result<fun::Option<uint32_t>, fun::Unit>), sizeof(fun::Option<uint32_t>));
+  EXPECT_EQ(sizeof(fun::Result<fun::Option<std::string>, fun::Unit>), sizeof(fun::Option<std::string>));
+}
+
+//------------------------------------------------------------------------------
+TEST(OptionTest, nested_shared_discriminant) {
+  using Inner = fun::Option<std::string>;
+
+  auto none = fun::Option<Inner>();
+  EXPECT_TRUE(none.is_none());
+  auto some_none = fun::some(Inner());
+  EXPECT_TRUE(some_none.is_some());
+  EXPECT_TRUE(some_none.clone().unwrap().is_none());
+  auto some_some = fun::some(fun::some(std::string("abc")));
+  EXPECT_TRUE(some_some.is_some());
+  EXPECT_EQ(some_some.clone().unwrap().unwrap(), "abc");
+
+  EXPECT_TRUE(none != some_none);
+  EXPECT_TRUE(some_none != some_some);
+  EXPECT_TRUE(none.clone() == fun::Option<Inner>());
+
+  auto copy = none;
+  EXPECT_TRUE(copy.is_none());
+  copy = some_none;
+  EXPECT_TRUE(copy.is_some());
+  copy = none;
+  EXPECT_TRUE(copy.is_none());
+  copy = std::move(some_some);
+  EXPECT_EQ(copy.take().unwrap().unwrap(), "abc");
+  EXPECT_TRUE(copy.is_none());
+
+  auto triple = fun::Option<fun::Option<fun::Option<std::uint32_t>>>();
+  EXPECT_TRUE(triple.is_none());
+  triple.emplace(fun::Option<fun::Option<std::uint32_t>>());
+  EXPECT_TRUE(triple.is_some());
+  EXPECT_TRUE(triple.clone().unwrap().is_none());
+  triple.emplace(fun::Option<std::uint32_t>());
+  EXPECT_TRUE(triple.clone().unwrap().is_some());
+  EXPECT_TRUE(triple.clone().unwrap().unwrap().is_none());
+  triple.emplace(fun::some(fun::some(7u)));
+  EXPECT_EQ(triple.clone().unwrap().unwrap().unwrap(), 7u);
+
+  auto res = fun::Option<fun::Result<int, std::string>>();
+  EXPECT_TRUE(res.is_none());
+  res.emplace(fun::err<int>(std::string("bad")));
+  EXPECT_EQ(res.clone().unwrap().unwrap_err(), "bad");
+  res.emplace(fun::ok<std::string>(5));
+  EXPECT_EQ(res.clone().unwrap().unwrap(), 5);
+
+  auto lookup = fun::Result<fun::Option<std::uint32_t>, fun::Unit>(fun::make_ok(fun::some(3u)));
+  EXPECT_TRUE(lookup.is_ok());
+  EXPECT_EQ(lookup.clone().unwrap().unwrap(), 3u);
+  lookup = fun::ok(fun::Option<std::uint32_t>());
+  EXPECT_TRUE(lookup.is_ok());
+  EXPECT_TRUE(lookup.clone().unwrap().is_none());
+  lookup = fun::err(fun::Unit{});
+  EXPECT_TRUE(lookup.is_err());
+}
+
+//------------------------------------------------------------------------------
+TEST(LayoutTest, conditional_triviality) {
+  static_assert(std::is_trivially_copyable_v<fun::Option<int>>);
+  static_assert(std::is_trivially_destructible_v<fun::Option<int>>);
+  static_assert(std::is_trivially_copyable_v<fun::Option<int&>>);
+  static_assert(std::is_trivially_copyable_v<fun::Option<fun::Unit>>);
+  static_assert(std::is_trivially_copyable_v<fun::Option<double>>);
+  static_assert(std::is_trivially_copyable_v<fun::Option<int*>>);
+  static_assert(std::is_trivially_copyable_v<fun::Result<int, Errc>>);
+  static_assert(std::is_trivially_copyable_v<fun::Result<const int&, Errc>>);
+  static_assert(std::is_trivially_copyable_v<fun::Result<fun::Unit, int>>);
+
+  using IntPair = std::pair<int, int>;
+  static_assert(std::is_trivially_copy_constructible_v<fun::Option<IntPair>>);
+  static_assert(std::is_trivially_move_constructible_v<fun::Option<IntPair>>);
+  static_assert(std::is_trivially_destructible_v<fun::Option<IntPair>>);
+  static_assert(!std::is_trivially_copy_assignable_v<fun::Option<IntPair>>);
+
+  static_assert(!std::is_trivially_copyable_v<fun::Option<std::string>>);
+  static_assert(!std::is_trivially_destructible_v<fun::Option<std::string>>);
+  static_assert(!std::is_trivially_copyable_v<fun::Result<int, std::string>>);
+  static_assert(!std::is_trivially_destructible_v<fun::Result<std::string, int>>);
+  static_assert(!std::is_trivially_copyable_v<fun::Option<std::unique_ptr<int>>>);
+
+  auto xs = std::vector<fun::Result<int, Errc>>(3, fun::ok<Errc>(7));
+  xs.push_back(fun::err<int>(Errc::Timeout));
+  xs.resize(64, fun::ok<Errc>(1));
+  EXPECT_EQ(xs[0].clone().unwrap(), 7);
+  EXPECT_EQ(xs[3].clone().unwrap_err(), Errc::Timeout);
+
+  auto p = fun::some(IntPair(1, 2));
+  auto q = fun::Option<IntPair>();
+  q = p;
+  EXPECT_EQ(q.clone().unwrap(), IntPair(1, 2));
+  q = fun::Option<IntPair>();
+  EXPECT_TRUE(q.is_none());
+}
+
+//------------------------------------------------------------------------------
+TEST(OptionTest, moved_from_keeps_its_variant) {
+  // Trivially movable, tagged
+  auto i = fun::some(1);
+  auto i2 = std::move(i);
+  EXPECT_TRUE(i.is_some());
+
+  // Not trivially movable, tagged
+  auto s = fun::some(std::string(64, 's'));
+  auto s2 = std::move(s);
+  EXPECT_TRUE(s.is_some());
+  s2 = fun::some(std::string("t"));
+  s = std::move(s2);
+  EXPECT_TRUE(s2.is_some());
+  EXPECT_EQ(s, fun::some(std::string("t")));
+
+  // Niche
+  auto e = fun::some(Errc::Timeout);
+  auto e2 = std::move(e);
+  EXPECT_TRUE(e.is_some());
+
+  // A moved-from payload that is the niche standing for None
+  auto u = fun::some(example_unique_one());
+  auto u2 = std::move(u);
+  EXPECT_TRUE(u.is_none());
+  EXPECT_EQ(**u2.as_ptr(), 1);
+
+  // None stays None
+  auto n = fun::Option<std::string>();
+  auto n2 = std::move(n);
+  EXPECT_TRUE(n.is_none());
+  EXPECT_TRUE(n2.is_none());
+}
+
+TEST(OptionTest, niche_variants) {
+  auto n = 3;
+  auto p = fun::some(&n);
+  EXPECT_TRUE(p.is_some());
+  EXPECT_EQ(p.clone().unwrap(), &n);
+  EXPECT_TRUE(fun::some(static_cast<int*>(nullptr)).is_none());
+  // Null is only a niche where that was asked for
+  EXPECT_TRUE(fun::some(static_cast<char*>(nullptr)).is_some());
+  EXPECT_TRUE(fun::some(std::unique_ptr<char>()).is_some());
+  EXPECT_TRUE(p.take().is_some());
+  EXPECT_TRUE(p.is_none());
+
+  auto u = fun::some(example_unique_one());
+  EXPECT_EQ(*std::move(u).unwrap(), 1);
+  EXPECT_TRUE(fun::Option<std::unique_ptr<int>>().is_none());
+
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_TRUE(fun::some(nan).is_some());
+  EXPECT_TRUE(fun::some(0.0f).is_some());
+  EXPECT_TRUE(fun::Option<double>().is_none());
+  EXPECT_TRUE(fun::Option<float>().is_none());
+  EXPECT_EQ(fun::some(1.5).unwrap_or(0.0), 1.5);
+
+  EXPECT_TRUE(fun::some(Errc::Refused).is_some());
+  EXPECT_TRUE(fun::Option<Errc>().is_none());
+  auto e = fun::Option<Errc>();
+  e.emplace(Errc::Busy);
+  EXPECT_TRUE(e == fun::some(Errc::Busy));
+  EXPECT_TRUE(e != fun::Option<Errc>());
+
+  EXPECT_TRUE(fun::some(Port(80)).is_some());
+  EXPECT_TRUE(fun::some(Port(0)).is_none());
+}
+
 //------------------------------------------------------------------------------
 class Foo {
 public:
@@ -1032,12 +1413,12 @@ int main(int nargs, char** vargs) {
                           ).unwrap_or(std::string("failure"));
   std::cout << y << std::endl;
 
-  // const auto y_ = fun::compose(
-  //   fun::bind_op(safe_cstr),
-  //   fun::bind_op(small_str),
-  //   [](auto&& op) { return std::forward<decltype(op)>(op).unwrap_or(std::string("failure")); }
-  // );
-  // std::cout << y_(fun::some(std::string("345*"))) << std::endl;
+  const auto y_ = fun::compose(
+    fun::bind(safe_cstr),
+    fun::bind(small_str),
+    [](auto&& op) { return std::forward<decltype(op)>(op).unwrap_or(std::string("failure")); }
+  );
+  std::cout << y_(fun::some(std::string("345*"))) << std::endl;
 
   const auto x = fun::make_ok(y, 6., "hal:");
   const auto baby = even_baby(nargs * 2);
@@ -1049,3 +1430,1789 @@ int main(int nargs, char** vargs) {
 
   return gtest_return_code;
 }
+
+//------------------------------------------------------------------------------
+namespace constant_evaluation {
+
+constexpr auto parse_digit(const char c) -> fun::Option<int> {
+  if ('0' <= c && c <= '9') { return fun::some(c - '0'); }
+  else                      { return fun::nothing(); }
+}
+
+constexpr auto parse_two_digits(const char* str) -> fun::Option<int> {
+  FUN_TRY_DECLARE(hi, parse_digit(str[0]));
+  FUN_TRY_DECLARE(lo, parse_digit(str[1]));
+  return fun::some(10 * hi + lo);
+}
+
+constexpr auto checked_port(const int n) -> fun::Result<int, Errc> {
+  if (0 < n && n < 65536) { return fun::ok(n); }
+  else                    { return fun::err(Errc::Refused); }
+}
+
+constexpr auto port_offset(const int base, const int offset) -> fun::Result<int, Errc> {
+  auto port = 0;
+  FUN_TRY_ASSIGN(port, checked_port(base));
+  FUN_TRY_DISCARDING(checked_port(offset));
+  return checked_port(port + offset);
+}
+
+struct Route {
+  int port;
+  fun::Option<Errc> failure;
+};
+
+constexpr auto make_routes() {
+  std::array<fun::Option<Route>, 4> routes = {};
+  routes[1] = fun::some(Route{ 80, fun::nothing() });
+  routes[3] = fun::some(Route{ 0, fun::some(Errc::Timeout) });
+  return routes;
+}
+
+constexpr auto routes = make_routes();
+
+} // end namespace constant_evaluation
+
+TEST(ConstexprTest, option) {
+  using namespace constant_evaluation;
+
+  static_assert(parse_digit('7').is_some());
+  static_assert(parse_digit('x').is_none());
+  static_assert(parse_digit('7') == fun::some(7));
+  static_assert(fun::some(3).map([](int x) { return 2 * x; }).unwrap() == 6);
+  static_assert(parse_digit('4').and_then([](int x) { return parse_digit(static_cast<char>('0' + x + 1)); }).unwrap() == 5);
+  static_assert(parse_digit('x').map_or(-1, [](int x) { return x; }) == -1);
+  static_assert(parse_digit('9').match([](int x) { return x; }, []() { return -1; }) == 9);
+  static_assert(parse_digit('x').unwrap_or(0) == 0);
+  static_assert(parse_digit('x').unwrap_or_else([]() { return 1; }) == 1);
+  static_assert(parse_digit('2').filter([](int x) { return x % 2 == 1; }).is_none());
+  static_assert(parse_digit('2').zip(parse_digit('3')).unwrap().second == 3);
+  static_assert(parse_digit('2').ok_or(Errc::Busy).is_ok());
+  static_assert(fun::Option<int>().or_else([]() { return fun::some(1); }).unwrap() == 1);
+  static_assert(parse_digit('1').as_ref().map([](const int& x) { return x + 1; }).unwrap() == 2);
+
+  static_assert(fun::some(Errc::Busy).is_some());
+  static_assert(fun::Option<Errc>().is_none());
+  static_assert(fun::some(fun::some(1)).unwrap().unwrap() == 1);
+  static_assert(fun::some(fun::Option<int>()).is_some());
+  static_assert(fun::Option<fun::Option<int>>().is_none());
+  static_assert(fun::Option<const int*>().is_none());
+  static_assert(fun::some(fun::Unit{}).is_some());
+
+  static_assert(routes[0].is_none());
+  static_assert(routes[1].as_ref().map([](const Route& r) { return r.port; }).unwrap() == 80);
+  static_assert(routes[3].as_ref().and_then([](const Route& r) { return r.failure; }) == fun::some(Errc::Timeout));
+
+  constexpr auto digit = parse_digit('5');
+  static_assert(*digit.as_ptr() == 5);
+  static_assert(*digit.begin() == 5);
+}
+
+TEST(ConstexprTest, result) {
+  using namespace constant_evaluation;
+
+  static_assert(checked_port(80).is_ok());
+  static_assert(checked_port(-1).is_err());
+  static_assert(checked_port(80) == fun::ok(80));
+  static_assert(checked_port(-1) == fun::err(Errc::Refused));
+  static_assert(checked_port(80).map([](int p) { return p + 1; }).unwrap() == 81);
+  static_assert(checked_port(-1).map_err([](Errc) { return 0; }).unwrap_err() == 0);
+  static_assert(checked_port(80).and_then([](int p) { return checked_port(p * 1000); }).unwrap_err() == Errc::Refused);
+  static_assert(checked_port(-1).or_else([](Errc) { return checked_port(1); }).unwrap() == 1);
+  static_assert(checked_port(-1).match([](int p) { return p; }, [](Errc) { return 0; }) == 0);
+  static_assert(checked_port(-1).unwrap_or(8080) == 8080);
+  static_assert(checked_port(-1).unwrap_or_else([](Errc) { return 1; }) == 1);
+  static_assert(checked_port(80).ok() == fun::some(80));
+  static_assert(checked_port(-1).err() == fun::some(Errc::Refused));
+  static_assert(checked_port(80).zip(checked_port(81)).unwrap().first == 80);
+  static_assert(checked_port(80).as_ref().map([](const int& p) { return p; }).unwrap() == 80);
+
+  static_assert(fun::Result<fun::Unit, Errc>(fun::make_ok()).is_ok());
+  static_assert(fun::Result<fun::Unit, Errc>(fun::make_err(Errc::Busy)).unwrap_err() == Errc::Busy);
+  static_assert(fun::Result<fun::Unit, fun::Unit>(fun::make_err()).is_err());
+  static_assert(fun::Option<fun::Result<int, Errc>>().is_none());
+  static_assert(fun::some(checked_port(-1)).unwrap().is_err());
+
+  static_assert(port_offset(8000, 80).unwrap() == 8080);
+  static_assert(port_offset(-1, 80).unwrap_err() == Errc::Refused);
+  static_assert(port_offset(8000, -1).is_err());
+  static_assert(parse_two_digits("42") == fun::some(42));
+  static_assert(parse_two_digits("4x").is_none());
+}
+
+TEST(ConstexprTest, pipe) {
+  using namespace constant_evaluation;
+
+  constexpr auto twice = [](int x) { return 2 * x; };
+  constexpr auto validate = [](int x) { return checked_port(x); };
+
+  static_assert(fun::pipe(21, twice) == 42);
+  static_assert(fun::pipe(parse_digit('4'), fun::lift(twice)).unwrap() == 8);
+  static_assert(fun::pipe(fun::ok<Errc>(40000), fun::lift(twice), fun::bind(validate)).is_err());
+  static_assert(fun::pipe(fun::ok<Errc>(4000), fun::lift(twice), fun::bind(validate)).unwrap() == 8000);
+}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_string)
+TEST(ConstexprTest, non_trivial_payloads) {
+  static_assert(fun::some(std::string("abc")).map([](std::string s) { return s.size(); }).unwrap() == 3);
+  static_assert(
+    []() {
+      auto name = fun::Option<std::string>();
+      name.emplace("first");
+      auto copy = name;
+      name = fun::some(std::string("second"));
+      auto moved = std::move(name);
+      return copy.take().unwrap() + std::move(moved).unwrap();
+    }() == "firstsecond"
+  );
+  static_assert(
+    []() {
+      auto res = fun::Result<std::string, int>(fun::make_err(1));
+      auto copy = res;
+      res = fun::make_ok(std::string("ok"));
+      copy = res;
+      return std::move(copy).unwrap();
+    }() == "ok"
+  );
+  static_assert(fun::some(0.5).unwrap_or(0.0) == 0.5);
+  static_assert(fun::Option<double>().is_none());
+}
+#endif
+
+//------------------------------------------------------------------------------
+TEST(OptionVectorTest, round_trip) {
+  auto ops = std::vector<fun::Option<std::string>>();
+  for (auto i = 0; i < 100; ++i) {
+    if (i % 3 == 0) { ops.push_back(fun::some(std::to_string(i))); }
+    else            { ops.emplace_back(); }
+  }
+
+  const auto column = fun::OptionVector<std::string>(ops);
+  EXPECT_EQ(column.size(), 100);
+  EXPECT_EQ(column.count_some(), 34);
+  EXPECT_EQ(column.count_none(), 66);
+  EXPECT_TRUE(column.to_options() == ops);
+
+  auto moved = fun::OptionVector<std::string>(std::vector<fun::Option<std::string>>(ops));
+  EXPECT_TRUE(moved == column);
+  EXPECT_TRUE(std::move(moved).to_options() == ops);
+  EXPECT_TRUE(moved.empty());
+}
+
+//------------------------------------------------------------------------------
+TEST(OptionVectorTest, element_access) {
+  auto column = fun::OptionVector<int>(3);
+  EXPECT_TRUE(column[0].is_none());
+  EXPECT_EQ(column.count_some(), 0);
+
+  column.set(1, fun::some(5));
+  EXPECT_TRUE(column.is_some(1));
+  EXPECT_EQ(column[1].unwrap(), 5);
+  column[1].unwrap() += 1;
+  EXPECT_EQ(std::as_const(column)[1].unwrap(), 6);
+  EXPECT_EQ(column[1].map([](int x) { return 2 * x; }).unwrap_or(0), 12);
+
+  column.push_back(fun::some(7));
+  column.push_none();
+  column.emplace_back(9);
+  EXPECT_EQ(column.size(), 6);
+  EXPECT_EQ(column.count_some(), 3);
+  EXPECT_TRUE(column[4].is_none());
+
+  EXPECT_EQ(column.take(3).unwrap(), 7);
+  EXPECT_TRUE(column.is_none(3));
+  EXPECT_TRUE(column.take(3).is_none());
+
+  column.set(1, {});
+  EXPECT_TRUE(column[1].is_none());
+  EXPECT_EQ(column.values()[1], 0);
+
+  column.resize(2);
+  EXPECT_EQ(column.count_some(), 0);
+  column.resize(200);
+  EXPECT_EQ(column.count_some(), 0);
+  EXPECT_EQ(column.presence().find_next(0), 200);
+}
+
+//------------------------------------------------------------------------------
+TEST(OptionVectorTest, iteration_skips_absent_rows) {
+  auto column = fun::OptionVector<int>(1000);
+  for (const auto i : { 3, 63, 64, 500, 999 }) { column.set(i, fun::some(i)); }
+
+  auto indices = std::vector<std::size_t>();
+  auto sum = 0;
+  for (auto it = column.begin(); it != column.end(); ++it) {
+    indices.push_back(it.index());
+    sum += *it;
+  }
+  EXPECT_EQ(indices, (std::vector<std::size_t>{ 3, 63, 64, 500, 999 }));
+  EXPECT_EQ(sum, 3 + 63 + 64 + 500 + 999);
+
+  for (auto& x : column) { x = -x; }
+  auto visited = std::vector<int>();
+  std::as_const(column).for_each_some([&](std::size_t i, const int& x) {
+    EXPECT_EQ(static_cast<int>(i), -x);
+    visited.push_back(x);
+  });
+  EXPECT_EQ(visited, (std::vector<int>{ -3, -63, -64, -500, -999 }));
+
+  EXPECT_TRUE(fun::OptionVector<int>(64).begin() == fun::OptionVector<int>(64).end());
+}
+
+//------------------------------------------------------------------------------
+TEST(ResultVectorTest, round_trip) {
+  auto results = std::vector<fun::Result<int, std::string>>();
+  for (auto i = 0; i < 200; ++i) {
+    if (i % 50 == 7) { results.push_back(fun::err<int>(std::to_string(i))); }
+    else             { results.push_back(fun::ok<std::string>(i)); }
+  }
+
+  const auto batch = fun::ResultVector<int, std::string>(results);
+  EXPECT_EQ(batch.size(), 200);
+  EXPECT_EQ(batch.count_err(), 4);
+  EXPECT_EQ(batch.count_ok(), 196);
+  EXPECT_TRUE(batch.to_results() == results);
+
+  auto moved = fun::ResultVector<int, std::string>(std::vector<fun::Result<int, std::string>>(results));
+  EXPECT_TRUE(moved == batch);
+  EXPECT_TRUE(std::move(moved).to_results() == results);
+  EXPECT_TRUE(moved.empty());
+}
+
+//------------------------------------------------------------------------------
+TEST(ResultVectorTest, element_access) {
+  auto batch = fun::ResultVector<int, std::string>();
+  batch.push_ok(1);
+  batch.push_err("bad");
+  batch.push_back(fun::ok<std::string>(3));
+
+  EXPECT_TRUE(batch.is_ok(0));
+  EXPECT_TRUE(batch.is_err(1));
+  EXPECT_EQ(batch[0].unwrap(), 1);
+  EXPECT_EQ(batch[1].unwrap_err(), "bad");
+  batch[2].unwrap() *= 10;
+  batch[1].unwrap_err() += "!";
+  EXPECT_EQ(std::as_const(batch)[2].unwrap(), 30);
+  EXPECT_EQ(std::as_const(batch)[1].unwrap_err(), "bad!");
+  EXPECT_EQ(batch[2].map([](int& x) { return x + 1; }).unwrap_or(0), 31);
+
+  batch.set(0, fun::err<int>(std::string("first")));
+  EXPECT_EQ(batch.errs().size(), 2);
+  EXPECT_EQ(batch.first_err().unwrap().first, 0);
+  EXPECT_EQ(batch.first_err().unwrap().second, "first");
+  batch.set(1, fun::ok<std::string>(2));
+  batch.set(0, fun::err<int>(std::string("again")));
+  EXPECT_EQ(batch.count_err(), 1);
+  EXPECT_EQ(batch[0].unwrap_err(), "again");
+  batch.set(0, fun::ok<std::string>(0));
+  EXPECT_TRUE(batch.first_err().is_none());
+  EXPECT_EQ(batch.count_ok(), 3);
+}
+
+//------------------------------------------------------------------------------
+TEST(ResultVectorTest, partition) {
+  auto batch = fun::ResultVector<int, std::string>();
+  for (auto i = 0; i < 130; ++i) {
+    if (i == 64 || i == 100) { batch.push_err(std::to_string(i)); }
+    else                     { batch.push_ok(i); }
+  }
+
+  auto sum = 0;
+  for (const auto x : std::as_const(batch).oks()) { sum += x; }
+  EXPECT_EQ(sum, 129 * 130 / 2 - 64 - 100);
+  for (auto& x : batch.oks()) { x = -x; }
+  EXPECT_EQ(batch[65].unwrap(), -65);
+
+  const auto [oks, errs] = batch.partition();
+  EXPECT_EQ(oks.size(), 128);
+  EXPECT_EQ(oks[64], -65);
+  EXPECT_EQ(errs, (std::vector<std::string>{ "64", "100" }));
+
+  auto moved_parts = std::move(batch).partition();
+  EXPECT_EQ(moved_parts.first, oks);
+  EXPECT_EQ(moved_parts.second, errs);
+  EXPECT_TRUE(batch.empty());
+}
+
+//------------------------------------------------------------------------------
+namespace kernel_checks {
+
+// Presence patterns: every row, none, every third row, and a sparse pattern
+// that leaves whole SIMD blocks and bitmap words empty
+auto present(const int pattern, const std::size_t i) -> bool {
+  switch (pattern) {
+    case 0:  return true;
+    case 1:  return false;
+    case 2:  return i % 3 == 1;
+    default: return i % 97 == 41;
+  }
+}
+
+template <class T>
+void check_column(const std::size_t n, const int pattern) {
+  auto ops = std::vector<fun::Option<T>>();
+  for (auto i = std::size_t{0}; i < n; ++i) {
+    if (present(pattern, i)) { ops.push_back(fun::some(static_cast<T>(static_cast<int>(i % 50) - 20))); }
+    else                     { ops.emplace_back(); }
+  }
+  const auto column = fun::OptionVector<T>(ops);
+
+  auto count = std::size_t{0};
+  auto sum = T();
+  auto min = fun::Option<T>();
+  auto max = fun::Option<T>();
+  auto compact = std::vector<T>();
+  auto first = fun::Option<std::size_t>();
+  for (auto i = std::size_t{0}; i < n; ++i) {
+    if (ops[i].is_none()) { continue; }
+    const auto x = ops[i].cloned().unwrap();
+    ++count;
+    sum += x;
+    if (min.is_none() || x < min.cloned().unwrap()) { min = fun::some(x); }
+    if (max.is_none() || max.cloned().unwrap() < x) { max = fun::some(x); }
+    compact.push_back(x);
+    if (first.is_none()) { first = fun::some(i); }
+  }
+
+  EXPECT_EQ(fun::count_some(ops), count);
+  EXPECT_EQ(fun::count_some(column), count);
+  EXPECT_EQ(fun::sum_some(ops), sum);
+  EXPECT_EQ(fun::sum_some(column), sum);
+  EXPECT_EQ(fun::min_some(ops), min);
+  EXPECT_EQ(fun::min_some(column), min);
+  EXPECT_EQ(fun::max_some(ops), max);
+  EXPECT_EQ(fun::max_some(column), max);
+  EXPECT_EQ(fun::compact_some(ops), compact);
+  EXPECT_EQ(fun::compact_some(column), compact);
+  EXPECT_EQ(fun::find_first_some(ops), first);
+  EXPECT_EQ(fun::find_first_some(column), first);
+}
+
+template <class T>
+void check_all_columns() {
+  for (const auto n : { 0, 1, 7, 16, 33, 64, 100, 1029 }) {
+    for (const auto pattern : { 0, 1, 2, 3 }) { check_column<T>(static_cast<std::size_t>(n), pattern); }
+  }
+}
+
+} // end namespace kernel_checks
+
+TEST(KernelsTest, match_naive_loops) {
+  // Every available instruction set must agree with the naive loops
+  for (const auto isa : { fun::simd::Isa::Scalar, fun::simd::Isa::Avx2, fun::simd::Isa::Avx512 }) {
+    fun::simd::limit_isa(isa);
+    kernel_checks::check_all_columns<std::int32_t>();
+    kernel_checks::check_all_columns<std::int64_t>();
+    kernel_checks::check_all_columns<float>();
+    kernel_checks::check_all_columns<double>();
+    kernel_checks::check_all_columns<short>();
+  }
+  fun::simd::limit_isa(fun::simd::Isa::Avx512);
+}
+
+TEST(KernelsTest, niche_layout) {
+  // Some(NaN) is a real value, only the niche bit pattern is None
+  auto ops = std::vector<fun::Option<double>>(40);
+  ops[5] = fun::some(std::numeric_limits<double>::quiet_NaN());
+  ops[37] = fun::some(2.5);
+  EXPECT_EQ(fun::count_some(ops), 2u);
+  EXPECT_EQ(fun::find_first_some(ops), fun::some(std::size_t{5}));
+  EXPECT_EQ(fun::compact_some(ops).size(), 2u);
+  EXPECT_EQ(fun::compact_some(ops)[1], 2.5);
+}
+
+//------------------------------------------------------------------------------
+namespace pipe_checks {
+
+struct MoveCount {
+  int moves = 0;
+  int copies = 0;
+};
+
+// Counts every move and copy of itself into a shared tally
+struct Tracked {
+  MoveCount* count;
+
+  explicit Tracked(MoveCount& c) : count(&c) {}
+  Tracked(Tracked&& other) noexcept : count(other.count) { ++count->moves; }
+  Tracked(const Tracked& other) : count(other.count) { ++count->copies; }
+  auto operator=(Tracked&&) -> Tracked& = delete;
+  auto operator=(const Tracked&) -> Tracked& = delete;
+};
+
+auto pass(Tracked&& t) noexcept -> Tracked { return std::move(t); }
+
+auto keep(Tracked&& t) -> fun::Option<Tracked> { return fun::some(std::move(t)); }
+
+} // end namespace pipe_checks
+
+TEST(PipeTest, stages_move_at_most_once) {
+  using pipe_checks::Tracked;
+
+  auto count = pipe_checks::MoveCount();
+  const auto out = fun::pipe(Tracked(count), pipe_checks::pass, pipe_checks::pass, pipe_checks::pass);
+  EXPECT_EQ(out.count, &count);
+  EXPECT_EQ(count.moves, 3);
+  EXPECT_EQ(count.copies, 0);
+
+  // lift and bind add nothing to the moves made by map and and_then themselves
+  auto direct = pipe_checks::MoveCount();
+  auto piped = pipe_checks::MoveCount();
+  auto composed = pipe_checks::MoveCount();
+  const auto by_hand = fun::Option<Tracked>(fun::ForwardArgs{}, direct).map(pipe_checks::pass).and_then(pipe_checks::keep);
+  const auto by_pipe = fun::pipe(
+    fun::Option<Tracked>(fun::ForwardArgs{}, piped), fun::lift(pipe_checks::pass), fun::bind(pipe_checks::keep)
+  );
+  const auto stored = fun::compose(fun::lift(pipe_checks::pass), fun::bind(pipe_checks::keep));
+  const auto by_compose = stored(fun::Option<Tracked>(fun::ForwardArgs{}, composed));
+  EXPECT_TRUE(by_hand.is_some() && by_pipe.is_some() && by_compose.is_some());
+  EXPECT_EQ(piped.moves, direct.moves);
+  EXPECT_EQ(composed.moves, direct.moves);
+  EXPECT_EQ(piped.copies + composed.copies + direct.copies, 0);
+}
+
+TEST(PipeTest, compose) {
+  const auto twice = [](const int x) noexcept { return 2 * x; };
+  const auto positive = [](const int x) -> fun::Option<int> {
+    if (x > 0) { return fun::some(x); }
+    else       { return {}; }
+  };
+  const auto pipeline = fun::compose(fun::bind(positive), fun::lift(twice), fun::lift(twice));
+  EXPECT_EQ(pipeline(fun::some(3)), fun::some(12));
+  EXPECT_EQ(pipeline(fun::some(-3)), fun::Option<int>());
+
+  // An lvalue is copied into the stage and left untouched
+  const auto op = fun::some(5);
+  EXPECT_EQ(pipeline(op), fun::some(20));
+  EXPECT_EQ(op, fun::some(5));
+
+  static_assert(noexcept(fun::pipe(1, twice, twice)));
+  static_assert(!noexcept(fun::pipe(1, twice, positive)));
+  static_assert(fun::compose(twice, twice)(5) == 20);
+  static_assert(std::is_same_v<decltype(fun::compose()(1)), int>);
+}
+
+//------------------------------------------------------------------------------
+namespace lazy_checks {
+
+template <class T>
+constexpr bool is_lazy_callable_v = requires(T&& x) { std::forward<T>(x).lazy(); };
+
+} // end namespace lazy_checks
+
+TEST(LazyTest, option_chain) {
+  using lazy_checks::is_lazy_callable_v;
+
+  const auto trim = [](std::string s) {
+    while (!s.empty() && s.back() == ' ') { s.pop_back(); }
+    return s;
+  };
+  const auto parse = [](const std::string& s) -> fun::Option<int> {
+    if (s.empty() || s.size() > 5 || s.find_first_not_of("0123456789") != std::string::npos) { return {}; }
+    return fun::some(std::stoi(s));
+  };
+  const auto in_range = [](const int port) { return 0 < port && port < 65536; };
+
+  for (const auto* field : { "8080  ", "", "99999", "http", "443" }) {
+    auto eager = fun::some(std::string(field)).map(trim).and_then(parse).filter(in_range).map([](int p) { return p + 1; });
+    auto source = fun::some(std::string(field));
+    auto lazy = std::move(source).lazy().map(trim).and_then(parse).filter(in_range)
+                                 .map([](int p) { return p + 1; }).eval();
+    static_assert(std::is_same_v<decltype(lazy), fun::Option<int>>);
+    EXPECT_EQ(lazy, eager) << field;
+  }
+  EXPECT_EQ(fun::Option<std::string>().lazy().map(trim).and_then(parse).eval(), fun::Option<int>());
+
+  // Reference results are passed through without copying
+  auto values = std::vector<int>{ 1, 2, 3 };
+  auto last = fun::some(std::size_t{2}).lazy().map([&](std::size_t i) -> int& { return values[i]; }).eval();
+  static_assert(std::is_same_v<decltype(last), fun::Option<int&>>);
+  EXPECT_EQ(last.as_ptr(), &values[2]);
+
+  static_assert(
+    fun::some(20).lazy().map([](int x) { return x + 1; }).map([](int x) { return 2 * x; }).eval() == fun::some(42)
+  );
+
+  // The source is consumed, which has to be spelled out for an lvalue
+  static_assert(is_lazy_callable_v<fun::Option<int>>);
+  static_assert(!is_lazy_callable_v<fun::Option<int>&>);
+  static_assert(!is_lazy_callable_v<const fun::Option<int>&>);
+}
+
+TEST(LazyTest, result_chain) {
+  using lazy_checks::is_lazy_callable_v;
+  const auto halve = [](const int x) -> fun::Result<int, std::string> {
+    if (x % 2 == 0) { return fun::ok(x / 2); }
+    else            { return fun::err(std::string("odd")); }
+  };
+  const auto describe = [](std::string e) { return e.size(); };
+
+  for (const auto x : { 8, 6, 3 }) {
+    auto eager = fun::Result<int, std::string>(fun::ok(x))
+      .and_then(halve).map([](int y) { return y + 1; }).and_then(halve).map_err(describe);
+    auto lazy = fun::Result<int, std::string>(fun::ok(x))
+      .lazy().and_then(halve).map([](int y) { return y + 1; }).and_then(halve).map_err(describe).eval();
+    static_assert(std::is_same_v<decltype(lazy), fun::Result<int, std::size_t>>);
+    EXPECT_EQ(lazy, eager) << x;
+  }
+
+  // An error from the source only passes through the map_err stages
+  auto bad = fun::Result<int, std::string>(fun::err(std::string("bad")));
+  auto failed = std::move(bad).lazy().map([](int y) { return y * 2.0; }).map_err(describe).eval();
+  static_assert(std::is_same_v<decltype(failed), fun::Result<double, std::size_t>>);
+  EXPECT_EQ(std::move(failed).unwrap_err(), 3u);
+
+  static_assert(is_lazy_callable_v<fun::Result<int, std::string>>);
+  static_assert(!is_lazy_callable_v<fun::Result<int, std::string>&>);
+}
+
+TEST(LazyTest, moves_only_once) {
+  using pipe_checks::Tracked;
+
+  // Eager chains move the payload in and out of an Option at every stage,
+  // a lazy chain hands it from stage to stage by reference
+  auto count = pipe_checks::MoveCount();
+  const auto out = fun::Option<Tracked>(fun::ForwardArgs{}, count).lazy()
+    .map(pipe_checks::pass).map(pipe_checks::pass).map(pipe_checks::pass).eval();
+  EXPECT_TRUE(out.is_some());
+  EXPECT_EQ(count.moves, 3 + 1);
+  EXPECT_EQ(count.copies, 0);
+}
+
+//------------------------------------------------------------------------------
+namespace in_place_checks {
+
+// Fails the running test if it is ever moved or copied
+struct Pinned {
+  int id;
+  std::string name;
+
+  Pinned(const int i, std::string n) : id(i), name(std::move(n)) {}
+  Pinned(Pinned&& other) noexcept : id(other.id), name(std::move(other.name)) { ADD_FAILURE() << "Pinned moved"; }
+  Pinned(const Pinned& other) : id(other.id), name(other.name) { ADD_FAILURE() << "Pinned copied"; }
+};
+
+auto make_pinned_option() -> fun::Option<Pinned> { return fun::make_some(1, "one"); }
+auto make_pinned_ok() -> fun::Result<Pinned, int> { return fun::make_ok(2, "two"); }
+auto make_pinned_err() -> fun::Result<int, Pinned> { return fun::make_err(3, "three"); }
+
+auto make_monolith_option() -> fun::Option<Monolith> { return fun::make_some(4); }
+auto make_monolith_ok() -> fun::Result<Monolith, int> { return fun::make_ok(5); }
+
+} // end namespace in_place_checks
+
+TEST(InPlaceTest, factories_never_move) {
+  using in_place_checks::Pinned;
+
+  EXPECT_EQ(in_place_checks::make_pinned_option().as_ptr()->name, "one");
+  EXPECT_EQ(in_place_checks::make_pinned_ok().as_ptr()->name, "two");
+  EXPECT_EQ(in_place_checks::make_pinned_err().as_err_ptr()->name, "three");
+
+  const auto a = fun::Option<Pinned>(fun::ForwardArgs{}, 6, "six");
+  const auto b = fun::Result<Pinned, int>(fun::OkTag{}, fun::ForwardArgs{}, 7, "seven");
+  const auto c = fun::Result<int, Pinned>(fun::ErrTag{}, fun::ForwardArgs{}, 8, "eight");
+  const auto d = fun::Option<Pinned>(fun::make_some(9, "nine"));
+  EXPECT_EQ(a.as_ptr()->id + b.as_ptr()->id + c.as_err_ptr()->id + d.as_ptr()->id, 6 + 7 + 8 + 9);
+
+  // Types that cannot be moved at all
+  EXPECT_EQ(in_place_checks::make_monolith_option().as_ptr()->double_up(), 8);
+  EXPECT_EQ(in_place_checks::make_monolith_ok().as_ptr()->double_up(), 10);
+}
+
+TEST(InPlaceTest, values_move_once) {
+  using pipe_checks::Tracked;
+
+  auto count = pipe_checks::MoveCount();
+  const auto a = fun::some(Tracked(count));
+  const auto b = fun::Option<Tracked>(Tracked(count));
+  const auto c = fun::ok<int>(Tracked(count));
+  const auto d = fun::err<int>(Tracked(count));
+  EXPECT_TRUE(a.is_some() && b.is_some() && c.is_ok() && d.is_err());
+  EXPECT_EQ(count.moves, 4);
+  EXPECT_EQ(count.copies, 0);
+
+  const auto e = a.cloned();
+  EXPECT_EQ(count.moves, 4);
+  EXPECT_EQ(count.copies, 1);
+}
+
+//------------------------------------------------------------------------------
+namespace extraction_checks {
+
+using pipe_checks::MoveCount;
+using pipe_checks::Tracked;
+
+auto some(MoveCount& c) -> fun::Option<Tracked> { return fun::Option<Tracked>(fun::ForwardArgs{}, c); }
+auto ok(MoveCount& c) -> fun::Result<Tracked, Tracked> { return { fun::OkTag{}, fun::ForwardArgs{}, c }; }
+auto err(MoveCount& c) -> fun::Result<Tracked, Tracked> { return { fun::ErrTag{}, fun::ForwardArgs{}, c }; }
+
+auto id(const Tracked& t) -> MoveCount* { return t.count; }
+auto none() -> MoveCount* { return nullptr; }
+constexpr auto no_count = static_cast<MoveCount*>(nullptr);
+
+// Moves made by `op` on a value that starts out in place
+template <class Make, class Op>
+auto moves(Make make, Op op) -> int {
+  auto count = MoveCount();
+  auto source = make(count);
+  op(std::move(source));
+  EXPECT_EQ(count.copies, 0);
+  return count.moves;
+}
+
+} // end namespace extraction_checks
+
+TEST(ExtractionTest, option_moves) {
+  using namespace extraction_checks;
+  using Opt = fun::Option<Tracked>;
+
+  // Taking the value out moves it once
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).unwrap(); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).expect("some"); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { auto alt = MoveCount(); return std::move(o).unwrap_or(Tracked(alt)); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).unwrap_or_else([]() -> Tracked { throw 0; }); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).ok_or(0); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).ok_or_else([] { return 0; }); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).filter([](const Tracked&) { return true; }); }), 1);
+  // `take` has to leave a None behind, so the value passes through a temporary
+  EXPECT_EQ(moves(some, [](Opt&& o) { return o.take(); }), 2);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return Opt(std::move(o)); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).zip(fun::some(0)); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).or_else([] { return Opt(); }); }), 1);
+
+  // Callables receive the value by reference, so only a by-value parameter moves it
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).map([](Tracked&& t) { return id(t); }); }), 0);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).map([](Tracked t) { return id(t); }); }), 1);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).map_or(no_count, id); }), 0);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).map_or_else(none, id); }), 0);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).and_then([](Tracked&& t) { return fun::some(id(t)); }); }), 0);
+  EXPECT_EQ(moves(some, [](Opt&& o) { return std::move(o).match(id, none); }), 0);
+}
+
+TEST(ExtractionTest, result_moves) {
+  using namespace extraction_checks;
+  using Res = fun::Result<Tracked, Tracked>;
+
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).unwrap(); }), 1);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).unwrap_err(); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { auto alt = MoveCount(); return std::move(r).unwrap_or(Tracked(alt)); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).unwrap_or_else([](Tracked&&) -> Tracked { throw 0; }); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).ok(); }), 1);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).err(); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return Res(std::move(r)); }), 1);
+  EXPECT_EQ(moves(err, [](Res&& r) { return Res(std::move(r)); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).zip(fun::Result<int, Tracked>(fun::ok(0))); }), 1);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).map_err(id); }), 1);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).map(id); }), 1);
+
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).map(id); }), 0);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).map_err(id); }), 0);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).unwrap_or_else([](Tracked&& t) { return Tracked(*id(t)); }); }), 0);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).map_or(no_count, id); }), 0);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).map_or_else(id, id); }), 0);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).match(id, id); }), 0);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).match(id, id); }), 0);
+  EXPECT_EQ(moves(ok, [](Res&& r) { return std::move(r).and_then([](Tracked&& t) { return fun::Result<MoveCount*, Tracked>(fun::ok(id(t))); }); }), 0);
+  EXPECT_EQ(moves(err, [](Res&& r) { return std::move(r).or_else([](Tracked&& t) { return fun::Result<Tracked, MoveCount*>(fun::err(id(t))); }); }), 0);
+}
+
+TEST(ExtractionTest, defaults_are_lazy) {
+  using IntRes = fun::Result<int, int>;
+
+  // The fallback is only converted to the value type when it is used
+  auto built = 0;
+  struct Fallback {
+    int* built;
+    explicit operator int() const { ++*built; return -1; }
+  };
+  EXPECT_EQ(fun::some(3).unwrap_or(Fallback{ &built }), 3);
+  EXPECT_EQ(IntRes(fun::ok(4)).unwrap_or(Fallback{ &built }), 4);
+  EXPECT_EQ(built, 0);
+  EXPECT_EQ(fun::Option<int>().unwrap_or(Fallback{ &built }), -1);
+  EXPECT_EQ(IntRes(fun::err(0)).unwrap_or(Fallback{ &built }), -1);
+  EXPECT_EQ(built, 2);
+
+  EXPECT_EQ(IntRes(fun::err(5)).map_or_else([](int e) { return e * 2; }, [](int x) { return x; }), 10);
+  EXPECT_EQ(IntRes(fun::ok(5)).map_or(0, [](int x) { return x + 1; }), 6);
+}
+
+//------------------------------------------------------------------------------
+namespace noexcept_checks {
+
+// A payload whose move constructor may throw
+struct ThrowingMove {
+  int* copies;
+
+  explicit ThrowingMove(int& c) : copies(&c) {}
+  ThrowingMove(ThrowingMove&& other) noexcept(false) : copies(other.copies) {}
+  ThrowingMove(const ThrowingMove& other) : copies(other.copies) { ++*copies; }
+};
+
+// A payload that may throw while moving and cannot be copied
+struct MoveOnlyThrowingMove {
+  int val;
+
+  explicit MoveOnlyThrowingMove(int v) : val(v) {}
+  MoveOnlyThrowingMove(MoveOnlyThrowingMove&& other) noexcept(false) : val(other.val) {}
+  MoveOnlyThrowingMove(const MoveOnlyThrowingMove&) = delete;
+  auto operator=(MoveOnlyThrowingMove&&) noexcept(false) -> MoveOnlyThrowingMove& = default;
+};
+
+using Str = std::string;
+
+static_assert(std::is_nothrow_move_constructible_v<fun::Option<Str>>);
+static_assert(std::is_nothrow_move_assignable_v<fun::Option<Str>>);
+static_assert(std::is_nothrow_default_constructible_v<fun::Option<Str>>);
+static_assert(std::is_nothrow_move_constructible_v<fun::Result<Str, Str>>);
+static_assert(std::is_nothrow_move_assignable_v<fun::Result<Str, Str>>);
+static_assert(!std::is_nothrow_copy_constructible_v<fun::Result<Str, Str>>);
+
+static_assert(!std::is_nothrow_move_constructible_v<fun::Option<ThrowingMove>>);
+static_assert(!std::is_nothrow_move_assignable_v<fun::Option<ThrowingMove>>);
+static_assert(!std::is_nothrow_move_constructible_v<fun::Result<ThrowingMove, int>>);
+static_assert(!std::is_nothrow_move_constructible_v<fun::Result<int, ThrowingMove>>);
+static_assert(!std::is_nothrow_move_assignable_v<fun::Result<int, ThrowingMove>>);
+
+static_assert(!std::is_copy_constructible_v<fun::Option<MoveOnlyThrowingMove>>);
+static_assert(!std::is_copy_assignable_v<fun::Option<MoveOnlyThrowingMove>>);
+static_assert(std::is_move_constructible_v<fun::Option<MoveOnlyThrowingMove>>);
+static_assert(!std::is_copy_constructible_v<fun::Result<MoveOnlyThrowingMove, Str>>);
+static_assert(!std::is_copy_assignable_v<fun::Result<int, MoveOnlyThrowingMove>>);
+static_assert(std::is_move_assignable_v<fun::Result<int, MoveOnlyThrowingMove>>);
+
+static_assert(std::is_nothrow_move_constructible_v<fun::Option<int&>>);
+static_assert(std::is_nothrow_move_constructible_v<fun::Option<fun::Option<Str>>>);
+static_assert(std::is_nothrow_move_constructible_v<fun::Result<fun::Unit, Str>>);
+
+// Combinators are noexcept when the payloads and callables are
+const auto length = [](Str&& s) noexcept { return s.size(); };
+const auto throwing_length = [](Str&& s) { return s.size(); };
+static_assert(noexcept(std::declval<fun::Option<Str>>().unwrap()));
+static_assert(noexcept(std::declval<fun::Option<Str>>().map(length)));
+static_assert(!noexcept(std::declval<fun::Option<Str>>().map(throwing_length)));
+static_assert(!noexcept(std::declval<fun::Option<ThrowingMove>>().unwrap()));
+static_assert(noexcept(std::declval<fun::Result<Str, int>>().map(length)));
+static_assert(!noexcept(std::declval<fun::Result<Str, ThrowingMove>>().map(length)));
+static_assert(noexcept(std::declval<fun::Result<Str, int>>().ok()));
+static_assert(noexcept(std::declval<fun::Option<Str>>().ok_or(0)));
+static_assert(!noexcept(std::declval<fun::Option<Str>>().expect("")));
+
+} // end namespace noexcept_checks
+
+TEST(NoexceptTest, vectors_move_only_when_nothrow) {
+  using noexcept_checks::ThrowingMove;
+
+  // Nothrow payloads are relocated by moving
+  auto counts = pipe_checks::MoveCount();
+  auto nothrow = std::vector<fun::Result<pipe_checks::Tracked, std::string>>();
+  for (auto i = 0; i < 100; ++i) { nothrow.emplace_back(fun::OkTag{}, fun::ForwardArgs{}, counts); }
+  EXPECT_EQ(counts.copies, 0);
+  EXPECT_GT(counts.moves, 0);
+
+  // A payload that may throw while moving is copied, to keep the strong guarantee
+  auto copies = 0;
+  auto throwing = std::vector<fun::Option<ThrowingMove>>();
+  for (auto i = 0; i < 100; ++i) { throwing.emplace_back(fun::ForwardArgs{}, copies); }
+  EXPECT_GT(copies, 0);
+
+  // A payload that may throw while moving but cannot be copied is still moved
+  auto move_only = std::vector<fun::Option<noexcept_checks::MoveOnlyThrowingMove>>();
+  for (auto i = 0; i < 100; ++i) { move_only.push_back(fun::some(noexcept_checks::MoveOnlyThrowingMove(i))); }
+  EXPECT_EQ(move_only[99].as_ptr()->val, 99);
+}
+
+//------------------------------------------------------------------------------
+TEST(MutationTest, assignment_reuses_payload) {
+  const auto long_text = std::string(100, 'x');
+
+  auto op = fun::some(long_text);
+  const auto* op_buffer = op.as_ptr()->data();
+  op = fun::some(std::string("short"));
+  EXPECT_EQ(op, fun::some(std::string("short")));
+  EXPECT_EQ(op.as_ptr()->data(), op_buffer) << "a Some assigned over a Some keeps its string buffer";
+
+  const auto other = fun::some(std::string("copied"));
+  op = other;
+  EXPECT_EQ(op.as_ptr()->data(), op_buffer);
+  EXPECT_EQ(op, other);
+
+  auto res = fun::Result<std::string, std::string>(fun::ok(long_text));
+  const auto* ok_buffer = res.as_ptr()->data();
+  res = fun::Result<std::string, std::string>(fun::ok(std::string("ok")));
+  EXPECT_EQ(res.as_ptr()->data(), ok_buffer);
+  EXPECT_EQ(*res.as_ptr(), "ok");
+
+  // Changing the variant replaces the payload
+  res = fun::Result<std::string, std::string>(fun::err(long_text));
+  EXPECT_EQ(*res.as_err_ptr(), long_text);
+  const auto* err_buffer = res.as_err_ptr()->data();
+  res = fun::Result<std::string, std::string>(fun::err(std::string("err")));
+  EXPECT_EQ(res.as_err_ptr()->data(), err_buffer);
+  EXPECT_EQ(*res.as_err_ptr(), "err");
+
+  // Payloads that cannot be assigned are rebuilt
+  auto count = pipe_checks::MoveCount();
+  auto tracked = fun::Option<pipe_checks::Tracked>(fun::ForwardArgs{}, count);
+  tracked = fun::Option<pipe_checks::Tracked>(fun::ForwardArgs{}, count);
+  EXPECT_EQ(count.moves, 1);
+}
+
+TEST(MutationTest, result_emplace_replace_swap) {
+  using Res = fun::Result<std::string, int>;
+
+  auto res = Res(fun::err(3));
+  EXPECT_EQ(*res.emplace_ok(4, 'a').as_ptr(), "aaaa");
+  EXPECT_EQ(res.emplace_err(5), fun::err(5));
+
+  // Every layout supports emplacement
+  auto stateless = fun::Result<fun::Unit, fun::Unit>(fun::ok(fun::Unit{}));
+  EXPECT_TRUE(stateless.emplace_err().is_err());
+  auto niche = fun::Result<fun::Unit, int*>(fun::ok(fun::Unit{}));
+  auto x = 6;
+  EXPECT_EQ(*niche.emplace_err(&x).as_err_ptr(), &x);
+  EXPECT_TRUE(niche.emplace_ok().is_ok());
+  auto count = pipe_checks::MoveCount();
+  auto in_place = fun::Result<pipe_checks::Tracked, int>(fun::err(0));
+  in_place.emplace_ok(count);
+  EXPECT_TRUE(in_place.is_ok());
+  EXPECT_EQ(count.moves + count.copies, 0);
+
+  auto old = res.replace(Res(fun::ok(std::string("new"))));
+  EXPECT_EQ(old, fun::err(5));
+  EXPECT_EQ(res, fun::ok(std::string("new")));
+
+  auto a = Res(fun::ok(std::string("a")));
+  auto b = Res(fun::ok(std::string("b")));
+  auto c = Res(fun::err(7));
+  a.swap(b);
+  EXPECT_EQ(a, fun::ok(std::string("b")));
+  EXPECT_EQ(b, fun::ok(std::string("a")));
+  swap(a, c);
+  EXPECT_EQ(a, fun::err(7));
+  EXPECT_EQ(c, fun::ok(std::string("b")));
+
+  // Swapping references rebinds them
+  auto i = 1;
+  auto j = 2;
+  auto ri = fun::Result<int&, int>(fun::ok_ref(i));
+  auto rj = fun::Result<int&, int>(fun::ok_ref(j));
+  ri.swap(rj);
+  EXPECT_EQ(ri.as_ptr(), &j);
+  EXPECT_EQ(i + 10 * j, 21);
+}
+
+TEST(MutationTest, option_replace_get_or_insert_swap) {
+  auto op = fun::Option<std::string>();
+  EXPECT_EQ(op.replace("first"), fun::Option<std::string>());
+  EXPECT_EQ(op.replace("second"), fun::some(std::string("first")));
+  EXPECT_EQ(op, fun::some(std::string("second")));
+
+  auto calls = 0;
+  const auto make = [&] { ++calls; return std::string("made"); };
+  auto cache = fun::Option<std::string>();
+  cache.get_or_insert_with(make) += "!";
+  EXPECT_EQ(cache.get_or_insert_with(make), "made!");
+  EXPECT_EQ(calls, 1);
+
+  auto a = fun::some(std::string("a"));
+  auto none = fun::Option<std::string>();
+  swap(a, none);
+  EXPECT_TRUE(a.is_none());
+  EXPECT_EQ(none, fun::some(std::string("a")));
+
+  auto x = 1;
+  auto y = 2;
+  auto ref = fun::some_ref(x);
+  EXPECT_EQ(ref.replace(y).as_ptr(), &x);
+  EXPECT_EQ(ref.as_ptr(), &y);
+  EXPECT_EQ(x, 1);
+
+  // Niche layouts
+  auto ptr = fun::Option<int*>();
+  EXPECT_EQ(*ptr.get_or_insert_with([&] { return &x; }), 1);
+  EXPECT_EQ(ptr.replace(&y), fun::some(&x));
+}
+
+//------------------------------------------------------------------------------
+namespace views_checks {
+
+enum class Fault: std::uint8_t { Busy, Timeout };
+
+auto parse_digit(const char c) -> fun::Result<int, char> {
+  if (c >= '0' && c <= '9') { return fun::make_ok(c - '0'); }
+  else                      { return fun::make_err(c); }
+}
+
+template <class R>
+auto collect(R&& range) {
+  auto out = std::vector<std::remove_cvref_t<std::ranges::range_reference_t<R>>>();
+  for (auto&& x : range) { out.push_back(x); }
+  return out;
+}
+
+}
+
+TEST(ViewsTest, flatten_refers_in_place) {
+  auto ops = std::vector<fun::Option<std::string>>{
+    fun::some(std::string("a")), {}, fun::some(std::string("b")), {}, {}, fun::some(std::string("c"))
+  };
+
+  auto values = ops | fun::views::flatten;
+  static_assert(std::ranges::bidirectional_range<decltype(values)>);
+  static_assert(std::ranges::common_range<decltype(values)>);
+  EXPECT_EQ(views_checks::collect(values), (std::vector<std::string>{ "a", "b", "c" }));
+  EXPECT_EQ(&*values.begin(), ops[0].as_ptr());
+
+  for (auto& x : values) { x += "!"; }
+  EXPECT_EQ(ops[2], fun::some(std::string("b!")));
+
+  auto reversed = std::vector<std::string>();
+  for (auto& x : values | std::views::reverse) { reversed.push_back(x); }
+  EXPECT_EQ(reversed, (std::vector<std::string>{ "c!", "b!", "a!" }));
+
+  // Temporaries are taken over instead
+  const auto lengths = views_checks::collect(
+    ops | std::views::transform([](const auto& op) { return op.as_ref().map(&std::string::size); })
+        | fun::views::flatten
+  );
+  EXPECT_EQ(lengths, (std::vector<std::size_t>{ 2, 2, 2 }));
+
+  const auto none = std::vector<fun::Option<int>>(5);
+  EXPECT_TRUE(std::ranges::empty(none | fun::views::flatten));
+}
+
+TEST(ViewsTest, oks_and_errs) {
+  const auto text = std::string("1x2y3");
+  auto parsed = std::vector<fun::Result<int, char>>();
+  for (const auto c : text) { parsed.push_back(views_checks::parse_digit(c)); }
+
+  EXPECT_EQ(views_checks::collect(parsed | fun::views::oks), (std::vector<int>{ 1, 2, 3 }));
+  EXPECT_EQ(views_checks::collect(parsed | fun::views::errs), (std::vector<char>{ 'x', 'y' }));
+  EXPECT_EQ(views_checks::collect(text | std::views::transform(views_checks::parse_digit) | fun::views::errs),
+            (std::vector<char>{ 'x', 'y' }));
+
+  // Errors packed into a pointer come by value
+  auto x = 1;
+  auto packed = std::vector<fun::Result<int*, views_checks::Fault>>{ fun::ok(&x), fun::err(views_checks::Fault::Timeout) };
+  EXPECT_EQ(views_checks::collect(fun::views::errs(packed)), (std::vector<views_checks::Fault>{ views_checks::Fault::Timeout }));
+  EXPECT_EQ(*(packed | fun::views::oks).front(), 1);
+}
+
+TEST(ViewsTest, filter_map) {
+  const auto words = std::vector<std::string>{ "one", "", "three", "", "five" };
+  const auto initial = [](const std::string& s) -> fun::Option<char> {
+    if (s.empty()) { return {}; }
+    return fun::some(s[0]);
+  };
+
+  auto initials = words | fun::views::filter_map(initial);
+  static_assert(std::ranges::input_range<decltype(initials)>);
+  EXPECT_EQ(views_checks::collect(initials), (std::vector<char>{ 'o', 't', 'f' }));
+  EXPECT_EQ(views_checks::collect(fun::views::filter_map(words, initial)), (std::vector<char>{ 'o', 't', 'f' }));
+
+  // Composes with the standard adaptors, and captures make no difference
+  const auto skip = 1;
+  const auto tails = views_checks::collect(
+    std::views::iota(0, 5)
+      | std::views::transform([&](const int i) { return words[i]; })
+      | fun::views::filter_map([skip](std::string s) -> fun::Option<std::string> {
+          if (s.size() <= skip) { return {}; }
+          return fun::some(s.substr(skip));
+        })
+      | std::views::take(2)
+  );
+  EXPECT_EQ(tails, (std::vector<std::string>{ "ne", "hree" }));
+}
+
+TEST(ViewsTest, try_transform_stops_at_first_error) {
+  const auto good = std::string("123");
+  auto digits = good | fun::views::try_transform(views_checks::parse_digit);
+  EXPECT_EQ(views_checks::collect(digits), (std::vector<int>{ 1, 2, 3 }));
+  EXPECT_TRUE(digits.error().is_none());
+
+  const auto bad = std::string("12a3b");
+  auto calls = 0;
+  auto partial = bad | fun::views::try_transform([&](const char c) {
+    ++calls;
+    return views_checks::parse_digit(c);
+  });
+  EXPECT_EQ(views_checks::collect(partial), (std::vector<int>{ 1, 2 }));
+  EXPECT_EQ(partial.error(), fun::some('a'));
+  EXPECT_EQ(calls, 3);
+
+  // A new pass starts over
+  auto total = 0;
+  for (const auto d : partial) { total += d; }
+  EXPECT_EQ(total, 3);
+  EXPECT_EQ(std::move(partial).error(), fun::some('a'));
+}
+
+//------------------------------------------------------------------------------
+TEST(CollectTest, collect_stops_at_first_failure) {
+  using Res = fun::Result<std::string, int>;
+
+  const auto good = std::vector<Res>{ fun::ok(std::string("a")), fun::ok(std::string("b")) };
+  const auto collected = fun::sequence(good);
+  EXPECT_EQ(collected, fun::ok(std::vector<std::string>{ "a", "b" }));
+  EXPECT_EQ(*good[0].as_ptr(), "a") << "an lvalue range is copied from";
+
+  auto bad = std::vector<Res>{ fun::ok(std::string("a")), fun::err(1), fun::ok(std::string("c")), fun::err(2) };
+  EXPECT_EQ(fun::sequence(bad), (fun::Result<std::vector<std::string>, int>(fun::err(1))));
+
+  // Options, other containers, and lazily produced elements
+  const auto ops = std::list<fun::Option<int>>{ fun::some(3), fun::some(1), fun::some(3) };
+  EXPECT_EQ(fun::collect<std::set<int>>(ops), fun::some(std::set<int>{ 1, 3 }));
+  EXPECT_EQ(fun::collect<std::string>(std::vector<fun::Option<char>>{ fun::some('h'), fun::some('i') }),
+            fun::some(std::string("hi")));
+  EXPECT_TRUE(fun::sequence(std::vector<fun::Option<int>>{ fun::some(1), {} }).is_none());
+  EXPECT_EQ(fun::sequence(std::views::iota(0, 4) | std::views::transform([](const int i) { return fun::some(i); })),
+            fun::some(std::vector<int>{ 0, 1, 2, 3 }));
+
+  // References are collected as references
+  auto x = 1;
+  const auto refs = fun::sequence(std::vector<fun::Option<int&>>{ fun::some_ref(x) });
+  EXPECT_EQ(&refs.as_ptr()->front().get(), &x);
+}
+
+TEST(CollectTest, collect_builds_in_place) {
+  auto count = pipe_checks::MoveCount();
+  auto results = std::vector<fun::Result<pipe_checks::Tracked, int>>();
+  results.reserve(3);
+  for (auto i = 0; i < 3; ++i) { results.emplace_back(fun::OkTag{}, fun::ForwardArgs{}, count); }
+  count = pipe_checks::MoveCount();
+
+  const auto collected = fun::collect<std::vector<pipe_checks::Tracked>>(std::move(results));
+  EXPECT_TRUE(collected.is_ok());
+  EXPECT_EQ(count.moves, 3) << "each payload is moved once, straight into the reserved vector";
+  EXPECT_EQ(count.copies, 0);
+}
+
+TEST(CollectTest, try_fold_and_try_for_each) {
+  const auto add_digit = [](const int total, const char c) -> fun::Result<int, char> {
+    if (c < '0' || c > '9') { return fun::make_err(c); }
+    return fun::make_ok(10 * total + (c - '0'));
+  };
+  EXPECT_EQ(fun::try_fold(std::string("123"), 0, add_digit), fun::ok(123));
+  EXPECT_EQ(fun::try_fold(std::string("1x3y"), 0, add_digit), fun::err('x'));
+
+  auto seen = std::vector<int>();
+  const auto visit = [&](const int i) -> fun::Option<fun::Unit> {
+    if (i < 0) { return {}; }
+    seen.push_back(i);
+    return fun::some(fun::Unit{});
+  };
+  EXPECT_TRUE(fun::try_for_each(std::vector<int>{ 1, 2, -1, 3 }, visit).is_none());
+  EXPECT_EQ(seen, (std::vector<int>{ 1, 2 }));
+
+  const auto check = [](const std::string& s) -> fun::Result<std::size_t, std::string> {
+    if (s.empty()) { return fun::make_err("empty"); }
+    return fun::make_ok(s.size());
+  };
+  EXPECT_EQ(fun::try_for_each(std::vector<std::string>{ "a", "", "c" }, check),
+            (fun::Result<fun::Unit, std::string>(fun::err(std::string("empty")))));
+  EXPECT_TRUE(fun::try_for_each(std::vector<std::string>{ "a" }, check).is_ok());
+}
+
+TEST(CollectTest, transpose) {
+  using OpRes = fun::Option<fun::Result<std::string, int>>;
+  using ResOp = fun::Result<fun::Option<std::string>, int>;
+
+  EXPECT_EQ(fun::transpose(OpRes()), ResOp(fun::ok(fun::Option<std::string>())));
+  EXPECT_EQ(fun::transpose(OpRes(fun::ok(std::string("x")))), ResOp(fun::ok(fun::some(std::string("x")))));
+  EXPECT_EQ(fun::transpose(OpRes(fun::err(4))), ResOp(fun::err(4)));
+
+  EXPECT_EQ(fun::transpose(ResOp(fun::ok(fun::Option<std::string>()))), OpRes());
+  EXPECT_EQ(fun::transpose(ResOp(fun::ok(fun::some(std::string("x"))))), OpRes(fun::ok(std::string("x"))));
+  EXPECT_EQ(fun::transpose(ResOp(fun::err(4))), OpRes(fun::err(4)));
+}
+
+//------------------------------------------------------------------------------
+namespace parallel_checks {
+
+auto check_positive(const int x) -> fun::Result<std::string, int> {
+  if (x > 0) { return fun::make_ok(std::to_string(x)); }
+  else       { return fun::make_err(x); }
+}
+
+auto iota(const int n) -> std::vector<int> {
+  auto xs = std::vector<int>(n);
+  for (auto i = 0; i < n; ++i) { xs[i] = i + 1; }
+  return xs;
+}
+
+}
+
+TEST(ParallelTest, traverse_matches_sequential) {
+  const auto xs = parallel_checks::iota(10000);
+  const auto expected = fun::sequence(xs | std::views::transform(parallel_checks::check_positive));
+  for (const auto threads : { 1u, 2u, 3u, 8u }) {
+    EXPECT_EQ(fun::par_traverse(xs, parallel_checks::check_positive, threads), expected) << threads << " threads";
+  }
+
+  EXPECT_EQ(fun::par_traverse(std::vector<int>(), parallel_checks::check_positive),
+            fun::ok(std::vector<std::string>()));
+
+  const auto halve = [](const int x) -> fun::Option<int> {
+    if (x % 2 == 0) { return fun::some(x / 2); }
+    return {};
+  };
+  EXPECT_EQ(fun::par_traverse(std::vector<int>{ 2, 4, 6 }, halve, 2), fun::some(std::vector<int>{ 1, 2, 3 }));
+  EXPECT_TRUE(fun::par_traverse(std::vector<int>{ 2, 3, 6 }, halve, 2).is_none());
+}
+
+TEST(ParallelTest, traverse_reports_earliest_failure_and_cancels) {
+  auto xs = parallel_checks::iota(100000);
+  xs[10] = -10;
+  xs[50000] = -50000;
+  xs[99999] = -99999;
+
+  auto calls = std::atomic<int>(0);
+  const auto counted = [&](const int x) {
+    ++calls;
+    return parallel_checks::check_positive(x);
+  };
+  for (const auto threads : { 1u, 4u }) {
+    calls = 0;
+    EXPECT_EQ(fun::par_traverse(xs, counted, threads), fun::err(-10));
+    EXPECT_LT(calls.load(), 50000) << "the elements after a failure are abandoned";
+  }
+
+  const auto throwing = [](const int x) -> fun::Result<int, int> {
+    if (x == 5000) { throw std::runtime_error("boom"); }
+    return fun::make_ok(x);
+  };
+  EXPECT_THROW(fun::par_traverse(parallel_checks::iota(10000), throwing, 4), std::runtime_error);
+}
+
+TEST(ParallelTest, filter_map_keeps_order) {
+  const auto xs = parallel_checks::iota(10000);
+  const auto every_third = [](const int x) -> fun::Option<std::string> {
+    if (x % 3 == 0) { return fun::some(std::to_string(x)); }
+    return {};
+  };
+
+  auto expected = std::vector<std::string>();
+  for (const auto x : xs) {
+    if (x % 3 == 0) { expected.push_back(std::to_string(x)); }
+  }
+  for (const auto threads : { 1u, 2u, 7u }) {
+    EXPECT_EQ(fun::par_filter_map(xs, every_third, threads), expected) << threads << " threads";
+  }
+}
+
+TEST(ParallelTest, filter_map_rethrows_earliest_exception) {
+  // The first elements are slow, so that later ones fail before element 10 is reached
+  const auto throwing = [](const int x) -> fun::Option<int> {
+    if (x < 10) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+    if (x == 10 || x == 50000 || x == 99999) { throw std::runtime_error(std::to_string(x)); }
+    return fun::some(x);
+  };
+  for (const auto threads : { 1u, 4u, 8u }) {
+    try {
+      fun::par_filter_map(parallel_checks::iota(100000), throwing, threads);
+      ADD_FAILURE() << "nothing thrown";
+    } catch (const std::runtime_error& e) {
+      EXPECT_STREQ(e.what(), "10") << threads << " threads";
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+namespace coroutine_checks {
+
+auto parse_digit(const char c) -> fun::Result<int, char> {
+  if (c >= '0' && c <= '9') { return fun::make_ok(c - '0'); }
+  else                      { return fun::make_err(c); }
+}
+
+// The `char` errors of the digits are converted to `int`s
+auto parse_pair(const char a, const char b) -> fun::Result<int, int> {
+  const auto tens = co_await parse_digit(a);
+  if (tens == 0) { co_return fun::make_err(-1); }
+  co_return 10 * tens + co_await parse_digit(b);
+}
+
+auto halve(const int x) -> fun::Option<int> {
+  if (x % 2 == 0) { return fun::some(x / 2); }
+  return {};
+}
+
+auto quarter(const int x, int& destroyed) -> fun::Option<int> {
+  struct Witness {
+    int& destroyed;
+    ~Witness() { ++destroyed; }
+  };
+  const auto witness = Witness{ destroyed };
+  co_return co_await halve(co_await halve(x));
+}
+
+// Recurses deep enough to overflow the frame arena
+auto sum_down(const int n) -> fun::Option<int> {
+  if (n == 0) { co_return 0; }
+  co_return n + co_await sum_down(n - 1);
+}
+
+auto take(fun::Option<pipe_checks::Tracked> op) -> fun::Option<pipe_checks::Tracked> {
+  co_return co_await std::move(op);
+}
+
+auto bump(fun::Option<int>& op) -> fun::Option<fun::Unit> {
+  ++co_await op;
+  co_return fun::Unit{};
+}
+
+auto throwing(const fun::Option<int> op) -> fun::Option<int> {
+  if (const auto x = co_await fun::Option<int>(op); x > 0) { throw std::runtime_error("boom"); }
+  co_return 0;
+}
+
+}
+
+TEST(CoroutineTest, result_short_circuits) {
+  using Pair = fun::Result<int, int>;
+  EXPECT_EQ(coroutine_checks::parse_pair('4', '2'), Pair(fun::make_ok(42)));
+  EXPECT_EQ(coroutine_checks::parse_pair('x', '2'), Pair(fun::make_err(int('x'))));
+  EXPECT_EQ(coroutine_checks::parse_pair('4', 'y'), Pair(fun::make_err(int('y'))));
+  EXPECT_EQ(coroutine_checks::parse_pair('0', '2'), Pair(fun::make_err(-1)));
+}
+
+TEST(CoroutineTest, option_short_circuits_and_unwinds) {
+  auto destroyed = 0;
+  EXPECT_EQ(coroutine_checks::quarter(12, destroyed), fun::some(3));
+  EXPECT_EQ(coroutine_checks::quarter(6, destroyed), fun::Option<int>());
+  EXPECT_EQ(coroutine_checks::quarter(5, destroyed), fun::Option<int>());
+  EXPECT_EQ(destroyed, 3);
+
+  EXPECT_EQ(coroutine_checks::sum_down(1000), fun::some(500500));
+  EXPECT_EQ(coroutine_checks::sum_down(10), fun::some(55)) << "the frame arena is back to empty";
+}
+
+TEST(CoroutineTest, awaiting_moves_rvalues_and_refers_to_lvalues) {
+  auto count = pipe_checks::MoveCount();
+  const auto out = coroutine_checks::take(fun::Option<pipe_checks::Tracked>(fun::ForwardArgs{}, count));
+  EXPECT_TRUE(out.is_some());
+  EXPECT_EQ(count.copies, 0);
+  EXPECT_LE(count.moves, 4);
+
+  auto op = fun::some(1);
+  EXPECT_TRUE(coroutine_checks::bump(op).is_some());
+  EXPECT_EQ(op, fun::some(2));
+  auto none = fun::Option<int>();
+  EXPECT_TRUE(coroutine_checks::bump(none).is_none());
+}
+
+TEST(CoroutineTest, exceptions_propagate) {
+  EXPECT_THROW(coroutine_checks::throwing(fun::some(1)), std::runtime_error);
+  EXPECT_EQ(coroutine_checks::throwing(fun::some(0)), fun::some(0));
+  EXPECT_EQ(coroutine_checks::throwing(fun::Option<int>()), fun::Option<int>());
+}
+
+//------------------------------------------------------------------------------
+namespace propagation_checks {
+
+struct ParseError {
+  int line;
+};
+
+struct AppError {
+  std::string what;
+};
+
+// Takes a counted error over with no move of its own
+struct Wrapped {
+  pipe_checks::Tracked inner;
+
+  Wrapped(pipe_checks::Tracked&& t) : inner(std::move(t)) {}
+};
+
+auto failing(pipe_checks::MoveCount& count) -> fun::Result<int, pipe_checks::Tracked> {
+  return fun::Result<int, pipe_checks::Tracked>(fun::ErrTag{}, fun::ForwardArgs{}, count);
+}
+
+auto forward(pipe_checks::MoveCount& count) -> fun::Result<float, pipe_checks::Tracked> {
+  FUN_TRY_DECLARE(x, failing(count));
+  return fun::make_ok(float(x));
+}
+
+auto wrap(pipe_checks::MoveCount& count) -> fun::Result<float, Wrapped> {
+  FUN_TRY_DECLARE(x, failing(count));
+  return fun::make_ok(float(x));
+}
+
+auto parse(const char c) -> fun::Result<int, ParseError> {
+  if (c >= '0' && c <= '9') { return fun::make_ok(c - '0'); }
+  else                      { return fun::make_err(ParseError{ c }); }
+}
+
+auto lookup(const int key) -> fun::Option<std::string> {
+  if (key < 5) { return fun::some(std::string(key, 'x')); }
+  return {};
+}
+
+auto run(const char c) -> fun::Result<std::string, AppError> {
+  FUN_TRY_DECLARE(key, parse(c));
+  FUN_TRY_DECLARE(value, lookup(key));
+  return fun::make_ok(std::move(value));
+}
+
+auto run_coroutine(const char c) -> fun::Result<std::string, AppError> {
+  co_return co_await lookup(co_await parse(c));
+}
+
+// Whether an error `From` is propagated into a `Result<T, To>`
+template <class To, class From>
+constexpr bool converts_v = requires(From&& e) { fun::ErrorFrom<To, From>::convert(std::forward<From>(e)); };
+
+} // end namespace propagation_checks
+
+template <>
+struct fun::ErrorFrom<propagation_checks::AppError, propagation_checks::ParseError> {
+  static auto convert(propagation_checks::ParseError&& e) -> propagation_checks::AppError {
+    return { "parse error at " + std::to_string(e.line) };
+  }
+};
+
+template <>
+struct fun::ErrorFrom<propagation_checks::AppError, fun::NothingTag> {
+  static auto convert(fun::NothingTag) -> propagation_checks::AppError { return { "not found" }; }
+};
+
+TEST(TryTest, errors_move_once_into_the_return_value) {
+  auto same = pipe_checks::MoveCount();
+  EXPECT_TRUE(propagation_checks::forward(same).is_err());
+  EXPECT_EQ(same.moves, 1);
+  EXPECT_EQ(same.copies, 0);
+
+  auto converted = pipe_checks::MoveCount();
+  EXPECT_TRUE(propagation_checks::wrap(converted).is_err());
+  EXPECT_EQ(converted.moves, 1);
+  EXPECT_EQ(converted.copies, 0);
+
+  // A packed error converted by construction
+  const auto narrow = [](const fun::Result<int*, char> res) -> fun::Result<int, int> {
+    FUN_TRY_DECLARE(p, res);
+    return fun::make_ok(*p);
+  };
+  EXPECT_EQ(narrow(fun::make_err('e')).unwrap_err(), int('e'));
+}
+
+TEST(TryTest, only_implicit_conversions_by_default) {
+  using propagation_checks::converts_v;
+
+  static_assert(converts_v<long, int>);
+  static_assert(converts_v<std::string, const char*>);
+  static_assert(converts_v<propagation_checks::Wrapped, pipe_checks::Tracked>);
+
+  // An explicit constructor does not make an error out of whatever it takes
+  static_assert(!converts_v<std::vector<int>, std::size_t>);
+  static_assert(!converts_v<std::unique_ptr<int>, int*>);
+  static_assert(!converts_v<propagation_checks::AppError, std::string>);
+}
+
+TEST(TryTest, errors_convert_by_error_from) {
+  EXPECT_EQ(propagation_checks::run('3').unwrap(), "xxx");
+  EXPECT_EQ(propagation_checks::run('?').unwrap_err().what, "parse error at 63");
+  EXPECT_EQ(propagation_checks::run('7').unwrap_err().what, "not found");
+
+  EXPECT_EQ(propagation_checks::run_coroutine('3').unwrap(), "xxx");
+  EXPECT_EQ(propagation_checks::run_coroutine('?').unwrap_err().what, "parse error at 63");
+  EXPECT_EQ(propagation_checks::run_coroutine('7').unwrap_err().what, "not found");
+}
+
+//------------------------------------------------------------------------------
+namespace error_checks {
+
+enum class Errc { BadDigit = 22, TooLong = 36 };
+
+inline constexpr fun::ErrorMessage bad_digit{ "bad digit", int(Errc::BadDigit) };
+
+auto parse_digit(const char c) -> fun::Result<int, fun::Error> {
+  if (c >= '0' && c <= '9') { return fun::make_ok(c - '0'); }
+  else                      { return fun::make_err(bad_digit); }
+}
+
+auto check_length(const std::string& s) -> fun::Result<fun::Unit, Errc> {
+  if (s.size() <= 2) { return fun::make_ok(); }
+  else               { return fun::make_err(Errc::TooLong); }
+}
+
+auto parse_number(const std::string& s) -> fun::Result<int, fun::Error> {
+  FUN_TRY_DISCARDING(check_length(s));
+  auto n = 0;
+  for (const auto c : s) {
+    FUN_TRY_DECLARE(digit, parse_digit(c).map_err([](const fun::Error e) { return e.context("parsing a number"); }));
+    n = 10 * n + digit;
+  }
+  return fun::make_ok(n);
+}
+
+} // end namespace error_checks
+
+TEST(ErrorTest, is_pointer_sized) {
+  EXPECT_EQ(sizeof(fun::Error), sizeof(void*));
+  EXPECT_TRUE(std::is_trivially_copyable_v<fun::Error>);
+  EXPECT_EQ(sizeof(fun::Option<fun::Error>), sizeof(void*));
+  EXPECT_EQ(sizeof(fun::Result<fun::Unit, fun::Error>), sizeof(void*));
+  EXPECT_LE(sizeof(fun::Result<int, fun::Error>), 2 * sizeof(void*));
+  EXPECT_LE(sizeof(fun::Result<std::string, fun::Error>), sizeof(std::string) + sizeof(void*));
+}
+
+TEST(ErrorTest, codes_messages_and_context) {
+  const auto code = fun::Error(error_checks::Errc::TooLong);
+  EXPECT_EQ(code.code(), 36);
+  EXPECT_EQ(code.message(), nullptr);
+  EXPECT_EQ(code.to_string(), "error code 36");
+  EXPECT_EQ(code, fun::Error(36));
+  EXPECT_EQ(fun::Error(-5).code(), -5);
+
+  const auto message = fun::Error(error_checks::bad_digit);
+  EXPECT_EQ(message.code(), 22);
+  EXPECT_STREQ(message.message(), "bad digit");
+  EXPECT_TRUE(message.cause().is_none());
+
+  static_assert(!std::is_constructible_v<fun::Error, const char (&)[9]>, "literals are not kept, see ErrorMessage");
+
+  const auto outer = message.context("parsing").context("reading the config");
+  EXPECT_STREQ(outer.message(), "bad digit");
+  EXPECT_EQ(outer.code(), 22);
+  EXPECT_EQ(outer.context_string(), "reading the config: parsing");
+  EXPECT_EQ(outer.cause().unwrap().cause(), fun::some(message));
+  EXPECT_EQ(outer.to_string(), "reading the config: parsing: bad digit (code 22)");
+  EXPECT_EQ(code.context(std::string(100, 'x')).to_string(), std::string(55, 'x') + ": error code 36");
+}
+
+TEST(ErrorTest, propagates_through_try_and_map_err) {
+  EXPECT_EQ(error_checks::parse_number("42"), fun::ok<fun::Error>(42));
+  EXPECT_EQ(error_checks::parse_number("123").unwrap_err(), fun::Error(error_checks::Errc::TooLong));
+  EXPECT_EQ(error_checks::parse_number("4x").unwrap_err().to_string(), "parsing a number: bad digit (code 22)");
+
+  // Codes become errors although they only explicitly construct one
+  static_assert(!std::is_convertible_v<int, fun::Error>);
+  static_assert(propagation_checks::converts_v<fun::Error, int>);
+  static_assert(propagation_checks::converts_v<fun::Error, error_checks::Errc>);
+  static_assert(!propagation_checks::converts_v<fun::Error, long>);
+
+  const auto widen = [](const fun::Result<int, int> res) -> fun::Result<int, fun::Error> {
+    FUN_TRY_DECLARE(x, res);
+    return fun::make_ok(x + 1);
+  };
+  EXPECT_EQ(widen(fun::make_ok(1)), fun::ok<fun::Error>(2));
+  EXPECT_EQ(widen(fun::make_err(-3)).unwrap_err(), fun::Error(-3));
+}
+
+TEST(ErrorTest, context_is_read_across_threads) {
+  const auto check = [](const int i) -> fun::Result<int, fun::Error> {
+    if (i == 700) { return fun::make_err(fun::Error(error_checks::bad_digit).context("from worker")); }
+    else          { return fun::make_ok(i); }
+  };
+  const auto err = fun::par_traverse(parallel_checks::iota(1000), check, 4).unwrap_err();
+  EXPECT_EQ(err.to_string(), "from worker: bad digit (code 22)");
+}
+
+TEST(ErrorTest, old_context_expires_but_the_root_stays) {
+  const auto old_code = fun::Error(5).context("old");
+  const auto old_message = fun::Error(error_checks::bad_digit).context("old");
+  EXPECT_EQ(old_message.to_string(), "old: bad digit (code 22)");
+
+  // More than the 4096 frames kept
+  auto e = fun::Error(1);
+  for (auto i = 0; i < 10000; ++i) { e = e.context("again"); }
+  EXPECT_EQ(e.code(), 1);
+  EXPECT_TRUE(e.has_context());
+
+  EXPECT_FALSE(old_code.has_context());
+  EXPECT_EQ(old_code.code(), 5);
+  EXPECT_EQ(old_code.to_string(), "error code 5");
+  EXPECT_EQ(old_code.cause(), fun::some(fun::Error(5)));
+
+  EXPECT_FALSE(old_message.has_context());
+  EXPECT_EQ(old_message.code(), 22);
+  EXPECT_STREQ(old_message.message(), "bad digit");
+  EXPECT_EQ(old_message.to_string(), "bad digit (code 22)");
+  EXPECT_EQ(old_message.cause(), fun::some(fun::Error(error_checks::bad_digit)));
+}
+
+//------------------------------------------------------------------------------
+namespace context_checks {
+
+enum class Io: std::uint8_t { NotFound, Denied };
+enum class App: std::uint32_t { Config, Io };
+
+} // end namespace context_checks
+
+template <>
+struct fun::ErrorFrom<context_checks::App, context_checks::Io> {
+  static auto convert(context_checks::Io) -> context_checks::App { return context_checks::App::Io; }
+};
+
+namespace context_checks {
+
+auto open(const int fd) -> fun::Result<int, fun::Traced<Io>> {
+  if (fd >= 0) { return fun::make_ok(fd); }
+  return fun::make_err(Io::NotFound);
+}
+
+auto read_key(const int fd) -> fun::Result<int, fun::Traced<Io>> {
+  FUN_TRY_DECLARE(file, open(fd).map_err(fun::with_context("opening settings.ini")));
+  return fun::make_ok(file * 10);
+}
+
+auto load_config(const int fd) -> fun::Result<int, fun::Traced<App>> {
+  FUN_TRY_DECLARE(key, read_key(fd).map_err(fun::with_context("reading key 'port'")));
+  return fun::make_ok(key + 1);
+}
+
+} // end namespace context_checks
+
+TEST(ContextTest, stays_register_sized) {
+  using context_checks::Io;
+  EXPECT_EQ(sizeof(fun::Traced<Io>), 8);
+  EXPECT_LE(sizeof(fun::Result<int, fun::Traced<Io>>), 16);
+  EXPECT_TRUE((std::is_trivially_copyable_v<fun::Result<int, fun::Traced<Io>>>));
+}
+
+TEST(ContextTest, follows_the_error_across_frames) {
+  using context_checks::App;
+
+  EXPECT_EQ(context_checks::load_config(3), fun::ok<fun::Traced<App>>(31));
+
+  const auto err = context_checks::load_config(-1).unwrap_err();
+  EXPECT_EQ(err.code(), App::Io);
+  EXPECT_EQ(err.context_string(), "reading key 'port': opening settings.ini");
+
+  const auto recovered = context_checks::load_config(-1).or_else([](const fun::Traced<App> e) {
+    return fun::Result<int, fun::Traced<App>>(fun::make_err(e.context("using defaults")));
+  });
+  EXPECT_EQ(recovered.as_cref().unwrap_err().context_string(),
+            "using defaults: reading key 'port': opening settings.ini");
+}
+
+TEST(ContextTest, old_context_is_overwritten) {
+  const auto bare = fun::Traced<context_checks::Io>(context_checks::Io::Denied);
+  EXPECT_FALSE(bare.has_context());
+  EXPECT_EQ(bare.context_string(), "");
+
+  const auto old = bare.context(std::string(100, 'x'));
+  EXPECT_EQ(old.context_string(), std::string(55, 'x'));
+  for (auto i = 0; i < 10000; ++i) { [[maybe_unused]] const auto newer = bare.context("newer"); }
+  EXPECT_FALSE(old.has_context());
+  EXPECT_EQ(old.code(), context_checks::Io::Denied);
+}
+
+TEST(ContextTest, context_is_read_on_another_thread) {
+  using context_checks::Io;
+
+  auto err = fun::Traced<Io>(Io::Denied);
+  std::thread([&err] { err = fun::Traced<Io>(Io::NotFound).context("from worker"); }).join();
+  EXPECT_EQ(err.code(), Io::NotFound);
+  EXPECT_EQ(err.context_string(), "from worker");
+
+  // Both kinds of error share the context store
+  const auto error = fun::Error(error_checks::bad_digit).context("parsing");
+  std::thread([&err] { err = err.context("from another worker"); }).join();
+  EXPECT_EQ(err.context_string(), "from another worker: from worker");
+  EXPECT_EQ(error.to_string(), "parsing: bad digit (code 22)");
+}
+
+//------------------------------------------------------------------------------
+namespace boxed_checks {
+
+struct Report {
+  std::string file;
+  int line;
+  char excerpt[240];
+
+  bool operator==(const Report& other) const { return file == other.file && line == other.line; }
+};
+
+auto parse(const int n) -> fun::Result<int, Report> {
+  if (n >= 0) { return fun::make_ok(n); }
+  return fun::make_err(Report{ "input.txt", -n, {} });
+}
+
+auto parse_twice(const int n) -> fun::Result<int, fun::Boxed<Report>> {
+  FUN_TRY_DECLARE(x, parse(n));
+  return fun::make_ok(2 * x);
+}
+
+} // end namespace boxed_checks
+
+TEST(BoxedTest, holds_large_payloads_out_of_line) {
+  using boxed_checks::Report;
+  EXPECT_EQ(sizeof(fun::Boxed<Report>), sizeof(void*));
+  EXPECT_EQ(sizeof(fun::Option<fun::Boxed<Report>>), sizeof(void*));
+  EXPECT_LE(sizeof(fun::Result<int, fun::Boxed<Report>>), 2 * sizeof(void*));
+  EXPECT_GT(sizeof(fun::Result<int, Report>), 256);
+
+  EXPECT_EQ(boxed_checks::parse_twice(4), (fun::ok<fun::Boxed<Report>>(8)));
+  const auto err = boxed_checks::parse_twice(-7).unwrap_err();
+  EXPECT_EQ(err->file, "input.txt");
+  EXPECT_EQ((*err).line, 7);
+}
+
+TEST(BoxedTest, has_value_semantics) {
+  auto a = fun::Boxed<std::string>(std::string(40, 'a'));
+  auto b = a;
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_EQ(a, b);
+  b->push_back('b');
+  EXPECT_NE(a, b);
+
+  const auto* const held = b.get();
+  auto c = std::move(b);
+  EXPECT_EQ(c.get(), held);
+  EXPECT_EQ(b.get(), nullptr);
+
+  auto op = fun::Option<fun::Boxed<std::string>>(fun::ForwardArgs{}, std::move(c));
+  ASSERT_TRUE(op.is_some());
+  EXPECT_EQ(op.as_ptr()->get(), held);
+  EXPECT_EQ(fun::Option<fun::Boxed<std::string>>().is_none(), true);
+}
+
+TEST(BoxedTest, recycles_blocks_per_thread) {
+  const void* first = nullptr;
+  {
+    const auto a = fun::Boxed<std::array<char, 100>>(fun::ForwardArgs{});
+    first = a.get();
+  }
+  const auto b = fun::Boxed<std::array<char, 100>>(fun::ForwardArgs{});
+  EXPECT_EQ(b.get(), first);
+  const auto c = fun::Boxed<std::array<char, 112>>(fun::ForwardArgs{});
+  EXPECT_NE(c.get(), first) << "the block is in use";
+
+  struct Throws {
+    Throws() { throw std::runtime_error("no"); }
+    char pad[100];
+  };
+  const void* freed = nullptr;
+  { freed = fun::Boxed<std::array<char, 100>>(fun::ForwardArgs{}).get(); }
+  EXPECT_THROW(fun::Boxed<Throws>(fun::ForwardArgs{}), std::runtime_error);
+  EXPECT_EQ((fun::Boxed<std::array<char, 100>>(fun::ForwardArgs{}).get()), freed) << "given back by the failed one";
+}
+
+//------------------------------------------------------------------------------
+namespace allocator_checks {
+
+// Counts the allocations made from the default memory resource, which it stands
+// in for while it is alive. Memory a `std::pmr` payload takes without being
+// handed an allocator comes from there.
+class CountingDefault : public std::pmr::memory_resource {
+  std::pmr::memory_resource* const _previous = std::pmr::get_default_resource();
+
+  auto do_allocate(const std::size_t bytes, const std::size_t align) -> void* override {
+    ++allocations;
+    return _previous->allocate(bytes, align);
+  }
+
+  void do_deallocate(void* const p, const std::size_t bytes, const std::size_t align) override {
+    _previous->deallocate(p, bytes, align);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+public:
+  std::size_t allocations = 0;
+
+  CountingDefault() { std::pmr::set_default_resource(this); }
+  CountingDefault(const CountingDefault&) = delete;
+  auto operator=(const CountingDefault&) -> CountingDefault& = delete;
+  ~CountingDefault() override { std::pmr::set_default_resource(_previous); }
+};
+
+} // end namespace allocator_checks
+
+TEST(AllocatorTest, payloads_take_the_allocator) {
+  using String = std::pmr::string;
+  using Alloc = std::pmr::polymorphic_allocator<char>;
+  EXPECT_TRUE((std::uses_allocator_v<fun::Option<String>, Alloc>));
+  EXPECT_TRUE((std::uses_allocator_v<fun::Result<int, String>, Alloc>));
+  EXPECT_FALSE((std::uses_allocator_v<fun::Result<int, std::string>, Alloc>));
+  EXPECT_FALSE((std::uses_allocator_v<fun::Option<String&>, Alloc>));
+
+  const auto alloc = Alloc();
+  const auto text = String("some text");
+  EXPECT_TRUE((std::is_same_v<decltype(fun::uses_allocator_args<String>(alloc, text)),
+                              std::tuple<const String&, const Alloc&>>));
+  EXPECT_TRUE((std::is_same_v<decltype(fun::uses_allocator_args<int>(alloc, 1)), std::tuple<int&&>>));
+}
+
+TEST(AllocatorTest, no_heap_use_within_an_arena) {
+  using String = std::pmr::string;
+  const char* const text = "a string that is too long to fit in the string itself";
+
+  alignas(std::max_align_t) std::byte buffer[16 * 1024];
+  auto arena = std::pmr::monotonic_buffer_resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  const auto alloc = std::pmr::polymorphic_allocator<char>(&arena);
+  auto heap = allocator_checks::CountingDefault();
+
+  // Containers hand their allocator down to the payloads
+  auto options = std::pmr::vector<fun::Option<String>>(&arena);
+  options.reserve(4);
+  options.emplace_back(fun::ForwardArgs{}, text);
+  options.emplace_back();
+  options.push_back(options.front());
+
+  auto results = std::pmr::vector<fun::Result<int, String>>(&arena);
+  results.reserve(4);
+  results.emplace_back(fun::OkTag{}, fun::ForwardArgs{}, 7);
+  results.emplace_back(fun::ErrTag{}, fun::ForwardArgs{}, text);
+  results.push_back(results.back());
+
+  // So do `emplace` and the combinators given one
+  auto op = fun::Option<String>(std::allocator_arg, alloc, fun::ForwardArgs{}, text);
+  op.emplace(std::allocator_arg, alloc, text);
+  auto shouted = std::move(op)
+    .map(std::allocator_arg, alloc, [](String&& s) { return std::move(s += "!"); })
+    .and_then(std::allocator_arg, alloc, [](String&& s) { return fun::some(std::move(s)); });
+
+  auto res = fun::Result<int, String>(std::allocator_arg, alloc, fun::ErrTag{}, fun::ForwardArgs{}, text)
+    .map(std::allocator_arg, alloc, [](const int x) { return x + 1; })
+    .map_err(std::allocator_arg, alloc, [](String&& e) { return std::move(e += "?"); })
+    .and_then(std::allocator_arg, alloc, [](const int x) { return fun::Result<int, String>(fun::make_ok(x)); });
+
+  EXPECT_EQ(heap.allocations, 0u);
+
+  EXPECT_EQ(options[2], options[0]);
+  EXPECT_EQ(options[2].as_ptr()->get_allocator().resource(), &arena);
+  EXPECT_TRUE(options[1].is_none());
+  EXPECT_EQ(results[2].as_err_ptr()->get_allocator().resource(), &arena);
+  EXPECT_EQ(*shouted.as_ptr(), String(text) + "!");
+  EXPECT_EQ(*res.as_err_ptr(), String(text) + "?");
+
+  // Without the allocator, a copy is made on the heap
+  const auto copy = fun::Option<String>(options[0]);
+  EXPECT_GT(heap.allocations, 0u);
+}
+
+TEST(AllocatorTest, containers_construct_from_values) {
+  using String = std::pmr::string;
+  const char* const text = "a string that is too long to fit in the string itself";
+
+  alignas(std::max_align_t) std::byte buffer[16 * 1024];
+  auto arena = std::pmr::monotonic_buffer_resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  auto values = std::vector<String>(3, String(text));
+  auto heap = allocator_checks::CountingDefault();
+
+  auto options = std::pmr::vector<fun::Option<String>>(&arena);
+  options.reserve(2);
+  options.emplace_back(std::move(values[0]));
+  options.emplace_back(fun::make_some(text));
+
+  auto results = std::pmr::vector<fun::Result<String, String>>(&arena);
+  results.reserve(4);
+  results.emplace_back(fun::ok(std::move(values[1])));
+  results.emplace_back(fun::err(std::move(values[2])));
+  results.emplace_back(fun::make_ok(text));
+  results.emplace_back(fun::make_err(text, 10));
+
+  for (const auto& op : options) {
+    EXPECT_EQ(*op.as_ptr(), text);
+    EXPECT_EQ(op.as_ptr()->get_allocator().resource(), &arena);
+  }
+  EXPECT_EQ(results[0].as_ptr()->get_allocator().resource(), &arena);
+  EXPECT_EQ(results[1].as_err_ptr()->get_allocator().resource(), &arena);
+  EXPECT_EQ(results[2].as_ptr()->get_allocator().resource(), &arena);
+  EXPECT_EQ(*results[3].as_err_ptr(), String(text, 10));
+  EXPECT_EQ(results[3].as_err_ptr()->get_allocator().resource(), &arena);
+  EXPECT_EQ(heap.allocations, 0u);
+}
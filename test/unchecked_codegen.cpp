@@ -0,0 +1,35 @@
+//!
+//! Checks that the unchecked accessors let the optimizer drop the test of the
+//! variant left behind. The payload of the variant that is not taken is
+//! destroyed by calling `never_defined`, so this only links once the
+//! destructor of the moved-from Result no longer tests which variant it holds.
+//!
+//! Built with optimizations and with `FUN_CHECK_ASSUMPTIONS` off, see
+//! CMakeLists.txt.
+//!
+
+#include <memory>
+
+#include <fun/result.h>
+
+void never_defined();
+
+struct NotTaken {
+  int code;
+
+  ~NotTaken() { never_defined(); }
+};
+
+[[gnu::noinline]] auto make_ok(const int n) -> fun::Result<std::unique_ptr<int>, NotTaken> {
+  return fun::make_ok(std::make_unique<int>(n));
+}
+
+[[gnu::noinline]] auto make_err(const int n) -> fun::Result<NotTaken, std::unique_ptr<int>> {
+  return fun::make_err(std::make_unique<int>(n));
+}
+
+auto main(const int argc, char**) -> int {
+  const auto value = make_ok(argc).unwrap_unchecked();
+  const auto error = make_err(argc).unwrap_err_unchecked();
+  return *value == argc && *error == argc ? 0 : 1;
+}